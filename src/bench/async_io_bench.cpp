@@ -0,0 +1,119 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+/**
+ * Cost per page of reading batches of random pages into an empty buffer pool
+ * with BufMgr::readPages(), and of flushing a file whose pages are all dirty,
+ * without an I/O engine, with the thread pool and with io_uring. The file uses
+ * the POSITIONAL backend, which io_uring reaches. Reads are likely served from
+ * the OS page cache, which is the worst case for keeping them in flight.
+ *
+ *   $ ./bench/async_io_bench [pages] [batch]
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "buffer.h"
+#include "exceptions/file_not_found_exception.h"
+
+using namespace badgerdb;
+
+typedef std::chrono::steady_clock Clock;
+
+static double since(const Clock::time_point& start, std::uint64_t ops)
+{
+	return std::chrono::duration<double, std::micro>(Clock::now() - start).count() / ops;
+}
+
+/**
+ * Times batched reads and a flush of every page through a buffer manager, with an I/O
+ * engine of the given kind or none.
+ */
+static void run(const char* label, File& file, const std::uint32_t numPages, const std::uint32_t batch,
+				const IoEngineConfig::Kind* kind)
+{
+	BufMgr mgr(numPages);
+	if (kind != NULL)
+	{
+		IoEngineConfig config;
+		config.kind = *kind;
+		mgr.startAsyncIo(config);
+	}
+
+	std::vector<PageId> pageNos(batch);
+	std::vector<Page*> pages(batch);
+	std::uint32_t seed = 1;
+	const std::uint32_t rounds = numPages / batch;
+	Clock::time_point start = Clock::now();
+	for (std::uint32_t r = 0; r < rounds; r++)
+	{
+		for (std::uint32_t n = 0; n < batch; n++)
+		{
+			seed = seed * 1103515245 + 12345;
+			pageNos[n] = 1 + (seed >> 8) % numPages;
+		}
+		mgr.readPages(&file, pageNos.data(), batch, pages.data());
+		for (std::uint32_t n = 0; n < batch; n++)
+			mgr.unPinPage(&file, pageNos[n], false);
+		// start every round with an empty pool
+		mgr.flushFile(&file);
+	}
+	const double read = since(start, static_cast<std::uint64_t>(rounds) * batch);
+
+	for (PageId pageNo = 1; pageNo <= numPages; pageNo++)
+	{
+		Page* page;
+		mgr.readPage(&file, pageNo, page);
+		mgr.unPinPage(&file, pageNo, true);
+	}
+	start = Clock::now();
+	mgr.flushFile(&file);
+	const double flush = since(start, numPages);
+
+	std::cout << label << read << "\t\t\t" << flush << "\n";
+}
+
+int main(int argc, char** argv)
+{
+	const std::uint32_t numPages = argc > 1 ? atoi(argv[1]) : 4096;
+	const std::uint32_t batch = argc > 2 ? atoi(argv[2]) : 64;
+
+	const std::string name = "bench.async_io";
+	try
+	{
+		File::remove(name);
+	}
+	catch(const FileNotFoundException &)
+	{
+	}
+	{
+		FileIoConfig config;
+		config.backend = FileIoConfig::POSITIONAL;
+		File file = File::create(name, 0, config);
+		for (std::uint32_t p = 0; p < numPages; p++)
+		{
+			Page page = file.allocatePage();
+			while (page.hasSpaceForRecord(100))
+				page.insertRecord(std::string(100, static_cast<char>('a' + p % 26)));
+			file.writePage(page);
+		}
+
+		const IoEngineConfig::Kind pool = IoEngineConfig::THREAD_POOL;
+		const IoEngineConfig::Kind uring = IoEngineConfig::AUTO;
+		std::cout << numPages << " pages, batches of " << batch << "\n";
+		std::cout << "engine         batched read us/page  flush us/page\n";
+		run("synchronous    ", file, numPages, batch, NULL);
+		run("thread pool    ", file, numPages, batch, &pool);
+		run("io_uring       ", file, numPages, batch, &uring);
+	}
+	File::remove(name);
+
+	return 0;
+}
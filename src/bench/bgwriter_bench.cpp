@@ -0,0 +1,109 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+/**
+ * Cost of a buffer miss on an update-heavy workload, with and without the
+ * background writer. Half of the uniformly random reads dirty their page; the
+ * report gives the fraction of misses that had to write a dirty victim back
+ * themselves and the slowest 1% of reads.
+ *
+ *   $ ./bench/bgwriter_bench [frames] [accesses]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <vector>
+#include "buffer.h"
+#include "exceptions/file_not_found_exception.h"
+
+using namespace badgerdb;
+
+typedef std::chrono::steady_clock Clock;
+
+/**
+ * Pages are spread over several files, since appending to a long file walks its page list.
+ */
+static const std::uint32_t PAGES_PER_FILE = 256;
+
+static std::string fileName(std::uint32_t i)
+{
+	std::stringstream ss;
+	ss << "bench.bgwriter." << i;
+	return ss.str();
+}
+
+int main(int argc, char** argv)
+{
+	const std::uint32_t bufs = argc > 1 ? atoi(argv[1]) : 4096;
+	const std::uint32_t accesses = argc > 2 ? atoi(argv[2]) : 200000;
+
+	const std::uint32_t pages = 2 * bufs;
+	const std::uint32_t numFiles = (pages + PAGES_PER_FILE - 1) / PAGES_PER_FILE;
+	std::vector<File> files;
+	for (std::uint32_t f = 0; f < numFiles; f++)
+	{
+		try
+		{
+			File::remove(fileName(f));
+		}
+		catch(const FileNotFoundException &)
+		{
+		}
+		files.push_back(File::create(fileName(f)));
+		for (std::uint32_t i = 0; i < PAGES_PER_FILE; i++)
+			files.back().allocatePage();
+	}
+
+	std::cout << "writer   foreground writes/miss   mean ns   p99 ns\n";
+	for (int withWriter = 0; withWriter <= 1; withWriter++)
+	{
+		BufMgr bufMgr(bufs);
+		if (withWriter)
+		{
+			BgWriterConfig config;
+			config.pagesPerRound = bufs;
+			config.delayMs = 1;
+			bufMgr.startBackgroundWriter(config);
+		}
+
+		Page* page;
+		std::mt19937 rng(42);
+		std::uniform_int_distribution<std::uint32_t> any(0, pages - 1);
+		std::vector<double> latencies;
+		latencies.reserve(accesses);
+		for (std::uint32_t n = 0; n < accesses; n++)
+		{
+			const std::uint32_t i = any(rng);
+			File* file = &files[i / PAGES_PER_FILE];
+			const Clock::time_point start = Clock::now();
+			bufMgr.readPage(file, i % PAGES_PER_FILE + 1, page);
+			latencies.push_back(std::chrono::duration<double, std::nano>(Clock::now() - start).count());
+			bufMgr.unPinPage(file, i % PAGES_PER_FILE + 1, n % 2 == 0);
+		}
+
+		const BufStats& stats = bufMgr.getBufStats();
+		const int misses = stats.accesses - stats.hits;
+		double total = 0;
+		for (double ns : latencies)
+			total += ns;
+		std::sort(latencies.begin(), latencies.end());
+
+		std::cout << (withWriter ? "on" : "off") << "\t " << (double) (stats.diskwrites - stats.bgwrites) / misses
+			<< "\t\t\t  " << total / accesses << "\t     " << latencies[accesses * 99 / 100] << "\n";
+		bufMgr.stopBackgroundWriter();
+	}
+
+	files.clear();
+	for (std::uint32_t f = 0; f < numFiles; f++)
+		File::remove(fileName(f));
+
+	return 0;
+}
@@ -0,0 +1,122 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+/**
+ * Cost per record of loading a file through the buffer pool, one
+ * Page::insertRecord() call per record with a hasSpaceForRecord() check
+ * before it, against a BulkLoader fed batches of records.  Both include
+ * flushing the file.  The same two ways of filling pages are also timed on
+ * pages in memory, which leaves out the I/O.
+ *
+ *   $ ./bench/bulk_load_bench [records] [record length] [frames]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "buffer.h"
+#include "bulk_loader.h"
+#include "exceptions/file_not_found_exception.h"
+
+using namespace badgerdb;
+
+typedef std::chrono::steady_clock Clock;
+
+static const std::uint32_t BATCH = 256;
+
+static void removeFile(const std::string& name)
+{
+	try
+	{
+		File::remove(name);
+	}
+	catch(const FileNotFoundException &)
+	{
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const std::uint32_t numRecords = argc > 1 ? atoi(argv[1]) : 1000000;
+	const std::uint32_t length = argc > 2 ? atoi(argv[2]) : 32;
+	const std::uint32_t bufs = argc > 3 ? atoi(argv[3]) : 1024;
+
+	std::vector<std::string> records;
+	for (std::uint32_t i = 0; i < numRecords; i++)
+	{
+		std::string record(length, 'a' + i % 26);
+		record.replace(0, 4, reinterpret_cast<const char*>(&i), 4);
+		records.push_back(record);
+	}
+	std::vector<RecordView> views(records.begin(), records.end());
+	removeFile("bench.load.0");
+	removeFile("bench.load.1");
+
+	double single, bulk, singleFill, bulkFill;
+	{
+		Page page;
+		Clock::time_point start = Clock::now();
+		std::uint32_t i = 0;
+		while (i < numRecords)
+		{
+			page = Page();
+			while (i < numRecords && page.hasSpaceForRecord(records[i]))
+				page.insertRecord(records[i++]);
+		}
+		singleFill = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / numRecords;
+
+		start = Clock::now();
+		i = 0;
+		while (i < numRecords)
+		{
+			page = Page();
+			i += page.insertRecords(&views[i], numRecords - i);
+		}
+		bulkFill = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / numRecords;
+	}
+	{
+		File file = File::create("bench.load.0");
+		BufMgr bufMgr(bufs);
+		Clock::time_point start = Clock::now();
+		std::uint32_t i = 0;
+		while (i < numRecords)
+		{
+			PageId pageNo;
+			Page* page;
+			bufMgr.allocPage(&file, pageNo, page);
+			while (i < numRecords && page->hasSpaceForRecord(records[i]))
+				page->insertRecord(records[i++]);
+			bufMgr.unPinPage(&file, pageNo, true);
+		}
+		bufMgr.flushFile(&file);
+		single = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / numRecords;
+	}
+	{
+		File file = File::create("bench.load.1");
+		BufMgr bufMgr(bufs);
+		Clock::time_point start = Clock::now();
+		{
+			BulkLoader loader(&bufMgr, &file);
+			for (std::uint32_t i = 0; i < numRecords; i += BATCH)
+				loader.insertRecords(&views[i], std::min(BATCH, numRecords - i));
+		}
+		bufMgr.flushFile(&file);
+		bulk = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / numRecords;
+	}
+	removeFile("bench.load.0");
+	removeFile("bench.load.1");
+
+	std::cout << numRecords << " records of " << length << " bytes\n";
+	std::cout << "                   buffer pool   in memory\n";
+	std::cout << "insertRecord(s):   " << single << "\t" << singleFill << " ns/record\n";
+	std::cout << "BulkLoader:        " << bulk << "\t" << bulkFill << " ns/record\n";
+
+	return 0;
+}
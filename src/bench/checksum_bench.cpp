@@ -0,0 +1,110 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+/**
+ * Cost of checksumming a page with the CRC-32C versions in crc32c.h, and cost
+ * per page of writing and then reading back every page of a file with and
+ * without File::CHECKSUMS.  Reads are served from the operating system's
+ * cache, so the checksum is a larger share of them than it would be with a
+ * disk.
+ *
+ *   $ ./bench/checksum_bench [pages] [rounds]
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "crc32c.h"
+#include "file.h"
+#include "exceptions/file_not_found_exception.h"
+
+using namespace badgerdb;
+
+typedef std::chrono::steady_clock Clock;
+
+static double since(const Clock::time_point& start, std::uint64_t ops)
+{
+	return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / ops;
+}
+
+static void removeFile(const std::string& name)
+{
+	try
+	{
+		File::remove(name);
+	}
+	catch(const FileNotFoundException &)
+	{
+	}
+}
+
+static void fileRoundTrip(const std::uint32_t flags, const std::uint32_t numPages, double& write, double& read)
+{
+	const std::string name = "bench.checksum";
+	removeFile(name);
+	{
+		File file = File::create(name, flags);
+		std::vector<Page> pages(numPages);
+		for (std::uint32_t p = 0; p < numPages; p++)
+		{
+			file.allocatePage(pages[p]);
+			while (pages[p].hasSpaceForRecord(100))
+			{
+				const std::string record(100, static_cast<char>('a' + std::rand() % 26));
+				pages[p].insertRecord(record);
+			}
+		}
+		Clock::time_point start = Clock::now();
+		for (std::uint32_t p = 0; p < numPages; p++)
+			file.writePage(pages[p]);
+		write = since(start, numPages) / 1000;
+
+		Page page;
+		start = Clock::now();
+		for (PageId pageNo = 1; pageNo <= numPages; pageNo++)
+			file.readPage(pageNo, page);
+		read = since(start, numPages) / 1000;
+	}
+	removeFile(name);
+}
+
+int main(int argc, char** argv)
+{
+	const std::uint32_t numPages = argc > 1 ? atoi(argv[1]) : 4096;
+	const std::uint32_t rounds = argc > 2 ? atoi(argv[2]) : 200000;
+
+	std::vector<char> data(Page::SIZE);
+	for (std::size_t n = 0; n < data.size(); n++)
+		data[n] = static_cast<char>(std::rand());
+
+	std::uint32_t sum = 0;
+	Clock::time_point start = Clock::now();
+	for (std::uint32_t r = 0; r < rounds; r++)
+		sum += Crc32c::extend(r, &data[0], Page::SIZE);
+	const double hardware = since(start, rounds);
+
+	start = Clock::now();
+	for (std::uint32_t r = 0; r < rounds / 4; r++)
+		sum += Crc32c::extendPortable(r, &data[0], Page::SIZE);
+	const double portable = since(start, rounds / 4);
+
+	double plainWrite, plainRead, checkedWrite, checkedRead;
+	fileRoundTrip(0, numPages, plainWrite, plainRead);
+	fileRoundTrip(File::CHECKSUMS, numPages, checkedWrite, checkedRead);
+
+	std::cout << "CRC-32C of an 8KB page:\n";
+	std::cout << "  Crc32c::extend     " << hardware << " ns" << (Crc32c::hardwareAvailable() ? " (SSE4.2)" : " (tables)") << "\n";
+	std::cout << "  table-driven       " << portable << " ns\n";
+	std::cout << numPages << " pages through File:   write us/page  read us/page\n";
+	std::cout << "  no checksums       " << plainWrite << "\t\t" << plainRead << "\n";
+	std::cout << "  File::CHECKSUMS    " << checkedWrite << "\t\t" << checkedRead << "\n";
+	std::cout << "(checksum " << sum << ")\n";
+
+	return 0;
+}
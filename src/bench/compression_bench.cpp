@@ -0,0 +1,107 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+/**
+ * Bytes on disk per page, and cost per page of bulk loading and of reading
+ * back every page, for a plain and a compressed file holding the same
+ * records.  Pages are filled to the given percentage, which shows how much of
+ * each page is unused space.  Reads are served from the operating system's
+ * cache, so they time the per-page CPU cost of decompression rather than the
+ * disk.
+ *
+ *   $ ./bench/compression_bench [pages] [percent full] [record length]
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "buffer.h"
+#include "bulk_loader.h"
+#include "exceptions/file_not_found_exception.h"
+
+using namespace badgerdb;
+
+typedef std::chrono::steady_clock Clock;
+
+static void removeFile(const std::string& name)
+{
+	try
+	{
+		File::remove(name);
+	}
+	catch(const FileNotFoundException &)
+	{
+	}
+}
+
+struct Result
+{
+	double bytesPerPage;
+	double load;
+	double read;
+};
+
+static Result run(const std::string& name, const std::uint32_t flags, const std::uint32_t numPages,
+				  const std::uint32_t percent, const std::uint32_t length)
+{
+	removeFile(name);
+	Result result;
+	{
+		File file = File::create(name, flags);
+		BufMgr bufMgr(1024);
+		std::string record(length, ' ');
+		std::uint32_t n = 0;
+		Clock::time_point start = Clock::now();
+		for (std::uint32_t p = 0; p < numPages; p++)
+		{
+			PageId pageNo;
+			Page* page;
+			bufMgr.allocPage(&file, pageNo, page);
+			while (page->getFreeSpace() > Page::DATA_SIZE * (100 - percent) / 100 && page->hasSpaceForRecord(record))
+			{
+				// Text-like records: a counter followed by a field that varies a little.
+				const std::string prefix = "customer " + std::to_string(n) + " city " + std::to_string(n % 97) + " ";
+				record.replace(0, std::min<std::size_t>(prefix.size(), length), prefix, 0, length);
+				page->insertRecord(record);
+				n++;
+			}
+			bufMgr.unPinPage(&file, pageNo, true);
+		}
+		bufMgr.flushFile(&file);
+		result.load = std::chrono::duration<double, std::micro>(Clock::now() - start).count() / numPages;
+
+		Page page;
+		start = Clock::now();
+		for (PageId pageNo = 1; pageNo <= numPages; pageNo++)
+			file.readPage(pageNo, page);
+		result.read = std::chrono::duration<double, std::micro>(Clock::now() - start).count() / numPages;
+	}
+	std::ifstream onDisk(name, std::ios::binary | std::ios::ate);
+	result.bytesPerPage = static_cast<double>(onDisk.tellg()) / numPages;
+	removeFile(name);
+	return result;
+}
+
+int main(int argc, char** argv)
+{
+	const std::uint32_t numPages = argc > 1 ? atoi(argv[1]) : 4096;
+	const std::uint32_t percent = argc > 2 ? atoi(argv[2]) : 50;
+	const std::uint32_t length = argc > 3 ? atoi(argv[3]) : 64;
+
+	const Result plain = run("bench.compression.0", 0, numPages, percent, length);
+	const Result compressed = run("bench.compression.1", File::COMPRESSED, numPages, percent, length);
+
+	std::cout << numPages << " pages " << percent << "% full of " << length << "-byte records\n";
+	std::cout << "              bytes/page  load us/page  read us/page\n";
+	std::cout << "plain         " << plain.bytesPerPage << "\t" << plain.load << "\t\t" << plain.read << "\n";
+	std::cout << "compressed    " << compressed.bytesPerPage << "\t" << compressed.load << "\t\t" << compressed.read << "\n";
+
+	return 0;
+}
@@ -0,0 +1,109 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+/**
+ * Cost per page of reading a file through a buffer pool an eighth of its size,
+ * so that most reads miss, at random and in order, and of writing every page
+ * back dirty, with the file buffered by the kernel (POSITIONAL) and with
+ * O_DIRECT (DIRECT), in the usual layout and in the File::ALIGNED one.
+ * Buffered reads are likely served from the OS page cache, which is where the
+ * second copy O_DIRECT avoids lives; direct reads always go to the device.
+ *
+ *   $ ./bench/direct_io_bench [pages]
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include "buffer.h"
+#include "exceptions/file_not_found_exception.h"
+
+using namespace badgerdb;
+
+typedef std::chrono::steady_clock Clock;
+
+static double since(const Clock::time_point& start, std::uint64_t ops)
+{
+	return std::chrono::duration<double, std::micro>(Clock::now() - start).count() / ops;
+}
+
+static void run(const char* label, const FileIoConfig::Backend backend, const std::uint32_t flags,
+				const std::uint32_t numPages)
+{
+	const std::string name = "bench.direct_io";
+	try
+	{
+		File::remove(name);
+	}
+	catch(const FileNotFoundException &)
+	{
+	}
+
+	FileIoConfig config;
+	config.backend = backend;
+	double times[3];
+	{
+		File file = File::create(name, flags, config);
+		for (std::uint32_t p = 0; p < numPages; p++)
+		{
+			Page page = file.allocatePage();
+			while (page.hasSpaceForRecord(100))
+				page.insertRecord(std::string(100, static_cast<char>('a' + p % 26)));
+			file.writePage(page);
+		}
+
+		BufMgr mgr(numPages / 8);
+		for (int sequential = 0; sequential < 2; sequential++)
+		{
+			std::uint32_t seed = 1;
+			const Clock::time_point start = Clock::now();
+			for (std::uint32_t n = 0; n < numPages; n++)
+			{
+				PageId pageNo = 1 + n;
+				if (!sequential)
+				{
+					seed = seed * 1103515245 + 12345;
+					pageNo = 1 + (seed >> 8) % numPages;
+				}
+				Page* page;
+				mgr.readPage(&file, pageNo, page);
+				mgr.unPinPage(&file, pageNo, false);
+			}
+			times[sequential] = since(start, numPages);
+			mgr.flushFile(&file);
+		}
+
+		// every page is written back once, either on eviction or by the flush
+		const Clock::time_point start = Clock::now();
+		for (PageId pageNo = 1; pageNo <= numPages; pageNo++)
+		{
+			Page* page;
+			mgr.readPage(&file, pageNo, page);
+			mgr.unPinPage(&file, pageNo, true);
+		}
+		mgr.flushFile(&file);
+		times[2] = since(start, numPages);
+	}
+	File::remove(name);
+
+	std::cout << label << times[0] << "\t\t" << times[1] << "\t\t\t" << times[2] << "\n";
+}
+
+int main(int argc, char** argv)
+{
+	const std::uint32_t numPages = argc > 1 ? atoi(argv[1]) : 8192;
+
+	std::cout << numPages << " pages, " << numPages / 8 << " frames\n";
+	std::cout << "file                  random us/page  sequential us/page  rewrite us/page\n";
+	run("POSITIONAL          ", FileIoConfig::POSITIONAL, 0, numPages);
+	run("POSITIONAL, ALIGNED ", FileIoConfig::POSITIONAL, File::ALIGNED, numPages);
+	run("DIRECT              ", FileIoConfig::DIRECT, 0, numPages);
+	run("DIRECT, ALIGNED     ", FileIoConfig::DIRECT, File::ALIGNED, numPages);
+
+	return 0;
+}
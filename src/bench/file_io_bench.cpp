@@ -0,0 +1,114 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+/**
+ * Cost per page of writing and then reading back every page of a file through
+ * each FileIoConfig backend, of syncing the file once at the end, and of
+ * reading pages at random from several threads at once.  Reads are served
+ * from the operating system's cache.
+ *
+ *   $ ./bench/file_io_bench [pages] [threads]
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "file.h"
+#include "exceptions/file_not_found_exception.h"
+
+using namespace badgerdb;
+
+typedef std::chrono::steady_clock Clock;
+
+static double since(const Clock::time_point& start, std::uint64_t ops)
+{
+	return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / ops;
+}
+
+static void removeFile(const std::string& name)
+{
+	try
+	{
+		File::remove(name);
+	}
+	catch(const FileNotFoundException &)
+	{
+	}
+}
+
+static void run(const char* label, const FileIoConfig::Backend backend, const std::uint32_t numPages,
+				const std::uint32_t numThreads)
+{
+	const std::string name = "bench.file_io";
+	removeFile(name);
+	{
+		FileIoConfig config;
+		config.backend = backend;
+		File file = File::create(name, 0, config);
+		std::vector<Page> pages(numPages);
+		for (std::uint32_t p = 0; p < numPages; p++)
+		{
+			file.allocatePage(pages[p]);
+			while (pages[p].hasSpaceForRecord(100))
+				pages[p].insertRecord(std::string(100, static_cast<char>('a' + p % 26)));
+		}
+
+		Clock::time_point start = Clock::now();
+		for (std::uint32_t p = 0; p < numPages; p++)
+			file.writePage(pages[p]);
+		const double write = since(start, numPages) / 1000;
+
+		start = Clock::now();
+		file.sync();
+		const double sync = since(start, 1) / 1000000;
+
+		Page page;
+		start = Clock::now();
+		for (PageId pageNo = 1; pageNo <= numPages; pageNo++)
+			file.readPage(pageNo, page);
+		const double read = since(start, numPages) / 1000;
+
+		// Every thread reads as many random pages as there are in the file.
+		std::vector<std::thread> threads;
+		start = Clock::now();
+		for (std::uint32_t t = 0; t < numThreads; t++)
+		{
+			threads.push_back(std::thread([&file, numPages, t]()
+			{
+				Page page;
+				std::uint32_t seed = t + 1;
+				for (std::uint32_t n = 0; n < numPages; n++)
+				{
+					seed = seed * 1103515245 + 12345;
+					file.readPage(1 + (seed >> 8) % numPages, page);
+				}
+			}));
+		}
+		for (std::uint32_t t = 0; t < numThreads; t++)
+			threads[t].join();
+		const double shared = since(start, static_cast<std::uint64_t>(numPages) * numThreads) / 1000;
+
+		std::cout << label << write << "\t\t" << read << "\t\t" << shared << "\t\t\t" << sync << "\n";
+	}
+	removeFile(name);
+}
+
+int main(int argc, char** argv)
+{
+	const std::uint32_t numPages = argc > 1 ? atoi(argv[1]) : 4096;
+	const std::uint32_t numThreads = argc > 2 ? atoi(argv[2]) : 4;
+
+	std::cout << numPages << " pages, " << numThreads << " reader threads\n";
+	std::cout << "backend      write us/page  read us/page  threaded read us/page  sync ms\n";
+	run("STREAM       ", FileIoConfig::STREAM, numPages, numThreads);
+	run("POSITIONAL   ", FileIoConfig::POSITIONAL, numPages, numThreads);
+
+	return 0;
+}
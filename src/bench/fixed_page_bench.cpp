@@ -0,0 +1,117 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+/**
+ * Records per page and cost of filling pages, random lookups and scans for
+ * 16-byte records, stored on slotted pages and on FixedPage<16> pages held in
+ * memory.
+ *
+ *   $ ./bench/fixed_page_bench [pages] [lookups]
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+#include "fixed_page.h"
+#include "page_iterator.h"
+
+using namespace badgerdb;
+
+typedef std::chrono::steady_clock Clock;
+typedef FixedPage<16> Fixed16;
+
+static double since(const Clock::time_point& start, std::uint64_t ops)
+{
+	return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / ops;
+}
+
+int main(int argc, char** argv)
+{
+	const std::uint32_t numPages = argc > 1 ? atoi(argv[1]) : 1024;
+	const std::uint32_t lookups = argc > 2 ? atoi(argv[2]) : 10000000;
+
+	char record[16];
+	std::memset(record, 'r', sizeof(record));
+	std::vector<Page> slotted(numPages);
+	std::vector<Page> fixed(numPages);
+
+	Clock::time_point start = Clock::now();
+	std::uint64_t slottedRecords = 0;
+	for (std::uint32_t p = 0; p < numPages; p++)
+	{
+		while (slotted[p].hasSpaceForRecord(sizeof(record)))
+		{
+			slotted[p].insertRecord(record, sizeof(record));
+			slottedRecords++;
+		}
+	}
+	const double slottedFill = since(start, slottedRecords);
+
+	start = Clock::now();
+	std::uint64_t fixedRecords = 0;
+	for (std::uint32_t p = 0; p < numPages; p++)
+	{
+		Fixed16 page = Fixed16::format(&fixed[p]);
+		while (page.hasSpaceForRecord())
+		{
+			page.insertRecord(record);
+			fixedRecords++;
+		}
+	}
+	const double fixedFill = since(start, fixedRecords);
+
+	// Both layouts number their records 1..n on every page, and pages that are
+	// not in a file all have the invalid page number
+	const std::uint32_t slottedPerPage = slottedRecords / numPages;
+	const std::uint32_t fixedPerPage = fixedRecords / numPages;
+	std::uint64_t sum = 0;
+	std::srand(1);
+	start = Clock::now();
+	for (std::uint32_t i = 0; i < lookups; i++)
+	{
+		const std::uint32_t p = std::rand() % numPages;
+		const RecordId rid = {Page::INVALID_NUMBER, static_cast<SlotId>(std::rand() % slottedPerPage + 1)};
+		sum += slotted[p].getRecordView(rid)[0];
+	}
+	const double slottedLookup = since(start, lookups);
+
+	std::srand(1);
+	start = Clock::now();
+	for (std::uint32_t i = 0; i < lookups; i++)
+	{
+		const std::uint32_t p = std::rand() % numPages;
+		const RecordId rid = {Page::INVALID_NUMBER, static_cast<SlotId>(std::rand() % fixedPerPage + 1)};
+		sum += Fixed16(&fixed[p]).getRecord(rid)[0];
+	}
+	const double fixedLookup = since(start, lookups);
+
+	start = Clock::now();
+	for (std::uint32_t p = 0; p < numPages; p++)
+	{
+		for (RecordViewIterator iter = slotted[p].beginViews(); iter != slotted[p].endViews(); ++iter)
+			sum += (*iter).second[0];
+	}
+	const double slottedScan = since(start, slottedRecords);
+
+	start = Clock::now();
+	for (std::uint32_t p = 0; p < numPages; p++)
+	{
+		const Fixed16 page(&fixed[p]);
+		for (Fixed16::Iterator iter = page.begin(); iter != page.end(); ++iter)
+			sum += (*iter).second[0];
+	}
+	const double fixedScan = since(start, fixedRecords);
+
+	std::cout << "             records/page  fill ns  lookup ns  scan ns\n";
+	std::cout << "slotted      " << slottedPerPage << "\t\t" << slottedFill << "\t" << slottedLookup << "\t" << slottedScan << "\n";
+	std::cout << "FixedPage<16> " << fixedPerPage << "\t\t" << fixedFill << "\t" << fixedLookup << "\t" << fixedScan << "\n";
+	std::cout << "(checksum " << sum << ")\n";
+
+	return 0;
+}
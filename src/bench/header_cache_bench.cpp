@@ -0,0 +1,104 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+/**
+ * Cost of the File operations that consult the file header: allocating pages,
+ * reading them back with the bounds-checked File::readPage(), starting an
+ * iteration with File::begin(), and deleting pages, with each FileIoConfig
+ * backend.  Reads are served from the operating system's cache.
+ *
+ *   $ ./bench/header_cache_bench [pages]
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include "file.h"
+#include "file_iterator.h"
+#include "exceptions/file_not_found_exception.h"
+
+using namespace badgerdb;
+
+typedef std::chrono::steady_clock Clock;
+
+static double since(const Clock::time_point& start, std::uint64_t ops)
+{
+	return std::chrono::duration<double, std::micro>(Clock::now() - start).count() / ops;
+}
+
+static std::uint64_t run(const char* label, const FileIoConfig::Backend backend, const std::uint32_t numPages)
+{
+	const std::string name = "bench.header_cache";
+	try
+	{
+		File::remove(name);
+	}
+	catch(const FileNotFoundException &)
+	{
+	}
+
+	FileIoConfig config;
+	config.backend = backend;
+	double times[4];
+	std::uint64_t sum = 0;
+	{
+		File file = File::create(name, 0, config);
+		Clock::time_point start = Clock::now();
+		for (std::uint32_t p = 0; p < numPages; p++)
+		{
+			Page page = file.allocatePage();
+			page.insertRecord("header cache");
+			file.writePage(page);
+		}
+		times[0] = since(start, numPages);
+
+		std::uint32_t seed = 1;
+		start = Clock::now();
+		for (std::uint32_t n = 0; n < numPages; n++)
+		{
+			seed = seed * 1103515245 + 12345;
+			sum += file.readPage(1 + (seed >> 8) % numPages).getFreeSpace();
+		}
+		times[1] = since(start, numPages);
+
+		start = Clock::now();
+		for (std::uint32_t n = 0; n < numPages; n++)
+		{
+			sum += (*file.begin()).page_number();
+		}
+		times[2] = since(start, numPages);
+
+		// the head of the used list, so that no list is walked
+		start = Clock::now();
+		for (PageId pageNo = 1; pageNo <= numPages; pageNo++)
+		{
+			file.deletePage(pageNo);
+		}
+		times[3] = since(start, numPages);
+		file.sync();
+	}
+	File::remove(name);
+
+	std::cout << label << times[0] << "\t\t" << times[1] << "\t\t" << times[2] << "\t\t" << times[3] << "\n";
+	return sum;
+}
+
+int main(int argc, char** argv)
+{
+	const std::uint32_t numPages = argc > 1 ? atoi(argv[1]) : 4096;
+
+	std::cout << numPages << " pages\n";
+	std::cout << "backend      allocate us  readPage us  begin us  delete us\n";
+	std::uint64_t sum = 0;
+	sum += run("STREAM       ", FileIoConfig::STREAM, numPages);
+	sum += run("POSITIONAL   ", FileIoConfig::POSITIONAL, numPages);
+	sum += run("DIRECT       ", FileIoConfig::DIRECT, numPages);
+	std::cout << "(checksum " << sum << ")\n";
+
+	return 0;
+}
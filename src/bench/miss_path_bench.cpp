@@ -0,0 +1,125 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+/**
+ * Measures the cost of a buffer pool miss. The hash table part of the miss is
+ * timed twice: once through the throwing lookup() (the old readPage() path,
+ * which caught HashNotFoundException) and once through tryLookup(). The end to
+ * end readPage() miss latency is reported for reference, together with the
+ * probe lengths of the hash table at the load BufMgr sizes it for.
+ */
+
+#include <chrono>
+#include <iostream>
+#include <vector>
+#include "buffer.h"
+#include "bufHashTbl.h"
+#include "exceptions/file_not_found_exception.h"
+#include "exceptions/hash_not_found_exception.h"
+
+using namespace badgerdb;
+
+typedef std::chrono::steady_clock Clock;
+
+static double nsPerOp(Clock::time_point start, Clock::time_point end, std::uint32_t ops)
+{
+	return std::chrono::duration<double, std::nano>(end - start).count() / ops;
+}
+
+int main()
+{
+	const std::uint32_t bufs = 1000;
+	const std::uint32_t ops = 200000;
+	const std::string filename = "bench.miss";
+
+	try
+	{
+		File::remove(filename);
+	}
+	catch(const FileNotFoundException &)
+	{
+	}
+
+	{
+		File file = File::create(filename);
+		BufHashTbl hashTable(((int) (bufs * 1.2)) + 1);
+		for (FrameId i = 0; i < bufs; i++)
+			hashTable.insert(&file, i + 1, i);
+
+		// Probe lengths of a table sized as BufMgr sizes it, holding one page per frame
+		// spread over four files.
+		{
+			std::vector<File> files(4, file);
+			BufHashTbl shared(((int) (bufs * 1.2)) + 1);
+			for (FrameId i = 0; i < bufs; i++)
+				shared.insert(&files[i % 4], i / 4 + 1, i);
+			const BufHashTblStats stats = shared.getStats();
+			std::cout << "hash table: " << stats.entries << " entries in " << stats.capacity << " slots (load "
+				<< stats.loadFactor() << "), probe length avg " << stats.avgProbeLength << " max " << stats.maxProbeLength << "\n";
+		}
+
+		// Misses through the throwing lookup().
+		FrameId frameNo;
+		std::uint32_t misses = 0;
+		Clock::time_point start = Clock::now();
+		for (std::uint32_t i = 0; i < ops; i++)
+		{
+			try
+			{
+				hashTable.lookup(&file, bufs + 1 + i, frameNo);
+			}
+			catch(const HashNotFoundException &)
+			{
+				misses++;
+			}
+		}
+		Clock::time_point end = Clock::now();
+		std::cout << "lookup() miss (exception):   " << nsPerOp(start, end, ops) << " ns/op (" << misses << " misses)\n";
+
+		// Misses through tryLookup().
+		misses = 0;
+		start = Clock::now();
+		for (std::uint32_t i = 0; i < ops; i++)
+		{
+			if (!hashTable.tryLookup(&file, bufs + 1 + i, frameNo))
+				misses++;
+		}
+		end = Clock::now();
+		std::cout << "tryLookup() miss (status):   " << nsPerOp(start, end, ops) << " ns/op (" << misses << " misses)\n";
+		const BufHashTblStats stats = hashTable.getStats();
+		std::cout << "probes per lookup:           " << (double) stats.lookupProbes / stats.lookups << "\n";
+
+		// End to end readPage() misses: the file is twice the pool size and is
+		// scanned sequentially, so every access evicts a page.
+		const std::uint32_t pages = bufs * 2;
+		BufMgr bufMgr(bufs);
+		Page* page;
+		PageId pageNo;
+		for (std::uint32_t i = 0; i < pages; i++)
+		{
+			bufMgr.allocPage(&file, pageNo, page);
+			bufMgr.unPinPage(&file, pageNo, true);
+		}
+		bufMgr.flushFile(&file);
+
+		const std::uint32_t reads = pages * 5;
+		start = Clock::now();
+		for (std::uint32_t i = 0; i < reads; i++)
+		{
+			pageNo = (i % pages) + 1;
+			bufMgr.readPage(&file, pageNo, page);
+			bufMgr.unPinPage(&file, pageNo, false);
+		}
+		end = Clock::now();
+		std::cout << "readPage() miss (end to end): " << nsPerOp(start, end, reads) << " ns/op\n";
+
+		bufMgr.flushFile(&file);
+	}
+
+	File::remove(filename);
+	return 0;
+}
@@ -0,0 +1,116 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+/**
+ * Cost per page of reading a read-mostly file through a buffer pool an eighth
+ * of its size, so that most reads miss, with each FileIoConfig backend: pages
+ * at random and in order, with the matching access hint. Every page read is
+ * summed over, so that a mapped page is really touched. The file is likely in
+ * the OS page cache, which is what mapping it is meant for.
+ *
+ *   $ ./bench/mmap_bench [pages]
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include "buffer.h"
+#include "exceptions/file_not_found_exception.h"
+
+using namespace badgerdb;
+
+typedef std::chrono::steady_clock Clock;
+
+static double since(const Clock::time_point& start, std::uint64_t ops)
+{
+	return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / ops;
+}
+
+/**
+ * Sums a few words spread over a page.
+ */
+static std::uint64_t touch(const Page* page)
+{
+	const char* bytes = reinterpret_cast<const char*>(page);
+	std::uint64_t sum = 0;
+	for (std::size_t offset = 0; offset < Page::SIZE; offset += 512)
+		sum += static_cast<unsigned char>(bytes[offset]);
+	return sum;
+}
+
+static std::uint64_t scan(const char* label, const std::string& name, const FileIoConfig::Backend backend,
+						  const std::uint32_t numPages)
+{
+	std::uint64_t sum = 0;
+	double times[2];
+	for (int sequential = 0; sequential < 2; sequential++)
+	{
+		FileIoConfig config;
+		config.backend = backend;
+		config.access = sequential ? FileIoConfig::SEQUENTIAL : FileIoConfig::RANDOM;
+		File file = File::open(name, config);
+		BufMgr mgr(numPages / 8);
+
+		std::uint32_t seed = 1;
+		const Clock::time_point start = Clock::now();
+		for (std::uint32_t n = 0; n < numPages; n++)
+		{
+			PageId pageNo = 1 + n;
+			if (!sequential)
+			{
+				seed = seed * 1103515245 + 12345;
+				pageNo = 1 + (seed >> 8) % numPages;
+			}
+			Page* page;
+			mgr.readPage(&file, pageNo, page);
+			sum += touch(page);
+			mgr.unPinPage(&file, pageNo, false);
+		}
+		times[sequential] = since(start, numPages);
+		mgr.flushFile(&file);
+	}
+	std::cout << label << times[0] << "\t\t\t" << times[1] << "\n";
+	return sum;
+}
+
+int main(int argc, char** argv)
+{
+	const std::uint32_t numPages = argc > 1 ? atoi(argv[1]) : 8192;
+
+	const std::string name = "bench.mmap";
+	try
+	{
+		File::remove(name);
+	}
+	catch(const FileNotFoundException &)
+	{
+	}
+	{
+		FileIoConfig config;
+		config.backend = FileIoConfig::POSITIONAL;
+		File file = File::create(name, 0, config);
+		for (std::uint32_t p = 0; p < numPages; p++)
+		{
+			Page page = file.allocatePage();
+			while (page.hasSpaceForRecord(100))
+				page.insertRecord(std::string(100, static_cast<char>('a' + p % 26)));
+			file.writePage(page);
+		}
+	}
+
+	std::cout << numPages << " pages, " << numPages / 8 << " frames\n";
+	std::cout << "backend      random ns/page  sequential ns/page\n";
+	std::uint64_t sum = 0;
+	sum += scan("STREAM       ", name, FileIoConfig::STREAM, numPages);
+	sum += scan("POSITIONAL   ", name, FileIoConfig::POSITIONAL, numPages);
+	sum += scan("MAPPED       ", name, FileIoConfig::MAPPED, numPages);
+	std::cout << "(checksum " << sum << ")\n";
+
+	File::remove(name);
+	return 0;
+}
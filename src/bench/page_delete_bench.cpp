@@ -0,0 +1,110 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+/**
+ * Cost of record deletes and updates on full pages:
+ *  - drain:  delete every record of a full page in random order
+ *  - churn:  delete a random record and insert a new one in its place
+ *  - update: replace a random record with one of a different length
+ *  - refill: delete half of the records of a full page, then fill it again
+ *
+ *   $ ./bench/page_delete_bench [rounds] [record length]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "page.h"
+
+using namespace badgerdb;
+
+typedef std::chrono::steady_clock Clock;
+
+static double since(const Clock::time_point& start, std::uint64_t ops)
+{
+	return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / ops;
+}
+
+int main(int argc, char** argv)
+{
+	const std::uint32_t rounds = argc > 1 ? atoi(argv[1]) : 200;
+	const std::uint32_t length = argc > 2 ? atoi(argv[2]) : 32;
+
+	const std::string record(length, 'x');
+	Page full;
+	std::vector<RecordId> rids;
+	while (full.hasSpaceForRecord(record))
+		rids.push_back(full.insertRecord(record));
+
+	std::srand(1);
+	std::vector<RecordId> order(rids);
+
+	// Drain: every delete of the eager scheme shifts the records below the hole
+	std::uint64_t ops = 0;
+	Clock::time_point start = Clock::now();
+	for (std::uint32_t r = 0; r < rounds; r++)
+	{
+		Page page = full;
+		std::random_shuffle(order.begin(), order.end());
+		for (std::size_t i = 0; i < order.size(); i++)
+			page.deleteRecord(order[i]);
+		ops += order.size();
+	}
+	const double drain = since(start, ops);
+
+	// Churn: a page that stays full while its records are replaced
+	Page page = full;
+	ops = rounds * rids.size();
+	start = Clock::now();
+	for (std::uint64_t i = 0; i < ops; i++)
+	{
+		RecordId& rid = rids[std::rand() % rids.size()];
+		page.deleteRecord(rid);
+		rid = page.insertRecord(record);
+	}
+	const double churn = since(start, ops);
+
+	// Update: records alternately shrink and grow by a few bytes
+	const std::string shorter(length - length / 4, 'y');
+	page = full;
+	start = Clock::now();
+	for (std::uint64_t i = 0; i < ops; i++)
+	{
+		const RecordId& rid = rids[std::rand() % rids.size()];
+		if (page.getRecordView(rid).length() == length)
+			page.updateRecord(rid, shorter);
+		else
+			page.updateRecord(rid, record);
+	}
+	const double update = since(start, ops);
+
+	// Refill: inserts have to find the slots freed by the deletes
+	ops = 0;
+	start = Clock::now();
+	for (std::uint32_t r = 0; r < rounds; r++)
+	{
+		page = full;
+		std::random_shuffle(order.begin(), order.end());
+		for (std::size_t i = 0; i < order.size() / 2; i++)
+			page.deleteRecord(order[i]);
+		for (std::size_t i = 0; i < order.size() / 2; i++)
+			page.insertRecord(record);
+		ops += order.size() / 2;
+	}
+	const double refill = since(start, ops);
+
+	std::cout << rids.size() << " records of " << length << " bytes per page\n";
+	std::cout << "drain:  " << drain << " ns/delete\n";
+	std::cout << "churn:  " << churn << " ns/delete+insert\n";
+	std::cout << "update: " << update << " ns/update\n";
+	std::cout << "refill: " << refill << " ns/delete+insert\n";
+
+	return 0;
+}
@@ -0,0 +1,103 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+/**
+ * Cost of a buffer hit plus its unpin, through readPage() and unPinPage(),
+ * which looks the page up a second time, and through a PageHandle, which
+ * unpins by frame.
+ *
+ *   $ ./bench/page_handle_bench [frames] [rounds]
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include "buffer.h"
+#include "exceptions/file_not_found_exception.h"
+
+using namespace badgerdb;
+
+typedef std::chrono::steady_clock Clock;
+
+/**
+ * Pages are spread over several files, since appending to a long file walks its page list.
+ */
+static const std::uint32_t PAGES_PER_FILE = 256;
+
+static std::string fileName(std::uint32_t i)
+{
+	std::stringstream ss;
+	ss << "bench.handle." << i;
+	return ss.str();
+}
+
+int main(int argc, char** argv)
+{
+	const std::uint32_t bufs = argc > 1 ? atoi(argv[1]) : 4096;
+	const std::uint32_t rounds = argc > 2 ? atoi(argv[2]) : 200;
+
+	const std::uint32_t numFiles = (bufs + PAGES_PER_FILE - 1) / PAGES_PER_FILE;
+	std::vector<File> files;
+	for (std::uint32_t f = 0; f < numFiles; f++)
+	{
+		try
+		{
+			File::remove(fileName(f));
+		}
+		catch(const FileNotFoundException &)
+		{
+		}
+		files.push_back(File::create(fileName(f)));
+		for (std::uint32_t i = 0; i < PAGES_PER_FILE; i++)
+			files.back().allocatePage();
+	}
+
+	{
+		BufMgr bufMgr(numFiles * PAGES_PER_FILE);
+		Page* page;
+
+		// Load every page, so that all reads below hit
+		for (std::uint32_t i = 0; i < numFiles * PAGES_PER_FILE; i++)
+		{
+			bufMgr.readPage(&files[i / PAGES_PER_FILE], i % PAGES_PER_FILE + 1, page);
+			bufMgr.unPinPage(&files[i / PAGES_PER_FILE], i % PAGES_PER_FILE + 1, false);
+		}
+		const std::uint32_t ops = rounds * numFiles * PAGES_PER_FILE;
+
+		Clock::time_point start = Clock::now();
+		for (std::uint32_t r = 0; r < rounds; r++)
+		{
+			for (std::uint32_t i = 0; i < numFiles * PAGES_PER_FILE; i++)
+			{
+				bufMgr.readPage(&files[i / PAGES_PER_FILE], i % PAGES_PER_FILE + 1, page);
+				bufMgr.unPinPage(&files[i / PAGES_PER_FILE], i % PAGES_PER_FILE + 1, false);
+			}
+		}
+		const double unpin = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / ops;
+
+		start = Clock::now();
+		for (std::uint32_t r = 0; r < rounds; r++)
+		{
+			for (std::uint32_t i = 0; i < numFiles * PAGES_PER_FILE; i++)
+			{
+				PageHandle handle = bufMgr.readPage(&files[i / PAGES_PER_FILE], i % PAGES_PER_FILE + 1);
+			}
+		}
+		const double handle = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / ops;
+
+		std::cout << "readPage + unPinPage: " << unpin << " ns\n";
+		std::cout << "PageHandle:           " << handle << " ns\n";
+	}
+
+	files.clear();
+	for (std::uint32_t f = 0; f < numFiles; f++)
+		File::remove(fileName(f));
+
+	return 0;
+}
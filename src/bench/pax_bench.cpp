@@ -0,0 +1,121 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+/**
+ * Cost per record of summing one 8-byte field of records made of eight such
+ * fields, stored on slotted pages, on FixedPage<64> pages and on PAX pages
+ * held in memory.
+ *
+ *   $ ./bench/pax_bench [pages] [rounds]
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+#include "fixed_page.h"
+#include "page_iterator.h"
+#include "pax_page.h"
+
+using namespace badgerdb;
+
+typedef std::chrono::steady_clock Clock;
+
+static const std::size_t NUM_FIELDS = 8;
+static const std::size_t FIELD = 3;
+
+typedef FixedPage<NUM_FIELDS * sizeof(std::uint64_t)> RowPage;
+
+static std::uint64_t fieldOf(const char* record)
+{
+	std::uint64_t value;
+	std::memcpy(&value, record + FIELD * sizeof(value), sizeof(value));
+	return value;
+}
+
+int main(int argc, char** argv)
+{
+	const std::uint32_t numPages = argc > 1 ? atoi(argv[1]) : 2048;
+	const std::uint32_t rounds = argc > 2 ? atoi(argv[2]) : 20;
+
+	std::vector<Page> slotted(numPages);
+	std::vector<Page> rows(numPages);
+	std::vector<Page> pax(numPages);
+	const std::vector<std::uint16_t> columns(NUM_FIELDS, sizeof(std::uint64_t));
+	std::uint64_t record[NUM_FIELDS];
+	std::uint64_t numRecords = 0;
+	for (std::uint32_t p = 0; p < numPages; p++)
+	{
+		RowPage rowPage = RowPage::format(&rows[p]);
+		PaxPage paxPage = PaxPage::format(&pax[p], columns);
+		while (paxPage.hasSpaceForRecord())
+		{
+			for (std::size_t f = 0; f < NUM_FIELDS; f++)
+				record[f] = numRecords * NUM_FIELDS + f;
+			const char* bytes = reinterpret_cast<const char*>(record);
+			paxPage.insertRecord(bytes);
+			if (rowPage.hasSpaceForRecord())
+				rowPage.insertRecord(bytes);
+			if (slotted[p].hasSpaceForRecord(sizeof(record)))
+				slotted[p].insertRecord(bytes, sizeof(record));
+			numRecords++;
+		}
+	}
+
+	std::uint64_t slottedSum = 0, slottedRecords = 0;
+	Clock::time_point start = Clock::now();
+	for (std::uint32_t r = 0; r < rounds; r++)
+	{
+		for (std::uint32_t p = 0; p < numPages; p++)
+		{
+			for (RecordViewIterator iter = slotted[p].beginViews(); iter != slotted[p].endViews(); ++iter, slottedRecords++)
+				slottedSum += fieldOf((*iter).second.data());
+		}
+	}
+	const double slottedScan = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / slottedRecords;
+
+	std::uint64_t rowSum = 0, rowRecords = 0;
+	start = Clock::now();
+	for (std::uint32_t r = 0; r < rounds; r++)
+	{
+		for (std::uint32_t p = 0; p < numPages; p++)
+		{
+			const RowPage page(&rows[p]);
+			for (RowPage::Iterator iter = page.begin(); iter != page.end(); ++iter, rowRecords++)
+				rowSum += fieldOf((*iter).second.data());
+		}
+	}
+	const double rowScan = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / rowRecords;
+
+	std::uint64_t paxSum = 0, paxRecords = 0;
+	start = Clock::now();
+	for (std::uint32_t r = 0; r < rounds; r++)
+	{
+		for (std::uint32_t p = 0; p < numPages; p++)
+		{
+			const PaxPage page(&pax[p]);
+			const char* values = page.column_data(FIELD);
+			for (SlotId slot = page.nextUsedSlot(Page::INVALID_SLOT); slot != Page::INVALID_SLOT;
+				 slot = page.nextUsedSlot(slot), paxRecords++)
+			{
+				std::uint64_t value;
+				std::memcpy(&value, values + (slot - 1) * sizeof(value), sizeof(value));
+				paxSum += value;
+			}
+		}
+	}
+	const double paxScan = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / paxRecords;
+
+	std::cout << "                records/page  ns/record\n";
+	std::cout << "slotted         " << slottedRecords / rounds / numPages << "\t\t" << slottedScan << "\n";
+	std::cout << "FixedPage<64>   " << rowRecords / rounds / numPages << "\t\t" << rowScan << "\n";
+	std::cout << "PaxPage         " << paxRecords / rounds / numPages << "\t\t" << paxScan << "\n";
+	std::cout << "(checksums " << slottedSum << " " << rowSum << " " << paxSum << ")\n";
+
+	return 0;
+}
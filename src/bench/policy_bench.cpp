@@ -0,0 +1,127 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+/**
+ * Buffer hit ratio of every replacement policy on a mixed workload: skewed
+ * point reads (80% of them to 10% of the pages) interrupted by sequential
+ * scans over all pages, which a recency-only policy lets flush the hot set.
+ * Each policy runs twice: with the scans going through the shared pool, and
+ * with them confined to a BufferAccessStrategy ring.
+ *
+ *   $ ./bench/policy_bench [frames] [accesses]
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <vector>
+#include "buffer.h"
+#include "exceptions/file_not_found_exception.h"
+#include "replacement/clock_policy.h"
+#include "replacement/lru_k_policy.h"
+#include "replacement/two_q_policy.h"
+#include "replacement/arc_policy.h"
+#include "replacement/clock_pro_policy.h"
+
+using namespace badgerdb;
+
+typedef std::chrono::steady_clock Clock;
+
+/**
+ * Pages are spread over several files, since appending to a long file walks its page list.
+ */
+static const std::uint32_t PAGES_PER_FILE = 256;
+
+static std::string fileName(std::uint32_t i)
+{
+	std::stringstream ss;
+	ss << "bench.policy." << i;
+	return ss.str();
+}
+
+int main(int argc, char** argv)
+{
+	const std::uint32_t bufs = argc > 1 ? atoi(argv[1]) : 1024;
+	const std::uint32_t accesses = argc > 2 ? atoi(argv[2]) : 500000;
+
+	// The data set is eight times the pool, the hot set 10% of it
+	const std::uint32_t pages = 8 * bufs;
+	const std::uint32_t hotPages = pages / 10;
+	const std::uint32_t numFiles = (pages + PAGES_PER_FILE - 1) / PAGES_PER_FILE;
+	std::vector<File> files;
+	for (std::uint32_t f = 0; f < numFiles; f++)
+	{
+		try
+		{
+			File::remove(fileName(f));
+		}
+		catch(const FileNotFoundException &)
+		{
+		}
+		files.push_back(File::create(fileName(f)));
+		for (std::uint32_t i = 0; i < PAGES_PER_FILE; i++)
+			files.back().allocatePage();
+	}
+
+	std::cout << "policy      scans    hit ratio   ns/access\n";
+	for (int useRing = 0; useRing <= 1; useRing++)
+	{
+		ReplacementPolicy* policies[] = {new ClockPolicy(), new LruKPolicy(2), new TwoQPolicy(),
+		                                 new ArcPolicy(), new ClockProPolicy()};
+		for (ReplacementPolicy* policy : policies)
+		{
+			BufMgr bufMgr(bufs, policy);
+			BufferAccessStrategy ring;
+			Page* page;
+			std::mt19937 rng(42);
+			std::uniform_int_distribution<std::uint32_t> percent(0, 99);
+			std::uniform_int_distribution<std::uint32_t> hot(0, hotPages - 1);
+			std::uniform_int_distribution<std::uint32_t> any(0, pages - 1);
+
+			// Every 50000 accesses a scan reads a quarter of the data set in order
+			std::uint32_t scanPos = 0, scanLeft = 0;
+			Clock::time_point start = Clock::now();
+			for (std::uint32_t n = 0; n < accesses; n++)
+			{
+				if (n % 50000 == 0)
+					scanLeft = pages / 4;
+
+				std::uint32_t i;
+				BufferAccessStrategy* strategy = NULL;
+				if (scanLeft > 0 && n % 2 == 0)
+				{
+					i = scanPos;
+					scanPos = (scanPos + 1) % pages;
+					scanLeft--;
+					if (useRing)
+						strategy = &ring;
+				}
+				else
+				{
+					i = percent(rng) < 80 ? hot(rng) : any(rng);
+				}
+
+				File* file = &files[i / PAGES_PER_FILE];
+				bufMgr.readPage(file, i % PAGES_PER_FILE + 1, page, strategy);
+				bufMgr.unPinPage(file, i % PAGES_PER_FILE + 1, false);
+			}
+			const double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / accesses;
+
+			const BufStats& stats = bufMgr.getBufStats();
+			std::cout.width(12);
+			std::cout << std::left << stats.policy << (useRing ? "ring     " : "shared   ") << stats.hitRatio() << "\t" << ns << "\n";
+		}
+	}
+
+	files.clear();
+	for (std::uint32_t f = 0; f < numFiles; f++)
+		File::remove(fileName(f));
+
+	return 0;
+}
@@ -0,0 +1,129 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+/**
+ * Buffer miss latency against buffer pool size. For every pool size this
+ * reports the cost of
+ *  - a cold miss, served from the free list of invalid frames,
+ *  - a miss in a full pool with half of the frames pinned, served by the clock,
+ *  - finding out that every frame is pinned (BufferExceededException).
+ *
+ *   $ ./bench/pool_size_bench [largest pool size]
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include "buffer.h"
+#include "exceptions/buffer_exceeded_exception.h"
+#include "exceptions/file_not_found_exception.h"
+
+using namespace badgerdb;
+
+typedef std::chrono::steady_clock Clock;
+
+/**
+ * Pages are spread over several files, since appending to a long file walks its page list.
+ */
+static const std::uint32_t PAGES_PER_FILE = 256;
+
+static double nsSince(Clock::time_point start, std::uint32_t ops)
+{
+	return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / ops;
+}
+
+static std::string fileName(std::uint32_t i)
+{
+	std::stringstream ss;
+	ss << "bench.pool." << i;
+	return ss.str();
+}
+
+int main(int argc, char** argv)
+{
+	const std::uint32_t largest = argc > 1 ? atoi(argv[1]) : 65536;
+
+	std::cout << "frames   cold miss ns   clock miss ns   all pinned ns\n";
+	for (std::uint32_t bufs = 1024; bufs <= largest; bufs *= 4)
+	{
+		// Pages 0 .. bufs + bufs / 2 - 1, numbered across files
+		const std::uint32_t pages = bufs + bufs / 2;
+		const std::uint32_t numFiles = (pages + PAGES_PER_FILE - 1) / PAGES_PER_FILE;
+		std::vector<File> files;
+		for (std::uint32_t f = 0; f < numFiles; f++)
+		{
+			try
+			{
+				File::remove(fileName(f));
+			}
+			catch(const FileNotFoundException &)
+			{
+			}
+			files.push_back(File::create(fileName(f)));
+			for (std::uint32_t i = 0; i < PAGES_PER_FILE; i++)
+				files.back().allocatePage();
+		}
+
+		{
+			BufMgr bufMgr(bufs);
+			Page* page;
+
+			// Cold misses fill the pool from the free list
+			Clock::time_point start = Clock::now();
+			for (std::uint32_t i = 0; i < bufs; i++)
+			{
+				File* file = &files[i / PAGES_PER_FILE];
+				bufMgr.readPage(file, i % PAGES_PER_FILE + 1, page);
+				bufMgr.unPinPage(file, i % PAGES_PER_FILE + 1, false);
+			}
+			const double cold = nsSince(start, bufs);
+
+			// Pin the first half of the pool, then cycle through more pages than the
+			// other half holds, so that every read misses
+			for (std::uint32_t i = 0; i < bufs / 2; i++)
+				bufMgr.readPage(&files[i / PAGES_PER_FILE], i % PAGES_PER_FILE + 1, page);
+			start = Clock::now();
+			for (std::uint32_t i = bufs / 2; i < pages; i++)
+			{
+				File* file = &files[i / PAGES_PER_FILE];
+				bufMgr.readPage(file, i % PAGES_PER_FILE + 1, page);
+				bufMgr.unPinPage(file, i % PAGES_PER_FILE + 1, false);
+			}
+			const double clock = nsSince(start, pages - bufs / 2);
+
+			// Pin the rest of the pool and count how fast a miss is refused
+			for (std::uint32_t i = bufs / 2; i < bufs; i++)
+				bufMgr.readPage(&files[i / PAGES_PER_FILE], i % PAGES_PER_FILE + 1, page);
+			const std::uint32_t attempts = 1000;
+			start = Clock::now();
+			for (std::uint32_t n = 0; n < attempts; n++)
+			{
+				try
+				{
+					bufMgr.readPage(&files[numFiles - 1], PAGES_PER_FILE, page);
+				}
+				catch(const BufferExceededException &)
+				{
+				}
+			}
+			const double pinned = nsSince(start, attempts);
+
+			std::cout << bufs << "\t " << cold << "\t\t" << clock << "\t\t" << pinned << "\n";
+
+			for (std::uint32_t i = 0; i < bufs; i++)
+				bufMgr.unPinPage(&files[i / PAGES_PER_FILE], i % PAGES_PER_FILE + 1, false);
+		}
+
+		files.clear();
+		for (std::uint32_t f = 0; f < numFiles; f++)
+			File::remove(fileName(f));
+	}
+
+	return 0;
+}
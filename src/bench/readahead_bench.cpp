@@ -0,0 +1,96 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+/**
+ * Sequential scan time with and without read-ahead. Each page is "processed"
+ * for a few microseconds, which read-ahead can overlap with reading the next
+ * pages. The files are likely in the OS page cache, so this measures the best
+ * case for synchronous reads.
+ *
+ *   $ ./bench/readahead_bench [files] [processing us per page]
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include "buffer.h"
+#include "exceptions/file_not_found_exception.h"
+
+using namespace badgerdb;
+
+typedef std::chrono::steady_clock Clock;
+
+/**
+ * Pages are spread over several files, since appending to a long file walks its page list.
+ */
+static const std::uint32_t PAGES_PER_FILE = 256;
+
+static std::string fileName(std::uint32_t i)
+{
+	std::stringstream ss;
+	ss << "bench.readahead." << i;
+	return ss.str();
+}
+
+int main(int argc, char** argv)
+{
+	const std::uint32_t numFiles = argc > 1 ? atoi(argv[1]) : 32;
+	const std::uint32_t workUs = argc > 2 ? atoi(argv[2]) : 5;
+
+	std::vector<File> files;
+	for (std::uint32_t f = 0; f < numFiles; f++)
+	{
+		try
+		{
+			File::remove(fileName(f));
+		}
+		catch(const FileNotFoundException &)
+		{
+		}
+		files.push_back(File::create(fileName(f)));
+		for (std::uint32_t i = 0; i < PAGES_PER_FILE; i++)
+			files.back().allocatePage();
+	}
+
+	std::cout << "read-ahead   ms    us/page   prefetched   hits   wasted\n";
+	for (int withReadAhead = 0; withReadAhead <= 1; withReadAhead++)
+	{
+		// The pool holds an eighth of the data, so every scan reads from the files
+		BufMgr bufMgr(numFiles * PAGES_PER_FILE / 8);
+		if (withReadAhead)
+			bufMgr.startReadAhead();
+
+		Page* page;
+		const Clock::time_point start = Clock::now();
+		for (std::uint32_t f = 0; f < numFiles; f++)
+		{
+			for (PageId i = 1; i <= PAGES_PER_FILE; i++)
+			{
+				bufMgr.readPage(&files[f], i, page);
+				const Clock::time_point busy = Clock::now() + std::chrono::microseconds(workUs);
+				while (Clock::now() < busy)
+				{
+				}
+				bufMgr.unPinPage(&files[f], i, false);
+			}
+		}
+		const double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+		bufMgr.stopReadAhead();
+
+		const BufStats& stats = bufMgr.getBufStats();
+		std::cout << (withReadAhead ? "on" : "off") << "\t     " << ms << "\t" << ms * 1000 / (numFiles * PAGES_PER_FILE)
+			<< "\t" << stats.prefetches << "\t     " << stats.prefetchHits << "\t    " << stats.prefetchWasted << "\n";
+	}
+
+	files.clear();
+	for (std::uint32_t f = 0; f < numFiles; f++)
+		File::remove(fileName(f));
+
+	return 0;
+}
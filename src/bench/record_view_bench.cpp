@@ -0,0 +1,82 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+/**
+ * Cost per record of scanning pages through PageIterator, which copies every
+ * record into a std::string, and through RecordViewIterator, which does not.
+ *
+ *   $ ./bench/record_view_bench [pages] [rounds] [record length]
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "page.h"
+#include "page_iterator.h"
+
+using namespace badgerdb;
+
+typedef std::chrono::steady_clock Clock;
+
+int main(int argc, char** argv)
+{
+	const std::uint32_t numPages = argc > 1 ? atoi(argv[1]) : 256;
+	const std::uint32_t rounds = argc > 2 ? atoi(argv[2]) : 100;
+	const std::uint32_t length = argc > 3 ? atoi(argv[3]) : 48;
+
+	std::vector<Page> pages(numPages);
+	const std::string record(length, 'x');
+	std::uint64_t numRecords = 0;
+	for (std::uint32_t p = 0; p < numPages; p++)
+	{
+		while (pages[p].hasSpaceForRecord(record))
+		{
+			pages[p].insertRecord(record);
+			numRecords++;
+		}
+	}
+	const std::uint64_t ops = numRecords * rounds;
+
+	// Sum the bytes so that the scans cannot be optimized away
+	std::uint64_t copyBytes = 0;
+	Clock::time_point start = Clock::now();
+	for (std::uint32_t r = 0; r < rounds; r++)
+	{
+		for (std::uint32_t p = 0; p < numPages; p++)
+		{
+			for (PageIterator iter = pages[p].begin(); iter != pages[p].end(); ++iter)
+				copyBytes += (*iter).length();
+		}
+	}
+	const double copy = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / ops;
+
+	std::uint64_t viewBytes = 0;
+	start = Clock::now();
+	for (std::uint32_t r = 0; r < rounds; r++)
+	{
+		for (std::uint32_t p = 0; p < numPages; p++)
+		{
+			for (RecordViewIterator iter = pages[p].beginViews(); iter != pages[p].endViews(); ++iter)
+				viewBytes += (*iter).second.length();
+		}
+	}
+	const double view = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / ops;
+
+	if (copyBytes != viewBytes)
+	{
+		std::cerr << "Scans disagree: " << copyBytes << " vs " << viewBytes << " bytes\n";
+		return 1;
+	}
+
+	std::cout << numRecords << " records of " << length << " bytes\n";
+	std::cout << "PageIterator:       " << copy << " ns/record\n";
+	std::cout << "RecordViewIterator: " << view << " ns/record\n";
+
+	return 0;
+}
@@ -0,0 +1,121 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+/**
+ * Cost of walking the used slots of a page testing one slot at a time, with
+ * SlotScan::nextUsed(), with a PageIterator, and of a full RecordViewIterator
+ * scan which also reads each record, over pages of 2-byte records with
+ * varying shares of their records deleted.  Every page has the same number of
+ * slots.
+ *
+ *   $ ./bench/slot_scan_bench [pages] [rounds]
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+#include "page_iterator.h"
+#include "slot_scan.h"
+
+using namespace badgerdb;
+
+typedef std::chrono::steady_clock Clock;
+
+int main(int argc, char** argv)
+{
+	const std::uint32_t numPages = argc > 1 ? atoi(argv[1]) : 256;
+	const std::uint32_t rounds = argc > 2 ? atoi(argv[2]) : 200;
+	const int percents[] = {100, 50, 10, 1};
+
+	std::cout << "slot search: " << SlotScan::kernel() << "\n";
+	std::cout << "ns per page  slots   one by one  nextUsed  PageIterator  record views\n";
+	for (std::size_t p = 0; p < sizeof(percents) / sizeof(percents[0]); p++)
+	{
+		std::vector<Page> pages(numPages);
+		std::vector<std::vector<PageSlot> > directories(numPages);
+		SlotId numSlots = 0;
+		std::srand(1);
+		for (std::uint32_t n = 0; n < numPages; n++)
+		{
+			std::vector<RecordId> rids;
+			while (pages[n].hasSpaceForRecord("ab"))
+				rids.push_back(pages[n].insertRecord("ab"));
+			// The last record stays so that every page keeps all of its slots.
+			for (std::size_t r = 0; r + 1 < rids.size(); r++)
+			{
+				if (std::rand() % 100 >= percents[p])
+					pages[n].deleteRecord(rids[r]);
+			}
+			numSlots = rids.size();
+			// The same used flags, for calling the searches directly.
+			directories[n].resize(numSlots);
+			for (std::size_t r = 0; r < rids.size(); r++)
+				directories[n][r].used = false;
+			for (PageIterator iter = pages[n].begin(); iter != pages[n].end(); ++iter)
+				directories[n][iter.record_id().slot_number - 1].used = true;
+		}
+
+		std::uint64_t found = 0;
+		Clock::time_point start = Clock::now();
+		for (std::uint32_t r = 0; r < rounds; r++)
+		{
+			for (std::uint32_t n = 0; n < numPages; n++)
+			{
+				const PageSlot* slots = &directories[n][0];
+				for (SlotId s = 1; s <= numSlots; s++)
+				{
+					if (slots[s - 1].used)
+						found += s;
+				}
+			}
+		}
+		const double scalar = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / rounds / numPages;
+
+		start = Clock::now();
+		for (std::uint32_t r = 0; r < rounds; r++)
+		{
+			for (std::uint32_t n = 0; n < numPages; n++)
+			{
+				const PageSlot* slots = &directories[n][0];
+				for (SlotId s = SlotScan::nextUsed(slots, numSlots, Page::INVALID_SLOT); s != Page::INVALID_SLOT;
+					 s = SlotScan::nextUsed(slots, numSlots, s))
+					found += s;
+			}
+		}
+		const double simd = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / rounds / numPages;
+
+		start = Clock::now();
+		for (std::uint32_t r = 0; r < rounds; r++)
+		{
+			for (std::uint32_t n = 0; n < numPages; n++)
+			{
+				const PageIterator end = pages[n].end();
+				for (PageIterator iter = pages[n].begin(); iter != end; ++iter)
+					found += iter.record_id().slot_number;
+			}
+		}
+		const double iterated = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / rounds / numPages;
+
+		std::uint64_t bytes = 0;
+		start = Clock::now();
+		for (std::uint32_t r = 0; r < rounds; r++)
+		{
+			for (std::uint32_t n = 0; n < numPages; n++)
+			{
+				for (RecordViewIterator iter = pages[n].beginViews(); iter != pages[n].endViews(); ++iter)
+					bytes += (*iter).second.size();
+			}
+		}
+		const double iterator = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / rounds / numPages;
+
+		std::cout << percents[p] << "% used\t     " << numSlots << "\t" << scalar << "\t" << simd << "\t  " << iterated << "\t"
+				  << iterator << "\t(" << found + bytes << ")\n";
+	}
+
+	return 0;
+}
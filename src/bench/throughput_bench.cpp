@@ -0,0 +1,117 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+/**
+ * Multi-threaded buffer manager throughput. Every thread pins and unpins
+ * random pages of a shared file through one BufMgr; the run is repeated with
+ * 1, 2, 4, ... up to N threads (first argument, defaults to the number of
+ * hardware threads, at least 4).
+ *
+ *   $ ./bench/throughput_bench [threads] [seconds per run]
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+#include "buffer.h"
+#include "exceptions/file_not_found_exception.h"
+
+using namespace badgerdb;
+
+typedef std::chrono::steady_clock Clock;
+
+/**
+ * Pins and unpins random pages until the deadline, and returns the number of pins.
+ */
+static std::uint64_t worker(BufMgr* bufMgr, File* file, std::uint32_t pages, unsigned seed, Clock::time_point deadline)
+{
+	std::mt19937 rng(seed);
+	std::uniform_int_distribution<PageId> pick(1, pages);
+	std::uint64_t ops = 0;
+	Page* page;
+
+	while (Clock::now() < deadline)
+	{
+		for (int i = 0; i < 256; i++)
+		{
+			const PageId pageNo = pick(rng);
+			bufMgr->readPage(file, pageNo, page);
+			bufMgr->unPinPage(file, pageNo, (i & 15) == 0);
+		}
+		ops += 256;
+	}
+	return ops;
+}
+
+int main(int argc, char** argv)
+{
+	unsigned maxThreads = std::thread::hardware_concurrency();
+	if (maxThreads < 4)
+		maxThreads = 4;
+	if (argc > 1)
+		maxThreads = atoi(argv[1]);
+	const double seconds = argc > 2 ? atof(argv[2]) : 1.0;
+
+	const std::uint32_t bufs = 4096;
+	const std::uint32_t pages = bufs + bufs / 4;  // mostly hits, some misses
+	const std::string filename = "bench.throughput";
+
+	try
+	{
+		File::remove(filename);
+	}
+	catch(const FileNotFoundException &)
+	{
+	}
+
+	{
+		File file = File::create(filename);
+		BufMgr bufMgr(bufs);
+		Page* page;
+		PageId pageNo;
+		for (std::uint32_t i = 0; i < pages; i++)
+		{
+			bufMgr.allocPage(&file, pageNo, page);
+			bufMgr.unPinPage(&file, pageNo, true);
+		}
+
+		std::cout << "threads  ops/sec     hit ratio\n";
+		for (unsigned threads = 1; threads <= maxThreads; threads *= 2)
+		{
+			bufMgr.clearBufStats();
+			const Clock::time_point start = Clock::now();
+			const Clock::time_point deadline = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+
+			std::vector<std::thread> workers;
+			std::vector<std::uint64_t> ops(threads, 0);
+			for (unsigned t = 0; t < threads; t++)
+				workers.push_back(std::thread([&, t]() { ops[t] = worker(&bufMgr, &file, pages, t + 1, deadline); }));
+			std::uint64_t total = 0;
+			for (unsigned t = 0; t < threads; t++)
+			{
+				workers[t].join();
+				total += ops[t];
+			}
+			const double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+			const BufStats& stats = bufMgr.getBufStats();
+			std::cout << threads << "\t " << (std::uint64_t) (total / elapsed) << "\t     "
+				<< 1.0 - (double) stats.diskreads / stats.accesses << "\n";
+
+			if (threads < maxThreads && threads * 2 > maxThreads)
+				threads = maxThreads / 2;
+		}
+
+		bufMgr.flushFile(&file);
+	}
+
+	File::remove(filename);
+	return 0;
+}
@@ -6,6 +6,7 @@
  */
 
 #include <memory>
+#include <new>
 #include <iostream>
 #include "buffer.h"
 #include "bufHashTbl.h"
@@ -15,100 +16,187 @@
 
 namespace badgerdb {
 
-int BufHashTbl::hash(const File* file, const PageId pageNo)
+constexpr double BufHashTbl::MAX_LOAD;
+
+std::uint64_t BufHashTbl::hash(const File* file, const PageId pageNo)
 {
-  int tmp, value;
-  tmp = (long)file;  // cast of pointer to the file object to an integer
-  value = (tmp + pageNo) % HTSIZE;
-  return value;
+  // splitmix64 finalizer over the file pointer and page number, so that pages of
+  // different files sharing the pool do not cluster in neighbouring slots
+  std::uint64_t value = (std::uint64_t) (std::uintptr_t) file ^ ((std::uint64_t) pageNo * 0x9e3779b97f4a7c15ULL);
+  value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+  return value ^ (value >> 31);
 }
 
 BufHashTbl::BufHashTbl(int htSize)
 	: HTSIZE(htSize)
 {
-  // allocate an array of pointers to hashBuckets
-  ht = new hashBucket* [htSize];
-  for(int i=0; i < HTSIZE; i++)
-    ht[i] = NULL;
+  // give every partition a power of two number of slots, at least 8, enough to
+  // hold an even share of htSize entries below MAX_LOAD
+  std::uint32_t perPartition = 8;
+  while (perPartition * MAX_LOAD < (double) HTSIZE / NUM_PARTITIONS)
+    perPartition *= 2;
+
+  for(int i = 0; i < NUM_PARTITIONS; i++) {
+    hashPartition& part = partitions[i];
+    part.slots = new hashBucket[perPartition]();
+    part.mask = perPartition - 1;
+    part.count = 0;
+    part.lookups = 0;
+    part.probes = 0;
+  }
 }
 
 BufHashTbl::~BufHashTbl()
 {
-  for(int i = 0; i < HTSIZE; i++) {
-    hashBucket* tmpBuf = ht[i];
-    while (ht[i]) {
-      tmpBuf = ht[i];
-      ht[i] = ht[i]->next;
-      delete tmpBuf;
+  for(int i = 0; i < NUM_PARTITIONS; i++)
+    delete [] partitions[i].slots;
+}
+
+void BufHashTbl::grow(hashPartition& part)
+{
+  hashBucket* oldSlots = part.slots;
+  const std::uint32_t oldSize = part.mask + 1;
+
+  part.slots = new (std::nothrow) hashBucket[oldSize * 2]();
+  if (!part.slots) {
+    part.slots = oldSlots;
+    throw HashTableException();
+  }
+  part.mask = oldSize * 2 - 1;
+
+  for (std::uint32_t i = 0; i < oldSize; i++) {
+    if (oldSlots[i].file == NULL)
+      continue;
+    std::uint32_t index = hash(oldSlots[i].file, oldSlots[i].pageNo) & part.mask;
+    while (part.slots[index].file != NULL)
+      index = (index + 1) & part.mask;
+    part.slots[index] = oldSlots[i];
+  }
+  delete [] oldSlots;
+}
+
+BufHashTblStats BufHashTbl::getStats()
+{
+  BufHashTblStats stats = BufHashTblStats();
+  std::uint64_t totalProbes = 0;
+
+  for (int i = 0; i < NUM_PARTITIONS; i++) {
+    hashPartition& part = partitions[i];
+    std::lock_guard<std::mutex> guard(part.latch);
+    stats.entries += part.count;
+    stats.capacity += part.mask + 1;
+    stats.lookups += part.lookups;
+    stats.lookupProbes += part.probes;
+    for (std::uint32_t index = 0; index <= part.mask; index++) {
+      if (part.slots[index].file == NULL)
+        continue;
+      const std::uint32_t home = hash(part.slots[index].file, part.slots[index].pageNo) & part.mask;
+      const std::uint32_t probeLength = ((index - home) & part.mask) + 1;
+      totalProbes += probeLength;
+      if (probeLength > stats.maxProbeLength)
+        stats.maxProbeLength = probeLength;
     }
   }
-  delete [] ht;
+
+  if (stats.entries)
+    stats.avgProbeLength = (double) totalProbes / stats.entries;
+  return stats;
 }
 
 void BufHashTbl::insert(const File* file, const PageId pageNo, const FrameId frameNo)
 {
-  int index = hash(file, pageNo);
-
-  hashBucket* tmpBuc = ht[index];
-  while (tmpBuc) {
-    if (tmpBuc->file == file && tmpBuc->pageNo == pageNo)
-  		throw HashAlreadyPresentException(tmpBuc->file->filename(), tmpBuc->pageNo, tmpBuc->frameNo);
-    tmpBuc = tmpBuc->next;
+  if (!tryInsert(file, pageNo, frameNo)) {
+    FrameId existing = 0;
+    tryLookup(file, pageNo, existing);
+    throw HashAlreadyPresentException(file->filename(), pageNo, existing);
   }
+}
 
-  tmpBuc = new hashBucket;
-  if (!tmpBuc)
-  	throw HashTableException();
+bool BufHashTbl::tryInsert(const File* file, const PageId pageNo, const FrameId frameNo)
+{
+  const std::uint64_t hashValue = hash(file, pageNo);
+  hashPartition& part = partitionOf(hashValue);
+
+  if (part.count + 1 > MAX_LOAD * (part.mask + 1))
+    grow(part);
+
+  std::uint32_t index = hashValue & part.mask;
+  while (part.slots[index].file != NULL) {
+    if (part.slots[index].file == file && part.slots[index].pageNo == pageNo)
+      return false;
+    index = (index + 1) & part.mask;
+  }
 
-  tmpBuc->file = (File*) file;
-  tmpBuc->pageNo = pageNo;
-  tmpBuc->frameNo = frameNo;
-  tmpBuc->next = ht[index];
-  ht[index] = tmpBuc;
+  part.slots[index].file = file;
+  part.slots[index].pageNo = pageNo;
+  part.slots[index].frameNo = frameNo;
+  ++part.count;
+  return true;
 }
 
 void BufHashTbl::lookup(const File* file, const PageId pageNo, FrameId &frameNo) 
 {
-  int index = hash(file, pageNo);
-  hashBucket* tmpBuc = ht[index];
-  while (tmpBuc) {
-    if (tmpBuc->file == file && tmpBuc->pageNo == pageNo)
-    {
-      frameNo = tmpBuc->frameNo; // return frameNo by reference
-      return;
+  if (!tryLookup(file, pageNo, frameNo))
+    throw HashNotFoundException(file->filename(), pageNo);
+}
+
+bool BufHashTbl::tryLookup(const File* file, const PageId pageNo, FrameId &frameNo) 
+{
+  const std::uint64_t hashValue = hash(file, pageNo);
+  hashPartition& part = partitionOf(hashValue);
+
+  ++part.lookups;
+  std::uint32_t index = hashValue & part.mask;
+  while (true) {
+    ++part.probes;
+    const hashBucket& bucket = part.slots[index];
+    if (bucket.file == NULL)
+      return false;
+    if (bucket.file == file && bucket.pageNo == pageNo) {
+      frameNo = bucket.frameNo; // return frameNo by reference
+      return true;
     }
-    tmpBuc = tmpBuc->next;
+    index = (index + 1) & part.mask;
   }
-
-  throw HashNotFoundException(file->filename(), pageNo);
 }
 
 void BufHashTbl::remove(const File* file, const PageId pageNo) {
+  if (!tryRemove(file, pageNo))
+    throw HashNotFoundException(file->filename(), pageNo);
+}
 
-  int index = hash(file, pageNo);
-  hashBucket* tmpBuc = ht[index];
-  hashBucket* prevBuc = NULL;
-
-  while (tmpBuc)
-	{
-    if (tmpBuc->file == file && tmpBuc->pageNo == pageNo)
-		{
-      if(prevBuc) 
-				prevBuc->next = tmpBuc->next;
-      else
-				ht[index] = tmpBuc->next;
-
-      delete tmpBuc;
-      return;
-    }
-		else
-		{
-      prevBuc = tmpBuc;
-      tmpBuc = tmpBuc->next;
-    }
+bool BufHashTbl::tryRemove(const File* file, const PageId pageNo) {
+  const std::uint64_t hashValue = hash(file, pageNo);
+  hashPartition& part = partitionOf(hashValue);
+
+  std::uint32_t index = hashValue & part.mask;
+  while (true) {
+    if (part.slots[index].file == NULL)
+      return false;
+    if (part.slots[index].file == file && part.slots[index].pageNo == pageNo)
+      break;
+    index = (index + 1) & part.mask;
   }
 
-  throw HashNotFoundException(file->filename(), pageNo);
+  // Shift back the following entries of the cluster whose home slot is not
+  // between the hole and their current slot, so every entry stays reachable
+  // from its home slot without tombstones.
+  std::uint32_t hole = index;
+  std::uint32_t next = index;
+  while (true) {
+    next = (next + 1) & part.mask;
+    if (part.slots[next].file == NULL)
+      break;
+    const std::uint32_t home = hash(part.slots[next].file, part.slots[next].pageNo) & part.mask;
+    if (((next - home) & part.mask) >= ((next - hole) & part.mask)) {
+      part.slots[hole] = part.slots[next];
+      hole = next;
+    }
+  }
+  part.slots[hole].file = NULL;
+  --part.count;
+  return true;
 }
 
 }
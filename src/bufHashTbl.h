@@ -7,18 +7,20 @@
 
 #pragma once
 
+#include <mutex>
 #include "file.h"
 
 namespace badgerdb {
 
 /**
-* @brief Declarations for buffer pool hash table
+* @brief Entry of the buffer pool hash table, stored inline in the table. An entry whose file
+* is NULL is empty.
 */
 struct hashBucket {
 	/**
 	 * pointer a file object (more on this below)
 	 */
-	File *file;
+	const File *file;
 
 	/**
 	 * page number within a file
@@ -29,39 +31,157 @@ struct hashBucket {
 	 * frame number of page in the buffer pool
 	 */
 	FrameId frameNo;
+};
+
+
+/**
+* @brief One independently latched part of the buffer pool hash table. Each partition is a
+* flat, power-of-two sized array of entries using linear probing. Padded to a multiple of
+* the cache line size so that latches of neighbouring partitions are not packed together.
+*/
+struct hashPartition {
+	/**
+	 * Mutex guarding every entry of this partition
+	 */
+	std::mutex latch;
+
+	/**
+	 * Array of mask + 1 entries
+	 */
+	hashBucket* slots;
 
 	/**
-	 * Next node in the hash table
+	 * Number of slots minus one
 	 */
-	hashBucket*   next;
+	std::uint32_t mask;
+
+	/**
+	 * Number of entries in use
+	 */
+	std::uint32_t count;
+
+	/**
+	 * Number of lookups done in this partition
+	 */
+	std::uint64_t lookups;
+
+	/**
+	 * Number of slots examined by those lookups
+	 */
+	std::uint64_t probes;
+
+	/**
+	 * Padding up to 128 bytes
+	 */
+	char padding[128 - sizeof(std::mutex) - sizeof(hashBucket*) - 2 * sizeof(std::uint32_t) - 2 * sizeof(std::uint64_t)];
+};
+
+
+/**
+* @brief Probe length statistics of a BufHashTbl
+*/
+struct BufHashTblStats {
+	/**
+	 * Number of entries in the table
+	 */
+	std::uint32_t entries;
+
+	/**
+	 * Number of slots in the table, over all partitions
+	 */
+	std::uint32_t capacity;
+
+	/**
+	 * Mean number of slots a successful lookup of a current entry examines
+	 */
+	double avgProbeLength;
+
+	/**
+	 * Largest number of slots a successful lookup of a current entry examines
+	 */
+	std::uint32_t maxProbeLength;
+
+	/**
+	 * Number of lookups done since the table was created
+	 */
+	std::uint64_t lookups;
+
+	/**
+	 * Number of slots examined by those lookups, hits and misses alike
+	 */
+	std::uint64_t lookupProbes;
+
+	/**
+	 * Returns entries / capacity.
+	 */
+	double loadFactor() const
+	{
+		return capacity ? (double) entries / capacity : 0;
+	}
 };
 
 
 /**
 * @brief Hash table class to keep track of pages in the buffer pool
 *
-* @warning This class is not threadsafe.
+* The table is an open addressing table: entries are stored inline and collisions are
+* resolved by linear probing, so lookups touch consecutive memory and neither insert nor
+* remove allocate. Removal shifts following entries back instead of leaving tombstones.
+*
+* The table is split into NUM_PARTITIONS partitions, each guarded by its own
+* latch. The table does not take these latches itself: a caller must hold
+* partitionLatch(file, pageNo) around every insert, lookup or remove of that
+* (file, pageNo), which lets the buffer manager combine a lookup with pinning
+* the frame it found. A partition doubles in size when its load exceeds MAX_LOAD.
 */
 class BufHashTbl
 {
+ public:
+	/**
+	 *	Number of independently latched partitions
+	 */
+  static const int NUM_PARTITIONS = 64;
+
+	/**
+	 *	Largest fraction of a partition's slots that may be in use before it grows
+	 */
+  static constexpr double MAX_LOAD = 0.75;
+
  private:
 	/**
-	 *	Size of Hash Table
+	 *	Requested size of Hash Table
 	 */
   int HTSIZE;
+
 	/**
-	 * Actual Hash table object
+	 * Partitions of the table
 	 */
-  hashBucket**  ht;
+  hashPartition partitions[NUM_PARTITIONS];
 
 	/**
-	 * returns hash value between 0 and HTSIZE-1 computed using file and pageNo
+	 * returns a mixed 64 bit hash of file and pageNo. The top bits select the partition and
+	 * the low bits the home slot within it.
 	 *
 	 * @param file   	File object
 	 * @param pageNo  Page number in the file
 	 * @return  			Hash value.
 	 */
-  int	 hash(const File* file, const PageId pageNo);
+  static std::uint64_t hash(const File* file, const PageId pageNo);
+
+	/**
+	 * returns the partition (file, pageNo) belongs to
+	 */
+  hashPartition& partitionOf(const std::uint64_t hashValue)
+  {
+    return partitions[hashValue >> 58];
+  }
+
+	/**
+	 * Doubles the number of slots of a partition and reinserts its entries.
+	 *
+	 * @param part		Partition to grow
+	 */
+  void grow(hashPartition& part);
 
  public:
 	/**
@@ -73,6 +193,24 @@ class BufHashTbl
    * Destructor of BufHashTbl class
 	 */
   ~BufHashTbl(); // destructor
+
+	/**
+   * Returns the latch of the partition (file, pageNo) belongs to.
+	 *
+	 * @param file   	File object
+	 * @param pageNo 	Page number in the file
+   * @return  			Latch that must be held while accessing that entry.
+	 */
+  std::mutex& partitionLatch(const File* file, const PageId pageNo)
+  {
+    return partitionOf(hash(file, pageNo)).latch;
+  }
+
+	/**
+   * Returns probe length statistics. Takes every partition latch in turn, so the result
+   * is not a consistent snapshot while other threads use the table.
+	 */
+  BufHashTblStats getStats();
 	
 	/**
    * Insert entry into hash table mapping (file, pageNo) to frameNo.
@@ -81,7 +219,7 @@ class BufHashTbl
 	 * @param pageNo 	Page number in the file
 	 * @param frameNo Frame number assigned to that page of the file
    * @throws  HashAlreadyPresentException	if the corresponding page already exists in the hash table
-   * @throws  HashTableException (optional) if could not create a new bucket as running of memory
+   * @throws  HashTableException (optional) if the partition could not grow as running of memory
 	 */
   void insert(const File* file, const PageId pageNo, const FrameId frameNo);
 
@@ -104,6 +242,38 @@ class BufHashTbl
    * @throws HashNotFoundException if the page entry is not found in the hash table 
 	 */
   void remove(const File* file, const PageId pageNo);  
+
+	/**
+   * Insert entry into hash table mapping (file, pageNo) to frameNo without
+   * throwing if the entry is already present.
+	 *
+	 * @param file   	File object
+	 * @param pageNo 	Page number in the file
+	 * @param frameNo Frame number assigned to that page of the file
+   * @return  			False if the page already exists in the hash table, true otherwise.
+	 */
+  bool tryInsert(const File* file, const PageId pageNo, const FrameId frameNo);
+
+	/**
+   * Check if (file, pageNo) is currently in the buffer pool. Unlike lookup(),
+   * a miss is reported through the return value, so callers on the buffer miss
+   * path do not pay for building and unwinding an exception.
+	 *
+	 * @param file  	File object
+	 * @param pageNo	Page number in the file
+	 * @param frameNo Frame number reference, only written on a hit
+   * @return  			True if the page entry was found in the hash table.
+	 */
+  bool tryLookup(const File* file, const PageId pageNo, FrameId &frameNo);
+
+	/**
+   * Delete entry (file,pageNo) from hash table if it is present.
+	 *
+	 * @param file   	File object
+	 * @param pageNo  Page number in the file
+   * @return  			True if an entry was removed.
+	 */
+  bool tryRemove(const File* file, const PageId pageNo);
 };
 
 }
@@ -15,18 +15,22 @@
  * This is the implementation file. Check class data/member with their access modifiers (public/private),  
  * as well as friends declaration in the header file `buffer.h`.
  * 
- * Controls which pages are memory resident, using the clock algorithm as
- * a buffer replacement policy.
+ * Controls which pages are memory resident. The buffer replacement policy is
+ * pluggable and defaults to the clock algorithm.
  * 			
  */
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
 #include <memory>
+#include <new>
 #include <iostream>
 #include "buffer.h"
+#include "replacement/clock_policy.h"
 #include "exceptions/buffer_exceeded_exception.h"
 #include "exceptions/page_not_pinned_exception.h"
 #include "exceptions/page_pinned_exception.h"
 #include "exceptions/bad_buffer_exception.h"
-#include "exceptions/hash_not_found_exception.h"
 #include "exceptions/invalid_page_exception.h"
 
 namespace badgerdb { 
@@ -41,8 +45,10 @@ namespace badgerdb {
  * page frames and corresponding BufDesc table.  
  *
  */
-BufMgr::BufMgr(std::uint32_t bufs)
-	: numBufs(bufs) {
+BufMgr::BufMgr(std::uint32_t bufs, ReplacementPolicy* policy)
+	: policy(policy != NULL ? policy : new ClockPolicy()), numBufs(bufs), numDirty(0),
+	  writerHand(0), writerStop(false), readAheadBusy(NULL), readAheadStop(false),
+	  readAheadOn(false), ioEngine(NULL) {
 	bufDescTable = new BufDesc[bufs];
 
   for (FrameId i = 0; i < bufs; i++) 
@@ -51,12 +57,28 @@ BufMgr::BufMgr(std::uint32_t bufs)
   	bufDescTable[i].valid = false;
   }
 
-  bufPool = new Page[bufs];
+  // one aligned arena holds every frame, back to back
+  void* arena = NULL;
+  if (posix_memalign(&arena, Page::ALIGNMENT, bufs * sizeof(Page)) != 0)
+    throw std::bad_alloc();
+  bufPool = static_cast<Page*>(arena);
+  for (FrameId i = 0; i < bufs; i++)
+  {
+    new (&bufPool[i]) Page();
+    bufDescTable[i].poolPage = bufDescTable[i].page = &bufPool[i];
+  }
 
   int htsize = ((((int) (bufs * 1.2))*2)/2)+1;
   hashTable = new BufHashTbl (htsize);  // allocate the buffer hash table
 
-  clockHand = bufs - 1;
+  this->policy->init(bufs);
+  bufStats.policy = this->policy->name();
+
+  // every frame starts out unpinned and on the free list, frame 0 on top
+  numUnpinned = bufs;
+  freeFrames.reserve(bufs);
+  for (FrameId i = bufs; i > 0; i--)
+    freeFrames.push_back(i - 1);
 }
 
 /**
@@ -65,169 +87,1094 @@ BufMgr::BufMgr(std::uint32_t bufs)
  */
 BufMgr::~BufMgr() {
 
+	stopReadAhead();
+	stopBackgroundWriter();
+
 	//iterate through buffer pool, and write dirty pages to disk
 	for(FrameId i = 0; i < numBufs; ++i){
 		if(bufDescTable[i].dirty){
-			bufDescTable[i].file->writePage(bufPool[i]);
+			bufDescTable[i].file->writePage(*bufDescTable[i].page);
 		}
 	}
+	stopAsyncIo();
 	
 	//deallocate objects that were allocated during runtime
 	delete hashTable;
-	delete [] bufPool;
+	delete policy;
+	free(bufPool);
 	delete [] bufDescTable;
 }
 
 /**
- * Advances the clock to the next frame of the buffer pool. 
+ * Allocates a free frame, asking the replacement policy for a victim if the
+ * free list is empty, and writes the dirty page to disk if necessary.
+ *
+ * @param frame Frame reference, frame ID of allocated frame returned via this variable.
+ * @throws BufferExceededException Thrown if all buffer frames are pinned.
  *
  */
-void BufMgr::advanceClock()
+void BufMgr::allocBuf(FrameId & frame) 
 {
-	//modulo number of bufs, to not exceed numBufs
-	clockHand = (clockHand + 1) % numBufs;
+	// an invalid frame from the free list needs no victim and no write back
+	if(takeFreeFrame(frame)){
+		return;
+	}
+
+	//BufferExceededException Thrown if all buffer frames are pinned
+	if(numUnpinned <= 0){
+		throw BufferExceededException();
+	}
+
+	const BufDesc* descs = bufDescTable;
+	const ReplacementPolicy::EvictablePredicate unpinned = [descs](FrameId i){
+		return descs[i].pinCnt == 0;
+	};
+
+	while(true){
+		//BufferExceededException Thrown if the policy found all buffer frames pinned.
+		//Concurrent pins can make it fail although the counter said otherwise.
+		FrameId victim;
+		if(!policy->pickVictim(victim, unpinned)){
+			throw BufferExceededException();
+		}
+
+		bool evicted;
+		try{
+			evicted = evictFrame(victim);
+		}
+		catch(...){
+			// the victim could not be written back and keeps its page
+			policy->restore(victim);
+			throw;
+		}
+		if(evicted){
+			policy->recordEvict(victim);
+			frame = victim;
+			return; // It's the caller's (e.g. readPage()'s) responsibility to insert new hashTable entry and call Set()
+		}
+		policy->restore(victim);
+	}
 }
 
 /**
- * Allocates free frame using clock algorithm, and writes dirty page to disk
- * if necessary. 
+ * Evicts the page held by a victim frame. The victim is written back while
+ * holding only its frame latch, so other threads keep hitting and missing on
+ * all other frames.
  *
- * @param frame Frame reference, frame ID of allocated frame returned via this variable.
- * @throws BufferExceededException Thrown if all buffer frames are pinned.
+ * @param frame Frame to evict.
+ * @param expected If given, evict only if the frame still holds this page, unreferenced since loaded.
+ * @return False if the frame was pinned or dirtied meanwhile, and keeps its page.
+ * @throws IoException If the dirty page could not be written back. The page keeps its frame and stays dirty.
+ */
+bool BufMgr::evictFrame(const FrameId frame, const PageKey* expected)
+{
+	BufDesc& desc = bufDescTable[frame];
+
+	// another thread is evicting or flushing this frame
+	std::unique_lock<std::mutex> frameLatch(desc.latch, std::try_to_lock);
+	if(!frameLatch.owns_lock()){
+		return false;
+	}
+	// the frame may have been handed out before we got its latch
+	if(desc.pinCnt){
+		return false;
+	}
+
+	// a ring frame that was evicted and reused, or that other readers found useful
+	if(expected != NULL && (!desc.valid || desc.file != expected->file ||
+	                        desc.pageNo != expected->pageNo || desc.refbit)){
+		return false;
+	}
+
+	// if valid bit is not set, found frame. Invalid frames are not in the hash
+	// table, so nobody but an allocator holding the frame latch can pin them.
+	if(!desc.valid){
+		desc.pinCnt = 1;
+		numUnpinned--;
+		return true;
+	}
+
+	// if dirty, we need to write back data first. The page stays in the hash
+	// table while it is written, so a concurrent reader finds it here instead
+	// of reading a stale copy from disk.
+	if(desc.dirty.exchange(false)){
+		numDirty--;
+		try{
+			desc.file->writePage(*desc.page);
+		}
+		catch(...){
+			// the page keeps its frame and stays dirty, to be written again later
+			if(!desc.dirty.exchange(true))
+				numDirty++;
+			throw;
+		}
+		bufStats.diskwrites++;
+		// the background writer is not keeping up; run a round now
+		writerWake.notify_one();
+	}
+
+	{
+		std::lock_guard<std::mutex> partitionLatch(hashTable->partitionLatch(desc.file, desc.pageNo));
+		// the page was pinned or dirtied again while we were writing it, or it
+		// was disposed of meanwhile; keep it
+		FrameId current;
+		if(desc.pinCnt || desc.dirty || !hashTable->tryLookup(desc.file, desc.pageNo, current) || current != frame){
+			return false;
+		}
+
+		// remove old hash table entry. Once it is gone nobody can pin the frame.
+		hashTable->remove(desc.file, desc.pageNo);
+		desc.pinCnt = 1;
+		numUnpinned--;
+	}
+
+	// read ahead for nothing; read less ahead in this file
+	if(desc.prefetched.exchange(false)){
+		bufStats.prefetchWasted++;
+		noteWasted(desc.file);
+	}
+
+	// Clear() the buffer description, but keep the frame pinned for the caller
+	desc.file = NULL;
+	desc.pageNo = Page::INVALID_NUMBER;
+	desc.page = desc.poolPage;
+	desc.valid = false;
+	desc.refbit = false;
+	return true;
+}
+
+/**
+ * Claims a dirty, unpinned page to be written back without evicting it. Like
+ * evictFrame() the writer holds only the frame latch while writing; a thread
+ * that pins and dirties the page meanwhile marks it dirty again.
  *
+ * @param frame Frame to clean.
+ * @param latch Set to hold the frame latch on success.
+ * @param file If not NULL, the file the page must belong to.
+ * @return False if the frame is latched, pinned, clean or holds a page of another file.
  */
-void BufMgr::allocBuf(FrameId & frame) 
+bool BufMgr::claimFrame(const FrameId frame, std::unique_lock<std::mutex>& latch, const File* file)
+{
+	BufDesc& desc = bufDescTable[frame];
+	if(!desc.dirty || desc.pinCnt){
+		return false;
+	}
+
+	std::unique_lock<std::mutex> frameLatch(desc.latch, std::try_to_lock);
+	if(!frameLatch.owns_lock() || !desc.valid || (file != NULL && desc.file != file) || desc.pinCnt ||
+	   !desc.dirty.exchange(false)){
+		return false;
+	}
+	numDirty--;
+	latch = std::move(frameLatch);
+	return true;
+}
+
+/**
+ * Writes back claimed pages, handing them to the I/O engine together when
+ * there is one.
+ *
+ * @param frames Frames to write.
+ * @param count Number of frames.
+ * @param background True if the background writer writes them.
+ * @return Number of pages written.
+ */
+std::uint32_t BufMgr::writeFrames(const FrameId* frames, const std::uint32_t count, const bool background)
+{
+	std::vector<bool> failed(count, false);
+	if(ioEngine != NULL){
+		std::vector<IoRequest> requests(count);
+		for(std::uint32_t n = 0; n < count; n++){
+			requests[n].op = IoRequest::WRITE;
+			requests[n].file = bufDescTable[frames[n]].file;
+			requests[n].page = bufDescTable[frames[n]].page;
+		}
+		ioEngine->run(requests.data(), count);
+		for(std::uint32_t n = 0; n < count; n++){
+			failed[n] = requests[n].error != NULL;
+		}
+	}
+	else{
+		for(std::uint32_t n = 0; n < count; n++){
+			try{
+				bufDescTable[frames[n]].file->writePage(*bufDescTable[frames[n]].page);
+			}
+			catch(...){
+				failed[n] = true;
+			}
+		}
+	}
+
+	std::uint32_t written = 0;
+	for(std::uint32_t n = 0; n < count; n++){
+		if(failed[n]){
+			// leave the page to a foreground write, which reports the error
+			if(!bufDescTable[frames[n]].dirty.exchange(true))
+				numDirty++;
+			continue;
+		}
+		written++;
+	}
+	bufStats.diskwrites += written;
+	if(background)
+		bufStats.bgwrites += written;
+	return written;
+}
+
+/**
+ * Number of pages handed to the I/O engine at once.
+ */
+std::uint32_t BufMgr::ioBatch() const
+{
+	return ioEngine != NULL ? std::max<std::uint32_t>(1, ioConfig.queue_depth) : 1;
+}
+
+/**
+ * Body of the background writer. Each round sweeps the frames in order,
+ * cleaning dirty unpinned ones until the dirty count is down to the target or
+ * the round's page budget is spent, then sleeps for the configured delay or
+ * until a miss had to write a victim itself. With an I/O engine the pages
+ * claimed are written in batches of its queue depth.
+ */
+void BufMgr::runWriter()
+{
+	const std::uint32_t batch = ioBatch();
+	std::vector<FrameId> frames;
+	std::vector<std::unique_lock<std::mutex> > latches;
+
+	std::unique_lock<std::mutex> lock(writerLatch);
+	while(!writerStop){
+		lock.unlock();
+
+		const int target = (int) (writerConfig.dirtyRatio * numBufs);
+		std::uint32_t written = 0;
+		for(std::uint32_t visited = 0;
+		    visited < numBufs && written + frames.size() < writerConfig.pagesPerRound && numDirty > target;
+		    ++visited){
+			std::unique_lock<std::mutex> latch;
+			if(claimFrame(writerHand, latch)){
+				frames.push_back(writerHand);
+				latches.push_back(std::move(latch));
+			}
+			writerHand = (writerHand + 1) % numBufs;
+			if(frames.size() == batch){
+				written += writeFrames(frames.data(), frames.size(), true);
+				frames.clear();
+				latches.clear();
+			}
+		}
+		if(!frames.empty()){
+			writeFrames(frames.data(), frames.size(), true);
+			frames.clear();
+			latches.clear();
+		}
+
+		lock.lock();
+		if(!writerStop){
+			writerWake.wait_for(lock, std::chrono::milliseconds(writerConfig.delayMs));
+		}
+	}
+}
+
+/**
+ * Starts the background writer thread.
+ *
+ * @param config Target dirty ratio and write rate of the writer.
+ */
+void BufMgr::startBackgroundWriter(const BgWriterConfig& config)
+{
+	if(writer.joinable()){
+		return;
+	}
+	writerConfig = config;
+	writerStop = false;
+	writer = std::thread(&BufMgr::runWriter, this);
+}
+
+/**
+ * Stops the background writer thread, if running.
+ */
+void BufMgr::stopBackgroundWriter()
+{
+	if(!writer.joinable()){
+		return;
+	}
+	{
+		std::lock_guard<std::mutex> lock(writerLatch);
+		writerStop = true;
+	}
+	writerWake.notify_one();
+	writer.join();
+}
+
+/**
+ * Detects sequential reads of a file and queues read-ahead. A run of two
+ * consecutive pages starts read-ahead with the smallest window; each time the
+ * reader gets within half a window of the end of what was read ahead, the
+ * window doubles and the next run is queued. A jump resets the file.
+ *
+ * @param file File object.
+ * @param pageNo Page number that was requested.
+ */
+void BufMgr::noteAccess(File* file, const PageId pageNo)
+{
+	std::lock_guard<std::mutex> guard(readAheadLatch);
+	ReadAheadState& state = readAheadStates[file];
+	if(state.run > 0 && pageNo == state.next){
+		state.run++;
+	}
+	else{
+		state.run = 1;
+		state.window = 0;
+		state.aheadEnd = pageNo + 1;
+	}
+	state.next = pageNo + 1;
+	// the reader overtook read-ahead
+	if(state.aheadEnd < state.next){
+		state.aheadEnd = state.next;
+	}
+
+	// a single page read is not a pattern
+	if(state.run < 2){
+		return;
+	}
+
+	if(state.window == 0){
+		state.window = readAheadConfig.minWindow;
+	}
+	else if((state.aheadEnd - state.next) * 2 >= state.window){
+		return;
+	}
+	else{
+		state.window = std::min(state.window * 2, readAheadConfig.maxWindow);
+	}
+
+	const PageId end = state.next + state.window;
+	if(end > state.aheadEnd){
+		const ReadAheadRequest request = {file, state.aheadEnd, end - state.aheadEnd};
+		readAheadQueue.push_back(request);
+		state.aheadEnd = end;
+		readAheadWake.notify_one();
+	}
+}
+
+/**
+ * Halves the read-ahead window of a file, down to the smallest window.
+ *
+ * @param file File of the evicted page.
+ */
+void BufMgr::noteWasted(const File* file)
+{
+	std::lock_guard<std::mutex> guard(readAheadLatch);
+	std::map<const File*, ReadAheadState>::iterator it = readAheadStates.find(file);
+	if(it != readAheadStates.end() && it->second.window > readAheadConfig.minWindow){
+		it->second.window = std::max(it->second.window / 2, readAheadConfig.minWindow);
+	}
+}
+
+/**
+ * Forgets a file for read-ahead, so that no page of it is read ahead after
+ * this returns unless it is read again.
+ *
+ * @param file File object.
+ */
+void BufMgr::cancelReadAhead(const File* file)
+{
+	std::unique_lock<std::mutex> lock(readAheadLatch);
+	readAheadStates.erase(file);
+	readAheadQueue.erase(std::remove_if(readAheadQueue.begin(), readAheadQueue.end(),
+	                                    [file](const ReadAheadRequest& request){ return request.file == file; }),
+	                     readAheadQueue.end());
+	readAheadIdle.wait(lock, [this, file](){ return readAheadBusy != file; });
+}
+
+/**
+ * Reads a run of pages ahead of a sequential reader. The pages are loaded
+ * like readPage() loads them, then left unpinned and marked as read ahead;
+ * the first readPage() of each counts as a read-ahead hit.
+ *
+ * @param request Run of pages to read.
+ */
+void BufMgr::prefetch(const ReadAheadRequest& request)
 {
-	// check if all of the buffers are pinned
-	bool allIsPinned = true;
-	for(uint i = 0; i < numBufs; ++i){
-		if (bufDescTable[i].pinCnt == 0){
-			allIsPinned = false;
+	File* file = request.file;
+	PageId first = request.first;
+	PageId count = request.count;
+
+	// no need to read the pages at the start of the run that are buffered already
+	for(; count > 0; first++, count--){
+		FrameId fId;
+		std::lock_guard<std::mutex> guard(hashTable->partitionLatch(file, first));
+		if(!hashTable->tryLookup(file, first, fId)){
 			break;
 		}
 	}
-	//BufferExceededException Thrown if all buffer frames are pinned
-	if(allIsPinned) {
-		throw BufferExceededException(); 
+	if(count == 0){
 		return;
 	}
 
-	while(true){
-		advanceClock();
-		// if valid bit is not set, found frame
-		if(!bufDescTable[clockHand].valid){
-			frame = clockHand;
-			return;
+	if(file->mapped()){
+		// pages of mapped files are only pointed to, which faults them in
+		for(PageId pageNo = first; pageNo < first + count; pageNo++){
+			FrameId fId;
+			{
+				std::lock_guard<std::mutex> guard(hashTable->partitionLatch(file, pageNo));
+				if(hashTable->tryLookup(file, pageNo, fId)){
+					continue;
+				}
+			}
+			try{
+				allocBuf(fId);
+			}
+			catch(const BufferExceededException& e){
+				// every frame is pinned; read-ahead must not get in the way
+				return;
+			}
+			try{
+				loadFrame(file, pageNo, fId);
+			}
+			catch(...){
+				// deleted pages are not worth a frame
+				releaseBuf(fId);
+				continue;
+			}
+			bufStats.diskreads++;
+			bufStats.prefetches++;
+			installPrefetched(file, pageNo, fId);
 		}
-        
-		
-		// if refbit is set, unset it and restart the loop
-		if(bufDescTable[clockHand].refbit){
-			bufDescTable[clockHand].refbit = false;
-			continue;
+		return;
+	}
+
+	if(ioEngine != NULL){
+		// read the missing pages straight into frames, a queue depth at a time
+		std::vector<IoRequest> requests;
+		std::vector<FrameId> frames;
+		const auto readBatch = [this, file, &requests, &frames](){
+			ioEngine->run(requests.data(), requests.size());
+			for(std::size_t n = 0; n < requests.size(); n++){
+				// pages past the end of the file and deleted pages are not worth a frame
+				if(requests[n].error != NULL){
+					releaseBuf(frames[n]);
+					continue;
+				}
+				bufStats.diskreads++;
+				bufStats.prefetches++;
+				installPrefetched(file, requests[n].page_number, frames[n]);
+			}
+			requests.clear();
+			frames.clear();
+		};
+
+		for(PageId pageNo = first; pageNo < first + count; pageNo++){
+			FrameId fId;
+			{
+				std::lock_guard<std::mutex> guard(hashTable->partitionLatch(file, pageNo));
+				if(hashTable->tryLookup(file, pageNo, fId)){
+					continue;
+				}
+			}
+			try{
+				allocBuf(fId);
+			}
+			catch(const BufferExceededException& e){
+				// every frame is pinned; read-ahead must not get in the way
+				break;
+			}
+			IoRequest request;
+			request.op = IoRequest::READ;
+			request.file = file;
+			request.page_number = pageNo;
+			request.page = bufDescTable[fId].page;
+			requests.push_back(request);
+			frames.push_back(fId);
+			if(requests.size() == ioBatch()){
+				readBatch();
+			}
+		}
+		if(!requests.empty()){
+			readBatch();
 		}
+		return;
+	}
 
-		// if page is pinned (pinCnt != 0), restart the loop. else we have found the frame
-		if(bufDescTable[clockHand].pinCnt){
+	std::vector<Page> pages;
+	try{
+		pages = file->readPages(first, count);
+	}
+	catch(const InvalidPageException& e){
+		// the run starts past the end of the file
+		return;
+	}
+
+	for(std::size_t n = 0; n < pages.size(); n++){
+		// deleted pages are not worth a frame
+		const PageId pageNo = pages[n].page_number();
+		if(pageNo == Page::INVALID_NUMBER){
 			continue;
 		}
+		{
+			FrameId fId;
+			std::lock_guard<std::mutex> guard(hashTable->partitionLatch(file, pageNo));
+			if(hashTable->tryLookup(file, pageNo, fId)){
+				continue;
+			}
+		}
 
-		// if dirty, we need to write back data first
-		if(bufDescTable[clockHand].dirty){
-			bufDescTable[clockHand].file->writePage(bufPool[clockHand]);
+		FrameId fId;
+		try{
+			allocBuf(fId);
+		}
+		catch(const BufferExceededException& e){
+			// every frame is pinned; read-ahead must not get in the way
+			return;
 		}
+		*bufDescTable[fId].page = pages[n];
+		bufStats.diskreads++;
+		bufStats.prefetches++;
+		installPrefetched(file, pageNo, fId);
+	}
+}
+
+/**
+ * Enters a page read ahead into the buffer pool, unpinned and marked as read
+ * ahead, unless another thread loaded it meanwhile.
+ *
+ * @param file File object.
+ * @param pageNo Page number of the page read into the frame.
+ * @param frame Frame holding the page.
+ */
+void BufMgr::installPrefetched(File* file, const PageId pageNo, const FrameId frame)
+{
+	std::lock_guard<std::mutex> guard(hashTable->partitionLatch(file, pageNo));
+	FrameId current;
+	if(hashTable->tryLookup(file, pageNo, current)){
+		releaseBuf(frame);
+		return;
+	}
+	hashTable->insert(file, pageNo, frame);
+	BufDesc& desc = bufDescTable[frame];
+	desc.Set(file, pageNo);
+	desc.prefetched = true;
+	desc.refbit = false;
+	policy->recordLoad(frame, PageKey{file, pageNo});
+	// nobody asked for the page yet, so it stays unpinned
+	desc.pinCnt = 0;
+	numUnpinned++;
+}
+
+/**
+ * Body of the read-ahead thread. Serves queued runs in order, keeping
+ * readAheadBusy set to the file it reads from so cancelReadAhead() can wait.
+ */
+void BufMgr::runReadAhead()
+{
+	std::unique_lock<std::mutex> lock(readAheadLatch);
+	while(true){
+		readAheadWake.wait(lock, [this](){ return readAheadStop || !readAheadQueue.empty(); });
+		if(readAheadStop){
+			return;
+		}
+		const ReadAheadRequest request = readAheadQueue.front();
+		readAheadQueue.pop_front();
+		readAheadBusy = request.file;
+		lock.unlock();
+
+		try{
+			prefetch(request);
+		}
+		catch(...){
+			// read-ahead is only a hint; the demand read of the page reports the error
+		}
+
+		lock.lock();
+		readAheadBusy = NULL;
+		readAheadIdle.notify_all();
+	}
+}
+
+/**
+ * Starts the read-ahead thread.
+ *
+ * @param config Smallest and largest read-ahead window.
+ */
+void BufMgr::startReadAhead(const ReadAheadConfig& config)
+{
+	if(readAheadThread.joinable()){
+		return;
+	}
+	readAheadConfig = config;
+	if(readAheadConfig.minWindow < 1){
+		readAheadConfig.minWindow = 1;
+	}
+	if(readAheadConfig.maxWindow < readAheadConfig.minWindow){
+		readAheadConfig.maxWindow = readAheadConfig.minWindow;
+	}
+	readAheadStop = false;
+	readAheadThread = std::thread(&BufMgr::runReadAhead, this);
+	readAheadOn = true;
+}
+
+/**
+ * Stops the read-ahead thread, if running.
+ */
+void BufMgr::stopReadAhead()
+{
+	if(!readAheadThread.joinable()){
+		return;
+	}
+	readAheadOn = false;
+	{
+		std::lock_guard<std::mutex> lock(readAheadLatch);
+		readAheadStop = true;
+		readAheadQueue.clear();
+		readAheadStates.clear();
+	}
+	readAheadWake.notify_one();
+	readAheadThread.join();
+}
+
+/**
+ * Advances a strategy's ring and tries to recycle the frame of the slot it
+ * lands on. The frame leaves the replacement policy without becoming a ghost,
+ * as pages of bulk operations say nothing about future accesses.
+ *
+ * @param strategy Access strategy of the operation.
+ * @param frame Frame reference, frame ID of the reused frame returned via this variable.
+ * @return False if the ring is still growing or its frame cannot be reused.
+ */
+bool BufMgr::takeRingFrame(BufferAccessStrategy& strategy, FrameId & frame)
+{
+	const std::uint32_t limit = std::max<std::uint32_t>(1, std::min(strategy.ringSize, numBufs / 8));
+	if(strategy.ring.size() < limit){
+		strategy.current = strategy.ring.size();
+		const BufferAccessStrategy::Slot empty = {0, PageKey{NULL, Page::INVALID_NUMBER}};
+		strategy.ring.push_back(empty);
+		return false;
+	}
+
+	strategy.current = (strategy.current + 1) % strategy.ring.size();
+	const BufferAccessStrategy::Slot& slot = strategy.ring[strategy.current];
+	if(slot.page.file == NULL || !evictFrame(slot.frame, &slot.page)){
+		return false;
+	}
+	policy->recordRemove(slot.frame);
+	frame = slot.frame;
+	return true;
+}
 
-		// remove old hash table entry
-		hashTable->remove(bufDescTable[clockHand].file, bufDescTable[clockHand].pageNo);
+/**
+ * Releases a frame returned by allocBuf() that ended up not being used.
+ *
+ * @param frame Frame to release.
+ */
+void BufMgr::releaseBuf(const FrameId frame)
+{
+	bufDescTable[frame].Clear();
+	numUnpinned++;
+	addFreeFrame(frame);
+}
 
-		// Clear() the buffer description
-		bufDescTable[clockHand].Clear();
+/**
+ * Takes an invalid frame off the free list and pins it for the caller.
+ *
+ * @param frame Frame reference, frame ID of the frame returned via this variable.
+ * @return False if the free list held no usable frame.
+ */
+bool BufMgr::takeFreeFrame(FrameId & frame)
+{
+	while(true){
+		{
+			std::lock_guard<std::mutex> guard(freeLatch);
+			if(freeFrames.empty()){
+				return false;
+			}
+			frame = freeFrames.back();
+			freeFrames.pop_back();
+		}
 
-		// return frame
-		frame = clockHand;
-		return; // It's the caller's (e.g. readPage()'s) responsibility to insert new hashTable entry and call Set()
+		// the clock may have handed the frame out since it was put on the list
+		BufDesc& desc = bufDescTable[frame];
+		std::lock_guard<std::mutex> frameLatch(desc.latch);
+		if(!desc.valid && desc.pinCnt == 0){
+			desc.pinCnt = 1;
+			numUnpinned--;
+			return true;
+		}
 	}
 }
 
 /**
- * Checks if page is in the bufferpool, via the lookup() method, and handles
- * the frame appropriately, returning a pointer to the frame.
+ * Puts an invalid frame on the free list.
+ *
+ * @param frame Frame that was just cleared.
+ */
+void BufMgr::addFreeFrame(const FrameId frame)
+{
+	std::lock_guard<std::mutex> guard(freeLatch);
+	freeFrames.push_back(frame);
+}
+
+/**
+ * Reads a page, evicting a page chosen by the replacement policy on a miss.
  *
  * @param file Pointer to file to which corresponding frame is assigned.
  * @param pageNo Page within file to which corresponding frame is assigned.
  * @param page Reference to page pointer. Used to fetch the Page object in which requested page from file is read in.
- * @throws HashNotFoundException Thrown if the page is not in the buffer pool.
- *
+ * @throws InvalidPageException Thrown if the page does not exist in the file.
  */
 void BufMgr::readPage(File* file, const PageId pageNo, Page*& page)
+{
+    page = bufDescTable[pinPage(file, pageNo, NULL)].page;
+}
+
+/**
+ * Checks if page is in the bufferpool, via the tryLookup() method, and handles
+ * the frame appropriately, returning a pointer to the frame. A miss is an
+ * ordinary outcome here, so it is reported by tryLookup() rather than thrown.
+ * The frame for a miss comes from the ring of the access strategy, if one is
+ * given and its frame can be recycled.
+ *
+ * @param file Pointer to file to which corresponding frame is assigned.
+ * @param pageNo Page within file to which corresponding frame is assigned.
+ * @param strategy Access strategy of the bulk operation, or NULL.
+ * @return Frame holding the page.
+ * @throws InvalidPageException Thrown if the page does not exist in the file.
+ *
+ */
+FrameId BufMgr::pinPage(File* file, const PageId pageNo, BufferAccessStrategy* strategy)
 {   
+    bufStats.accesses++;
+    if (readAheadOn)
+      noteAccess(file, pageNo);
+
     //We want to first check if this page is already in the buffer pool
+    //Case 1: The page exists in the buffer pool
     FrameId fId;
-    try 
-    {
-        hashTable->lookup(file, pageNo, fId);
-    }
+    if (pinBuffered(file, pageNo, fId))
+      return fId;
 
-    //Case 1: The page does not exist in the buffer pool
-    catch (const HashNotFoundException& e) 
-    {
+    //Case 2: The page does not exist in the buffer pool
     //Call allocBuf() to allocate a buffer frame
     FrameId returnValue;
-    allocBuf(returnValue);
+    if (strategy == NULL || !takeRingFrame(*strategy, returnValue))
+      allocBuf(returnValue);
     //Call the method file->readPage() to read the page from disk into the buffer pool frame
-    bufPool[returnValue] = file->readPage(pageNo);
+    try
+    {
+    loadFrame(file, pageNo, returnValue);
+    }
+    catch (...)
+    {
+    releaseBuf(returnValue);
+    throw;
+    }
+    bufStats.diskreads++;
+    return installPage(file, pageNo, returnValue, strategy);
+}
+
+/**
+ * Pins a page found in the buffer pool, setting its refbit.
+ *
+ * @param file Pointer to file to which corresponding frame is assigned.
+ * @param pageNo Page within file to which corresponding frame is assigned.
+ * @param frame Frame reference, frame ID of the frame holding the page returned via this variable.
+ * @return False on a miss.
+ */
+bool BufMgr::pinBuffered(File* file, const PageId pageNo, FrameId & frame)
+{
+    std::lock_guard<std::mutex> guard(hashTable->partitionLatch(file, pageNo));
+    if (!hashTable->tryLookup(file, pageNo, frame))
+      return false;
+    //Set the appropriate refbit and increment the pinCnt for the page
+    if (bufDescTable[frame].Pin())
+      numUnpinned--;
+    bufStats.hits++;
+    //A page read ahead was reported to the policy as loaded; this is its first use
+    if (bufDescTable[frame].prefetched.exchange(false))
+      bufStats.prefetchHits++;
+    else
+      policy->recordAccess(frame);
+    return true;
+}
+
+/**
+ * Enters a page just read from disk into the hash table and sets up its frame.
+ *
+ * @param file Pointer to file to which corresponding frame is assigned.
+ * @param pageNo Page within file to which corresponding frame is assigned.
+ * @param returnValue Frame the page was read into.
+ * @param strategy Access strategy the frame was taken for, or NULL.
+ * @return Frame holding the page.
+ */
+FrameId BufMgr::installPage(File* file, const PageId pageNo, const FrameId returnValue, BufferAccessStrategy* strategy)
+{
+    FrameId fId;
+    std::lock_guard<std::mutex> guard(hashTable->partitionLatch(file, pageNo));
+    //Another thread may have read the same page while we did; use its frame then
+    if (hashTable->tryLookup(file, pageNo, fId))
+    {
+    releaseBuf(returnValue);
+    if (bufDescTable[fId].Pin())
+      numUnpinned--;
+    if (!bufDescTable[fId].prefetched.exchange(false))
+      policy->recordAccess(fId);
+    return fId;
+    }
     //Insert the page into the hashtable
     hashTable->insert(file, pageNo, returnValue);
     //Invoke Set() on the frame to set it up properly
     bufDescTable[returnValue].Set(file, pageNo);
-    //Return a pointer to the frame containing the page via the page parameter
-    page = &(bufPool[returnValue]);
-    return; 
+    policy->recordLoad(returnValue, PageKey{file, pageNo});
+    if (strategy != NULL)
+    {
+      //Remember the page in the ring; it counts as referenced only once somebody hits it
+      const BufferAccessStrategy::Slot slot = {returnValue, PageKey{file, pageNo}};
+      strategy->ring[strategy->current] = slot;
+      bufDescTable[returnValue].refbit = false;
+    }
+    //Return the frame containing the page
+    return returnValue;
+}
+
+/**
+ * Reads a page into a frame, or for a mapped file points the frame at the
+ * page in the file's mapping.
+ *
+ * @param file Pointer to file to which corresponding frame is assigned.
+ * @param pageNo Page within file to which corresponding frame is assigned.
+ * @param frame Frame obtained from allocBuf().
+ * @throws InvalidPageException Thrown if the page does not exist in the file.
+ */
+void BufMgr::loadFrame(File* file, const PageId pageNo, const FrameId frame)
+{
+    BufDesc& desc = bufDescTable[frame];
+    Page* mapped = file->mapPage(pageNo);
+    if (mapped != NULL)
+      desc.page = mapped;
+    else
+      file->readPage(pageNo, *desc.page);
+}
+
+/**
+ * Reads several pages, pinning the buffered ones first and then reading all
+ * misses together through the I/O engine. Every miss gets its own frame before
+ * anything is read, so a batch needs as many unpinned frames as it misses.
+ *
+ * @param file Pointer to file to which corresponding frame is assigned.
+ * @param pageNos Page numbers in the file to be read.
+ * @param count Number of pages.
+ * @param pages Array of count page pointers, set to the Page objects the pages were read into.
+ * @throws InvalidPageException Thrown if a page does not exist in the file.
+ * @throws BufferExceededException Thrown if too few frames are unpinned.
+ */
+void BufMgr::readPages(File* file, const PageId* pageNos, const std::uint32_t count, Page** pages)
+{
+    //Frames pinned so far, and their generations when pinned
+    std::vector<FrameId> frames;
+    std::vector<std::uint64_t> pinned;
+    frames.reserve(count);
+    pinned.reserve(count);
+    //Pages of mapped files are not read at all
+    if (ioEngine == NULL || file->mapped())
+    {
+      try
+      {
+      for (std::uint32_t n = 0; n < count; n++)
+      {
+        frames.push_back(pinPage(file, pageNos[n], NULL));
+        pinned.push_back(bufDescTable[frames.back()].generation);
+      }
+      }
+      catch (...)
+      {
+      for (std::size_t n = 0; n < frames.size(); n++)
+        unPinFrame(frames[n], pinned[n], false);
+      throw;
+      }
+      for (std::uint32_t n = 0; n < count; n++)
+        pages[n] = bufDescTable[frames[n]].page;
+      return;
+    }
+
+    //Reads of the misses with their frames and the index of the first page asking for each
+    std::vector<IoRequest> requests;
+    std::vector<FrameId> reads;
+    std::vector<std::uint32_t> firsts;
+    //Frame of each miss
+    std::map<PageId, FrameId> missed;
+    //Indexes of the pages asking for a miss some earlier page asked for
+    std::vector<std::uint32_t> repeats;
+    try
+    {
+    for (std::uint32_t n = 0; n < count; n++)
+    {
+      bufStats.accesses++;
+      if (readAheadOn)
+        noteAccess(file, pageNos[n]);
+      if (missed.count(pageNos[n]))
+      {
+        repeats.push_back(n);
+        continue;
+      }
+      FrameId fId;
+      if (pinBuffered(file, pageNos[n], fId))
+      {
+        frames.push_back(fId);
+        pinned.push_back(bufDescTable[fId].generation);
+        pages[n] = bufDescTable[fId].page;
+        continue;
+      }
+      allocBuf(fId);
+      IoRequest request;
+      request.op = IoRequest::READ;
+      request.file = file;
+      request.page_number = pageNos[n];
+      request.page = bufDescTable[fId].page;
+      requests.push_back(request);
+      reads.push_back(fId);
+      firsts.push_back(n);
+      missed[pageNos[n]] = fId;
+    }
+    }
+    catch (...)
+    {
+    for (std::size_t n = 0; n < frames.size(); n++)
+      unPinFrame(frames[n], pinned[n], false);
+    for (std::size_t n = 0; n < reads.size(); n++)
+      releaseBuf(reads[n]);
+    throw;
     }
 
-    //Case 2: The page exists in the buffer pool
-    //Set the appropriate refbit
-    bufDescTable[fId].refbit = true;
-    //Increment the pinCnt for the page
-    bufDescTable[fId].pinCnt++;
-    //Return a pointer to the frame containing the page via the page parameter
-    page = &(bufPool[fId]); // the "return" is here
-    return;
+    ioEngine->run(requests.data(), requests.size());
+
+    std::exception_ptr error;
+    for (std::size_t n = 0; n < requests.size(); n++)
+    {
+      if (requests[n].error != NULL)
+      {
+        if (error == NULL)
+          error = requests[n].error;
+        releaseBuf(reads[n]);
+        continue;
+      }
+      bufStats.diskreads++;
+      const FrameId fId = installPage(file, requests[n].page_number, reads[n], NULL);
+      missed[requests[n].page_number] = fId;
+      frames.push_back(fId);
+      pinned.push_back(bufDescTable[fId].generation);
+      pages[firsts[n]] = bufDescTable[fId].page;
+    }
+    if (error == NULL)
+    {
+      //Pin the pages asked for again; they are pinned already, so they stay in their frames
+      for (std::size_t n = 0; n < repeats.size(); n++)
+      {
+        const FrameId fId = missed[pageNos[repeats[n]]];
+        bufDescTable[fId].Pin();
+        bufStats.hits++;
+        frames.push_back(fId);
+        pinned.push_back(bufDescTable[fId].generation);
+        pages[repeats[n]] = bufDescTable[fId].page;
+      }
+      return;
+    }
+
+    for (std::size_t n = 0; n < frames.size(); n++)
+      unPinFrame(frames[n], pinned[n], false);
+    std::rethrow_exception(error);
+}
+
+/**
+ * Reads a page through an access strategy.
+ *
+ * @param file Pointer to file to which corresponding frame is assigned.
+ * @param pageNo Page within file to which corresponding frame is assigned.
+ * @param page Reference to page pointer. Used to fetch the Page object in which requested page from file is read in.
+ * @param strategy Access strategy of the bulk operation, or NULL.
+ * @throws InvalidPageException Thrown if the page does not exist in the file.
+ */
+void BufMgr::readPage(File* file, const PageId pageNo, Page*& page, BufferAccessStrategy* strategy)
+{
+    page = bufDescTable[pinPage(file, pageNo, strategy)].page;
+}
+
+/**
+ * Reads a page and returns a handle that unpins it.
+ *
+ * @param file Pointer to file to which corresponding frame is assigned.
+ * @param pageNo Page within file to which corresponding frame is assigned.
+ * @param strategy Access strategy of the bulk operation, or NULL.
+ * @return Handle holding the pin on the page.
+ * @throws InvalidPageException Thrown if the page does not exist in the file.
+ */
+PageHandle BufMgr::readPage(File* file, const PageId pageNo, BufferAccessStrategy* strategy)
+{
+    const FrameId frame = pinPage(file, pageNo, strategy);
+    return PageHandle(this, frame, bufDescTable[frame].generation, bufDescTable[frame].page);
 }
 
 /**
- * Unpin a page from memory
+ * Unpin a page from memory. Unpinning a page that is not in the buffer pool
+ * is silently ignored.
  *
  * @param file   	File object.
  * @param PageNo  Page number.
  * @param dirty		True if the page to be unpinned needs to be marked dirty.
- * @throws  HashNotFoundException Thrown If the page is not already pinned.
  * @throws  PageNotPinnedException Thrown If the page is not already pinned.
  */
 void BufMgr::unPinPage(File* file, const PageId pageNo, const bool dirty) 
 {
 	FrameId frameNo = 0;
+	std::lock_guard<std::mutex> guard(hashTable->partitionLatch(file, pageNo));
 
-	try{
-		//Check if our file and pageNo is in the buffer pool, and if not, throw HashNotFoundException and return (catch block)
-		hashTable->lookup(file, pageNo, frameNo);
-
-		//If pincount is set to 0, throw PageNotPinnedException
-		if(bufDescTable[frameNo].pinCnt == 0)
-			throw PageNotPinnedException(file->filename(), pageNo, frameNo);
-		
-		//else, decrement pin count
-		--bufDescTable[frameNo].pinCnt;
-		
-		//if page is dirty, mark as dirty
-		if(dirty)
-			bufDescTable[frameNo].dirty = true;
-	}
-
-	//returns after catching our HashNotFoundException
-	catch(HashNotFoundException& e){
+	//Check if our file and pageNo is in the buffer pool, and if not, return
+	if(!hashTable->tryLookup(file, pageNo, frameNo))
 		return;
+
+	//If pincount is set to 0, throw PageNotPinnedException
+	if(bufDescTable[frameNo].pinCnt == 0)
+		throw PageNotPinnedException(file->filename(), pageNo, frameNo);
+	
+	//if page is dirty, mark as dirty. This must happen before the pin is dropped,
+	//so that an evicting thread which sees the page unpinned also sees it dirty.
+	if(dirty && !bufDescTable[frameNo].dirty.exchange(true))
+		numDirty++;
+
+	//else, decrement pin count
+	if(--bufDescTable[frameNo].pinCnt == 0)
+		numUnpinned++;
+}
+
+/**
+ * Unpins the page held by a frame. The caller's pin keeps the page in the frame
+ * against evictors, but disposePage() drops it and frees the frame, which may
+ * hold another page by now. So the frame's generation is checked to be the one
+ * seen when the page was pinned, under the frame latch, which disposePage()
+ * holds while it clears the frame; if it is not, the pin is already gone.
+ *
+ * @param frame  	Frame the page was pinned in.
+ * @param generation	Generation of the frame when the page was pinned.
+ * @param dirty		True if the page needs to be marked dirty.
+ * @throws  PageNotPinnedException Thrown If the page is not pinned.
+ */
+void BufMgr::unPinFrame(const FrameId frame, const std::uint64_t generation, const bool dirty)
+{
+	BufDesc& desc = bufDescTable[frame];
+	std::lock_guard<std::mutex> frameLatch(desc.latch);
+	if(desc.generation != generation)
+		return;
+
+	//mark dirty before the pin is dropped, as unPinPage() does
+	if(dirty && !desc.dirty.exchange(true))
+		numDirty++;
+
+	const int pins = desc.pinCnt--;
+	if(pins <= 0){
+		desc.pinCnt++;
+		throw PageNotPinnedException(desc.file->filename(), desc.pageNo, frame);
 	}
+	if(pins == 1)
+		numUnpinned++;
 }
 
 /**
@@ -239,26 +1186,80 @@ void BufMgr::unPinPage(File* file, const PageId pageNo, const bool dirty)
  * @param page  	Reference to page pointer. The newly allocated in-memory Page object is returned via this reference.
  */
 void BufMgr::allocPage(File* file, PageId &pageNo, Page*& page) 
+{
+	page = bufDescTable[pinNewPage(file, pageNo, NULL)].page;
+}
+
+/**
+ * Allocates a new page in the file and pins it in a frame, taken from the ring
+ * of an access strategy when one is given.
+ *
+ * @param file   	File object
+ * @param PageNo  	Page number. The number assigned to the page in the file is returned via this reference.
+ * @param strategy	Access strategy of the bulk operation, or NULL.
+ * @return Frame holding the page.
+ */
+FrameId BufMgr::pinNewPage(File* file, PageId &pageNo, BufferAccessStrategy* strategy) 
 {
 	//obtain a buffer pool frame by calling allocBuff
 	FrameId fId;
-	allocBuf(fId);
+	if(strategy == NULL || !takeRingFrame(*strategy, fId))
+		allocBuf(fId);
 	
 	//allocate an empty page in the specified file
-	Page p = file->allocatePage();
-	pageNo = p.page_number();
+	try{
+		file->allocatePage(*bufDescTable[fId].page);
+	}
+	catch(...){
+		releaseBuf(fId);
+		throw;
+	}
+	pageNo = bufDescTable[fId].page->page_number();
+	bufStats.accesses++;
+	bufStats.diskreads++;
 	
-	//Insert entry into hashtable, and invoke Set(), and sets pointer to 
-	//the buffer frame via the page parameter  
+	//Insert entry into hashtable, and invoke Set()
+	std::lock_guard<std::mutex> guard(hashTable->partitionLatch(file, pageNo));
 	hashTable->insert(file, pageNo, fId);
 	bufDescTable[fId].Set(file, pageNo);
-	bufPool[fId] = p;
-	page = &(bufPool[fId]);
-	return;
+	policy->recordLoad(fId, PageKey{file, pageNo});
+	if(strategy != NULL){
+		const BufferAccessStrategy::Slot slot = {fId, PageKey{file, pageNo}};
+		strategy->ring[strategy->current] = slot;
+		bufDescTable[fId].refbit = false;
+	}
+	return fId;
 }
 
 /**
-* Writes out all dirty pages of the file to disk.
+ * Allocates a new page through an access strategy.
+ *
+ * @param file   	File object
+ * @param PageNo  	Page number. The number assigned to the page in the file is returned via this reference.
+ * @param page  	Reference to page pointer. The newly allocated in-memory Page object is returned via this reference.
+ * @param strategy	Access strategy of the bulk operation, or NULL.
+ */
+void BufMgr::allocPage(File* file, PageId &pageNo, Page*& page, BufferAccessStrategy* strategy) 
+{
+	page = bufDescTable[pinNewPage(file, pageNo, strategy)].page;
+}
+
+/**
+ * Allocates a new page and returns a handle that unpins it.
+ *
+ * @param file   	File object
+ * @param PageNo  	Page number. The number assigned to the page in the file is returned via this reference.
+ * @param strategy	Access strategy of the bulk operation, or NULL.
+ * @return Handle holding the pin on the page.
+ */
+PageHandle BufMgr::allocPage(File* file, PageId &pageNo, BufferAccessStrategy* strategy) 
+{
+	const FrameId frame = pinNewPage(file, pageNo, strategy);
+	return PageHandle(this, frame, bufDescTable[frame].generation, bufDescTable[frame].page);
+}
+
+/**
+* Writes out all dirty pages of the file to disk and syncs the file.
 * All the frames assigned to the file need to be unpinned from buffer pool before this function can be successfully called,
 * otherwise error returned.
 *
@@ -268,32 +1269,69 @@ void BufMgr::allocPage(File* file, PageId &pageNo, Page*& page)
 */
 void BufMgr::flushFile(const File* file) 
 {
+	// no page of the file may be read ahead behind our back
+	cancelReadAhead(file);
+
+	// with an I/O engine, the dirty unpinned pages go out together first
+	if(ioEngine != NULL){
+		const std::uint32_t batch = ioBatch();
+		std::vector<FrameId> frames;
+		std::vector<std::unique_lock<std::mutex> > latches;
+		for(FrameId i = 0; i < numBufs; ++i){
+			std::unique_lock<std::mutex> latch;
+			if(claimFrame(i, latch, file)){
+				frames.push_back(i);
+				latches.push_back(std::move(latch));
+			}
+			if(!frames.empty() && (frames.size() == batch || i + 1 == numBufs)){
+				// pages that fail are dirty again, and the loop below reports the error
+				writeFrames(frames.data(), frames.size(), false);
+				frames.clear();
+				latches.clear();
+			}
+		}
+	}
+
 	for(FrameId i = 0; i < numBufs; ++i){
-		if(bufDescTable[i].file == file){
+		// the frame may be refilled concurrently, so its file is only looked at under its latch
+		BufDesc& desc = bufDescTable[i];
+		std::lock_guard<std::mutex> frameLatch(desc.latch);
+		if(desc.file == file){
 			try{
 				// Write dirty page and check page is valid or not
-				if(bufDescTable[i].dirty){
-					bufDescTable[i].file->writePage(bufPool[i]); // If page is invalid, it will throw InvalidPageException
-					bufDescTable[i].dirty = false;
+				if(desc.dirty){
+					desc.file->writePage(*desc.page); // If page is invalid, it will throw InvalidPageException
+					if(desc.dirty.exchange(false))
+						numDirty--;
+					bufStats.diskwrites++;
 				}
 
 				// If file is still pinned, throw exception
-				if(bufDescTable[i].pinCnt){
-					throw PagePinnedException(file->filename(), bufDescTable[i].pageNo, i);
+				if(desc.pinCnt){
+					throw PagePinnedException(file->filename(), desc.pageNo, i);
 				}
 
 				// remove hash table entry
-				hashTable->remove(file, bufDescTable[i].pageNo);
+				{
+					std::lock_guard<std::mutex> partitionLatch(hashTable->partitionLatch(file, desc.pageNo));
+					hashTable->remove(file, desc.pageNo);
+				}
 
-				// Clear() the bufDescTable[i]
-				bufDescTable[i].Clear();
+				// Clear() the bufDescTable[i] and make the frame available
+				policy->recordRemove(i);
+				if(desc.prefetched)
+					bufStats.prefetchWasted++;
+				desc.Clear();
+				addFreeFrame(i);
 			}
 			//catch invalid page exception, to throw a BadBufferException  
 			catch(const InvalidPageException& e){
-				throw BadBufferException(bufDescTable[i].frameNo, bufDescTable[i].dirty, bufDescTable[i].valid, bufDescTable[i].refbit);
+				throw BadBufferException(desc.frameNo, desc.dirty, desc.valid, desc.refbit);
 			}
 		}
 	}
+
+	file->sync();
 }
 /**
 * Delete page from file and also from buffer pool if present.
@@ -305,28 +1343,92 @@ void BufMgr::flushFile(const File* file)
 void BufMgr::disposePage(File* file, const PageId PageNo)
 {
 	// Note: This function does not check whether the pinCnt is already 0!
+
+	// the page must not be read ahead again while it is deleted
+	cancelReadAhead(file);
 	
-	// Find if the page exists in buffer
+	// Find if the page exists in buffer. If lookup fails, we can move on disposing page on disk.
 	FrameId fId;
-	try{
-		hashTable->lookup(file, PageNo, fId);
-		// Continue means lookup succeeded. Otherwise HashNotFoundException is thrown and execution flow goes to catch(){}.
-		
-		// Remove entries in bufDescTable, hashTable
-		bufDescTable[fId].Clear();
-		hashTable->remove(file, PageNo);
+	bool found;
+	{
+		std::lock_guard<std::mutex> partitionLatch(hashTable->partitionLatch(file, PageNo));
+		found = hashTable->tryLookup(file, PageNo, fId);
+	}
+
+	if(found){
+		// Take the frame latch first, as allocBuf() does, and check the frame still holds the page
+		std::lock_guard<std::mutex> frameLatch(bufDescTable[fId].latch);
+		std::lock_guard<std::mutex> partitionLatch(hashTable->partitionLatch(file, PageNo));
+		FrameId current;
+		if(hashTable->tryLookup(file, PageNo, current) && current == fId){
+			// Remove entries in bufDescTable, hashTable
+			hashTable->remove(file, PageNo);
+			policy->recordRemove(fId);
+			if(bufDescTable[fId].dirty.exchange(false))
+				numDirty--;
+			if(bufDescTable[fId].prefetched)
+				bufStats.prefetchWasted++;
+			if(bufDescTable[fId].Clear())
+				numUnpinned++;
+			addFreeFrame(fId);
+		}
 
 		// We left bufPool[i] data in place, which may be a security issue.
 		// Now we can dispose page on disk.
 	}
-	catch(const HashNotFoundException& e){
-		// Lookup failed. We can move on disposing page on disk.
-	}
 
 	// Dispose page on disk
 	file->deletePage(PageNo);
 }
 
+/**
+ * Starts the I/O engine. The background threads are restarted around it, so
+ * that they pick it up.
+ *
+ * @param config Kind and queue depth of the engine.
+ */
+void BufMgr::startAsyncIo(const IoEngineConfig& config)
+{
+	if(ioEngine != NULL){
+		return;
+	}
+	const bool writing = writer.joinable();
+	const bool readingAhead = readAheadThread.joinable();
+	stopReadAhead();
+	stopBackgroundWriter();
+
+	ioConfig = config;
+	ioEngine = IoEngine::create(config);
+
+	if(writing)
+		startBackgroundWriter(writerConfig);
+	if(readingAhead)
+		startReadAhead(readAheadConfig);
+}
+
+/**
+ * Stops the I/O engine, if running. The background threads are restarted
+ * around it, so that they no longer use it.
+ */
+void BufMgr::stopAsyncIo()
+{
+	if(ioEngine == NULL){
+		return;
+	}
+	const bool writing = writer.joinable();
+	const bool readingAhead = readAheadThread.joinable();
+	stopReadAhead();
+	stopBackgroundWriter();
+
+	delete ioEngine;
+	ioEngine = NULL;
+
+	if(writing)
+		startBackgroundWriter(writerConfig);
+	if(readingAhead)
+		startReadAhead(readAheadConfig);
+}
+
 /**
 * Print member variable values. 
 */
@@ -13,14 +13,30 @@
  * the buffer pool including frame allocation and deallocation to pages in the file".
  * This is the header file (declaration). The implementation is in `buffer.cpp`.
  * 
- * Controls which pages are memory resident, using the clock algorithm as
- * a buffer replacement policy.
+ * Controls which pages are memory resident. The buffer replacement policy is
+ * pluggable (see replacement/replacement_policy.h) and defaults to the clock
+ * algorithm.
+ *
+ * BufMgr may be shared by several threads. Frames are tracked by atomic pin
+ * counts and reference bits, the page table is latched per partition, and
+ * each frame has a latch that serializes changes of the page it holds.
  * 			
  */
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
 #include "file.h"
+#include "io_engine.h"
 #include "bufHashTbl.h"
+#include "page_handle.h"
+#include "replacement/replacement_policy.h"
 
 namespace badgerdb {
 
@@ -52,15 +68,26 @@ class BufDesc {
 	 */
   FrameId	frameNo;
 
+	/**
+   * Page held by the frame: its own page in the buffer pool, or for a page of a mapped file
+   * the page itself in the file's mapping, which is not copied
+	 */
+  Page* page;
+
+	/**
+   * The frame's own page in the buffer pool
+	 */
+  Page* poolPage;
+
 	/**
    * Number of times this page has been pinned
 	 */
-  int pinCnt;
+  std::atomic<int> pinCnt;
 
 	/**
    * True if page is dirty;  false otherwise
 	 */
-  bool dirty;
+  std::atomic<bool> dirty;
 
 	/**
    * True if page is valid
@@ -68,21 +95,46 @@ class BufDesc {
   bool valid;
 
 	/**
-   * Has this buffer frame been reference recently
+   * Has this buffer frame been referenced since its page was loaded. Kept for
+   * diagnostics; the replacement policy keeps its own recency information.
+	 */
+  std::atomic<bool> refbit;
+
+	/**
+   * True if the page was read ahead and has not been requested since
+	 */
+  std::atomic<bool> prefetched;
+
+	/**
+   * Serializes changes of the page assigned to this frame (file, pageNo, valid).
+   * Held by the thread evicting or flushing the frame, never while waiting on a
+   * partition latch of the hash table held by someone else in reverse order.
+	 */
+  std::mutex latch;
+
+	/**
+   * Bumped whenever the frame is given a page or cleared, so that a pin taken
+   * on an earlier page of the frame can be told apart (see PageHandle)
 	 */
-  bool refbit;
+  std::atomic<std::uint64_t> generation;
 
 	/**
    * Initialize buffer frame for a new user
+   *
+   * @return  True if the frame was pinned before
 	 */
-  void Clear()
+  bool Clear()
 	{
-    pinCnt = 0;
 		file = NULL;
 		pageNo = Page::INVALID_NUMBER;
+		page = poolPage;
     dirty = false;
     refbit = false;
+    prefetched = false;
 		valid = false;
+    generation++;
+    // dropped last: an unpinned frame may be claimed by another thread at once
+    return pinCnt.exchange(0) != 0;
   };
 
 	/**
@@ -100,6 +152,20 @@ class BufDesc {
     dirty = false;
     valid = true;
     refbit = true;
+    prefetched = false;
+    generation++;
+  }
+
+	/**
+	 * Pin the page held by this frame once more. The caller must hold the partition latch
+	 * of the page, so that the frame cannot be evicted concurrently.
+	 *
+	 * @return  True if the frame was unpinned before
+	 */
+  bool Pin()
+	{
+    refbit = true;
+    return pinCnt++ == 0;
   }
 
   void Print()
@@ -115,13 +181,15 @@ class BufDesc {
 		std::cout << "valid:" << valid << " ";
 		std::cout << "pinCnt:" << pinCnt << " ";
 		std::cout << "dirty:" << dirty << " ";
-		std::cout << "refbit:" << refbit << "\n";
+		std::cout << "refbit:" << refbit << " ";
+		std::cout << "prefetched:" << prefetched << "\n";
   }
 
 	/**
    * Constructor of BufDesc class 
 	 */
   BufDesc()
+		: page(NULL), poolPage(NULL), generation(0)
 	{
   	Clear();
   }
@@ -129,53 +197,219 @@ class BufDesc {
 
 
 /**
-* @brief Class to maintain statistics of buffer usage 
+* @brief Class to maintain statistics of buffer usage. Counters are updated concurrently by all
+* threads using the buffer manager.
 */
 struct BufStats
 {
 	/**
    * Total number of accesses to buffer pool
 	 */
-  int accesses;
+  std::atomic<int> accesses;
 
 	/**
    * Number of pages read from disk (including allocs)
 	 */
-  int diskreads;
+  std::atomic<int> diskreads;
 
 	/**
    * Number of pages written back to disk
 	 */
-  int diskwrites;
+  std::atomic<int> diskwrites;
+
+	/**
+   * Number of readPage() calls that found the page in the buffer pool
+	 */
+  std::atomic<int> hits;
+
+	/**
+   * Number of the diskwrites done by the background writer
+	 */
+  std::atomic<int> bgwrites;
+
+	/**
+   * Number of pages read ahead (also counted in diskreads)
+	 */
+  std::atomic<int> prefetches;
+
+	/**
+   * Number of readPage() calls served by a page that was read ahead
+	 */
+  std::atomic<int> prefetchHits;
+
+	/**
+   * Number of pages read ahead that left the buffer pool without being requested
+	 */
+  std::atomic<int> prefetchWasted;
+
+	/**
+   * Name of the replacement policy the counters were collected with. Not reset by clear().
+	 */
+  const char* policy;
 
 	/**
    * Clear all values 
 	 */
   void clear()
   {
-		accesses = diskreads = diskwrites = 0;
+		accesses = diskreads = diskwrites = hits = bgwrites = 0;
+		prefetches = prefetchHits = prefetchWasted = 0;
+  }
+
+	/**
+   * Fraction of accesses that were served from the buffer pool
+	 */
+  double hitRatio() const
+  {
+		return accesses ? (double) hits / accesses : 0.0;
   }
       
 	/**
    * Constructor of BufStats class 
 	 */
   BufStats()
+		: policy("")
   {
 		clear();
   }
 };
 
 
+/**
+* @brief Settings of the background writer, which cleans dirty unpinned frames ahead of
+* the replacement policy so that misses rarely have to write a victim back themselves.
+*/
+struct BgWriterConfig
+{
+	/**
+   * Fraction of the frames that may stay dirty. The writer sleeps while there are fewer.
+	 */
+  double dirtyRatio;
+
+	/**
+   * Most pages written in one round
+	 */
+  std::uint32_t pagesPerRound;
+
+	/**
+   * Milliseconds between rounds. With pagesPerRound this bounds the write rate.
+	 */
+  std::uint32_t delayMs;
+
+	/**
+   * Constructor of BgWriterConfig class, with defaults of at most 500 pages per second
+	 */
+  BgWriterConfig()
+		: dirtyRatio(0.1), pagesPerRound(100), delayMs(200)
+  {
+  }
+};
+
+
+/**
+* @brief Settings of sequential read-ahead. Once a file is read page after page, the buffer
+* manager reads a window of the following pages in the background, into unpinned frames.
+* The window doubles each time the reader catches up with it and halves when read-ahead
+* pages are evicted unused.
+*/
+struct ReadAheadConfig
+{
+	/**
+   * Number of pages read ahead when a sequential run is detected
+	 */
+  std::uint32_t minWindow;
+
+	/**
+   * Largest number of pages read ahead of the reader
+	 */
+  std::uint32_t maxWindow;
+
+	/**
+   * Constructor of ReadAheadConfig class
+	 */
+  ReadAheadConfig()
+		: minWindow(4), maxWindow(64)
+  {
+  }
+};
+
+
+/**
+* @brief Access strategy of one bulk operation, such as a large scan or a bulk load: a small
+* ring of frames that the operation recycles for its own misses, so that it evicts its own
+* pages instead of the working set of everybody else.
+*
+* Pass it to the readPage() and allocPage() overloads for the whole operation. A ring frame
+* is only reused if it still holds the page the operation put there, is unpinned and was not
+* referenced by anybody since; otherwise a frame is taken the usual way and joins the ring.
+* The ring is capped at an eighth of the buffer pool. A strategy is used by one thread at a
+* time and belongs to one buffer manager.
+*/
+class BufferAccessStrategy
+{
+	friend class BufMgr;
+
+ public:
+	/**
+   * Ring size for large sequential reads
+	 */
+  static const std::uint32_t BULK_READ_RING = 32;
+
+	/**
+   * Ring size for bulk loads. Larger, so that a dirty frame is rarely reused before the
+   * background writer had a chance to clean it.
+	 */
+  static const std::uint32_t BULK_WRITE_RING = 256;
+
+	/**
+   * Constructor of BufferAccessStrategy class
+   *
+   * @param ringSize  	Number of frames the operation may recycle
+	 */
+  explicit BufferAccessStrategy(std::uint32_t ringSize = BULK_READ_RING)
+		: ringSize(ringSize), current(0)
+  {
+  }
+
+ private:
+	/**
+   * A ring frame and the page the operation loaded into it
+	 */
+  struct Slot
+  {
+    FrameId frame;
+    PageKey page;
+  };
+
+	/**
+   * Requested number of frames
+	 */
+  std::uint32_t ringSize;
+
+	/**
+   * Frames of the ring, filled up to the ring size as the operation misses
+	 */
+  std::vector<Slot> ring;
+
+	/**
+   * Slot used for the latest miss
+	 */
+  std::uint32_t current;
+};
+
+
 /**
 * @brief The central class which manages the buffer pool including frame allocation and deallocation to pages in the file 
 */
 class BufMgr 
 {
+	friend class PageHandle;
+
  private:
 	/**
-   * Current position of clockhand in our buffer pool
+   * Decides which page to evict when no frame is free. Owned by the buffer manager.
 	 */
-  FrameId clockHand;
+  ReplacementPolicy* policy;
 
 	/**
    * Number of frames in the buffer pool
@@ -198,28 +432,371 @@ class BufMgr
   BufStats bufStats;
 
 	/**
-   * Advance clock to next frame in the buffer pool
+   * Number of frames whose pin count is zero, valid or not. Lets allocBuf() tell that every
+   * frame is pinned without looking at them.
+	 */
+  std::atomic<int> numUnpinned;
+
+	/**
+   * Invalid frames that can be handed out without running the clock: every frame at
+   * startup, and frames emptied by disposePage(), flushFile() or releaseBuf(). An entry may
+   * be stale if the replacement policy has handed the frame out since; takeFreeFrame() skips those.
+	 */
+  std::vector<FrameId> freeFrames;
+
+	/**
+   * Guards freeFrames
+	 */
+  std::mutex freeLatch;
+
+	/**
+   * Number of dirty frames
+	 */
+  std::atomic<int> numDirty;
+
+	/**
+   * Background writer thread, if started
+	 */
+  std::thread writer;
+
+	/**
+   * Settings of the background writer
+	 */
+  BgWriterConfig writerConfig;
+
+	/**
+   * Next frame the background writer looks at. Only used by the writer thread.
+	 */
+  FrameId writerHand;
+
+	/**
+   * Tells the background writer to exit
+	 */
+  bool writerStop;
+
+	/**
+   * Guards writerStop and is waited on by the background writer between rounds
+	 */
+  std::mutex writerLatch;
+
+	/**
+   * Wakes the background writer early, to stop it or because a miss had to write a victim
+	 */
+  std::condition_variable writerWake;
+
+	/**
+   * Sequential access detection of one file
+	 */
+  struct ReadAheadState
+  {
+		/**
+     * Page expected next if the file is read sequentially
+		 */
+    PageId next;
+
+		/**
+     * First page not read ahead yet
+		 */
+    PageId aheadEnd;
+
+		/**
+     * Number of consecutive pages read so far
+		 */
+    std::uint32_t run;
+
+		/**
+     * Current read-ahead window, in pages
+		 */
+    std::uint32_t window;
+  };
+
+	/**
+   * A run of pages to read ahead
+	 */
+  struct ReadAheadRequest
+  {
+    File* file;
+    PageId first;
+    PageId count;
+  };
+
+	/**
+   * Read-ahead thread, if started
+	 */
+  std::thread readAheadThread;
+
+	/**
+   * Settings of read-ahead
 	 */
-  void advanceClock();
+  ReadAheadConfig readAheadConfig;
 
 	/**
-	 * Allocate a free frame.  
+   * Access pattern of every file read since read-ahead was started
+	 */
+  std::map<const File*, ReadAheadState> readAheadStates;
+
+	/**
+   * Runs waiting to be read ahead
+	 */
+  std::deque<ReadAheadRequest> readAheadQueue;
+
+	/**
+   * File the read-ahead thread is reading from, or NULL
+	 */
+  const File* readAheadBusy;
+
+	/**
+   * Tells the read-ahead thread to exit
+	 */
+  bool readAheadStop;
+
+	/**
+   * Whether readPage() feeds sequential detection. Read without readAheadLatch.
+	 */
+  std::atomic<bool> readAheadOn;
+
+	/**
+   * Guards the read-ahead state, queue and flags above
+	 */
+  std::mutex readAheadLatch;
+
+	/**
+   * Wakes the read-ahead thread when a run is queued or it should stop
+	 */
+  std::condition_variable readAheadWake;
+
+	/**
+   * Signalled by the read-ahead thread when it finishes a run
+	 */
+  std::condition_variable readAheadIdle;
+
+	/**
+   * Engine keeping reads and writes of the buffer manager in flight together, if started
+	 */
+  IoEngine* ioEngine;
+
+	/**
+   * Settings of the I/O engine
+	 */
+  IoEngineConfig ioConfig;
+
+	/**
+	 * Try to evict the page held by a victim frame chosen by the replacement policy, writing
+	 * it back first if it is dirty. On success the frame is invalid and pinned once.
+	 *
+	 * @param frame   	Frame to evict
+	 * @param expected	If given, evict only if the frame still holds this page and the page was
+	 * 								not referenced since it was loaded
+	 * @return  				False if the frame was pinned or dirtied meanwhile, and keeps its page
+	 */
+  bool evictFrame(const FrameId frame, const PageKey* expected = NULL);
+
+	/**
+	 * Take the latch of a frame holding a dirty, unpinned page and mark the page clean, so that
+	 * the caller can write it back with writeFrames() while keeping it in the pool.
+	 *
+	 * @param frame   	Frame to clean
+	 * @param latch   	Set to hold the frame latch on success
+	 * @param file   		If not NULL, the file the page must belong to
+	 * @return  				False if the frame is latched, pinned, clean or holds a page of another file
+	 */
+  bool claimFrame(const FrameId frame, std::unique_lock<std::mutex>& latch, const File* file = NULL);
+
+	/**
+	 * Write back the pages of frames claimed with claimFrame(), all at once through the I/O
+	 * engine if there is one. Pages that fail to be written are marked dirty again.
+	 *
+	 * @param frames   	Frames to write
+	 * @param count   	Number of frames
+	 * @param background	True if the background writer writes them
+	 * @return  				Number of pages written
+	 */
+  std::uint32_t writeFrames(const FrameId* frames, const std::uint32_t count, const bool background);
+
+	/**
+	 * Number of writes or reads the buffer manager hands to the I/O engine at once: its queue
+	 * depth, or 1 without an engine.
+	 */
+  std::uint32_t ioBatch() const;
+
+	/**
+	 * Body of the background writer thread. Each round sweeps the frames until the number of
+	 * dirty frames is down to the target or pagesPerRound pages were written, then sleeps.
+	 */
+  void runWriter();
+
+	/**
+	 * Feed a demand read of a page to sequential detection, and queue the next run of pages to
+	 * read ahead if the reader is getting close to the end of the current one.
+	 *
+	 * @param file   	File object
+	 * @param pageNo  Page number that was requested
+	 */
+  void noteAccess(File* file, const PageId pageNo);
+
+	/**
+	 * Shrink the read-ahead window of a file after one of its read-ahead pages was evicted unused.
+	 *
+	 * @param file   	File of the evicted page
+	 */
+  void noteWasted(const File* file);
+
+	/**
+	 * Drop queued read-ahead of a file and its access history, and wait until the read-ahead
+	 * thread is not reading from it.
+	 *
+	 * @param file   	File object
+	 */
+  void cancelReadAhead(const File* file);
+
+	/**
+	 * Read a run of pages and put those not in the buffer pool yet into unpinned frames: with
+	 * one read, or straight into frames through the I/O engine if there is one. Stops quietly
+	 * when the pool has no frame to spare.
+	 *
+	 * @param request  	Run of pages to read
+	 */
+  void prefetch(const ReadAheadRequest& request);
+
+	/**
+	 * Put a page read ahead into a frame obtained from allocBuf(), leaving it unpinned, or
+	 * release the frame if the page is in the buffer pool already.
+	 *
+	 * @param file   	File object
+	 * @param pageNo  Page number of the page read into the frame
+	 * @param frame   	Frame holding the page
+	 */
+  void installPrefetched(File* file, const PageId pageNo, const FrameId frame);
+
+	/**
+	 * Body of the read-ahead thread, serving queued runs in order.
+	 */
+  void runReadAhead();
+
+	/**
+	 * Allocate a free frame. The frame is returned invalid, absent from the hash table and
+	 * pinned once, so that no other thread can allocate it until the caller either calls
+	 * Set() on it or releases it with releaseBuf().
 	 *
 	 * @param frame   	Frame reference, frame ID of allocated frame returned via this variable
 	 * @throws BufferExceededException If no such buffer is found which can be allocated
 	 */
   void allocBuf(FrameId & frame);
 
+	/**
+	 * Move a strategy to its next ring slot and try to reuse the frame there. The frame is
+	 * returned as allocBuf() returns frames. The caller records the page it loads with
+	 * BufferAccessStrategy::ring[current].
+	 *
+	 * @param strategy	Access strategy of the operation
+	 * @param frame   	Frame reference, frame ID of the reused frame returned via this variable
+	 * @return  				False if the ring is still growing or its frame cannot be reused
+	 */
+  bool takeRingFrame(BufferAccessStrategy& strategy, FrameId & frame);
+
+	/**
+	 * Pin the given page, reading it into a frame on a miss; the body of the readPage() overloads.
+	 *
+	 * @param file   	File object
+	 * @param PageNo  Page number in the file to be read
+	 * @param strategy	Access strategy of the bulk operation, or NULL for the default
+	 * @return  				Frame holding the page
+	 */
+  FrameId pinPage(File* file, const PageId PageNo, BufferAccessStrategy* strategy);
+
+	/**
+	 * Pin the given page if it is in the buffer pool, counting the hit.
+	 *
+	 * @param file   	File object
+	 * @param PageNo  Page number in the file
+	 * @param frame   	Frame reference, frame ID of the frame holding the page returned via this variable
+	 * @return  				False on a miss
+	 */
+  bool pinBuffered(File* file, const PageId PageNo, FrameId & frame);
+
+	/**
+	 * Enter a page just read into a frame obtained from allocBuf() into the buffer pool, pinned.
+	 * If another thread loaded the page meanwhile, the frame is released and the page is pinned
+	 * in the other frame.
+	 *
+	 * @param file   	File object
+	 * @param PageNo  Page number of the page read into the frame
+	 * @param frame   	Frame holding the page
+	 * @param strategy	Access strategy the frame was taken for, or NULL
+	 * @return  				Frame holding the page
+	 */
+  FrameId installPage(File* file, const PageId PageNo, const FrameId frame, BufferAccessStrategy* strategy);
+
+	/**
+	 * Read a page into a frame obtained from allocBuf(). A page of a mapped file is not read but
+	 * pointed to in the file's mapping.
+	 *
+	 * @param file   	File object
+	 * @param PageNo  Page number in the file
+	 * @param frame   	Frame to load the page into
+	 * @throws InvalidPageException If the page does not exist in the file
+	 */
+  void loadFrame(File* file, const PageId PageNo, const FrameId frame);
+
+	/**
+	 * Allocate a new page in the file and pin it in a frame; the body of the allocPage() overloads.
+	 *
+	 * @param file   	File object
+	 * @param PageNo  Page number. The number assigned to the page in the file is returned via this reference.
+	 * @param strategy	Access strategy of the bulk operation, or NULL for the default
+	 * @return  				Frame holding the page
+	 */
+  FrameId pinNewPage(File* file, PageId &PageNo, BufferAccessStrategy* strategy);
+
+	/**
+	 * Unpin the page held by a frame the caller has pinned, unless the page has been disposed
+	 * of since and the frame may hold another page. Used by PageHandle.
+	 *
+	 * @param frame   	Frame the page was pinned in
+	 * @param generation	Generation of the frame when the page was pinned
+	 * @param dirty			True if the page needs to be marked dirty
+   * @throws  PageNotPinnedException If the page is not pinned
+	 */
+  void unPinFrame(const FrameId frame, const std::uint64_t generation, const bool dirty);
+
+	/**
+	 * Give back a frame obtained from allocBuf() that was not assigned to a page.
+	 *
+	 * @param frame   	Frame to release
+	 */
+  void releaseBuf(const FrameId frame);
+
+	/**
+	 * Pop an invalid frame from the free list and pin it, as allocBuf() returns frames.
+	 *
+	 * @param frame   	Frame reference, frame ID of the frame returned via this variable
+	 * @return  				False if the free list held no usable frame
+	 */
+  bool takeFreeFrame(FrameId & frame);
+
+	/**
+	 * Put an invalid frame on the free list.
+	 *
+	 * @param frame   	Frame that was just cleared
+	 */
+  void addFreeFrame(const FrameId frame);
+
  public:
 	/**
-   * Actual buffer pool from which frames are allocated
+   * Actual buffer pool from which frames are allocated. One arena of numBufs pages, aligned
+   * to Page::ALIGNMENT; frame i is bufPool[i], unless it holds a page of a mapped file, which
+   * is handed out in place instead.
 	 */
   Page* bufPool;
 
 	/**
    * Constructor of BufMgr class
+   *
+   * @param bufs    	Number of frames in the buffer pool
+   * @param policy  	Replacement policy, owned by the buffer manager from now on. NULL selects
+   * 								the clock algorithm.
 	 */
-  BufMgr(std::uint32_t bufs);
+  BufMgr(std::uint32_t bufs, ReplacementPolicy* policy = NULL);
 	
 	/**
    * Destructor of BufMgr class
@@ -230,6 +807,9 @@ class BufMgr
 	 * Reads the given page from the file into a frame and returns the pointer to page.
 	 * If the requested page is already present in the buffer pool pointer to that frame is returned
 	 * otherwise a new frame is allocated from the buffer pool for reading the page.
+	 * A page of a file opened with FileIoConfig::MAPPED is not copied into the frame, unless the
+	 * file is compressed or keeps checksums; page points into the file's mapping, so changes to
+	 * it reach the file before it is written back.
 	 *
 	 * @param file   	File object
 	 * @param PageNo  Page number in the file to be read
@@ -237,6 +817,42 @@ class BufMgr
 	 */
   void readPage(File* file, const PageId PageNo, Page*& page);
 
+	/**
+	 * Reads the given page like readPage() above, but on a miss recycles a frame of the given
+	 * access strategy's ring instead of evicting a page chosen by the replacement policy.
+	 *
+	 * @param file   	File object
+	 * @param PageNo  Page number in the file to be read
+	 * @param page  	Reference to page pointer. Used to fetch the Page object in which requested page from file is read in.
+	 * @param strategy	Access strategy of the bulk operation, or NULL for the default
+	 */
+  void readPage(File* file, const PageId PageNo, Page*& page, BufferAccessStrategy* strategy);
+
+	/**
+	 * Reads the given page like readPage() above and returns a handle that unpins it when
+	 * destroyed. Unpinning through the handle needs no hash table lookup.
+	 *
+	 * @param file   	File object
+	 * @param PageNo  Page number in the file to be read
+	 * @param strategy	Access strategy of the bulk operation, or NULL for the default
+	 * @return  				Handle holding the pin on the page
+	 */
+  PageHandle readPage(File* file, const PageId PageNo, BufferAccessStrategy* strategy = NULL);
+
+	/**
+	 * Reads and pins several pages of a file. The misses are read all at once through the I/O
+	 * engine if there is one, and one after the other otherwise. A page asked for twice is
+	 * pinned twice. If any page cannot be read, none is left pinned.
+	 *
+	 * @param file   	File object
+	 * @param pageNos Page numbers in the file to be read
+	 * @param count   Number of pages
+	 * @param pages  	Array of count page pointers, set to the Page objects the pages were read into
+	 * @throws InvalidPageException If a page does not exist in the file
+	 * @throws BufferExceededException If the buffer pool has too few unpinned frames for the pages
+	 */
+  void readPages(File* file, const PageId* pageNos, const std::uint32_t count, Page** pages);
+
 	/**
 	 * Unpin a page from memory since it is no longer required for it to remain in memory.
 	 *
@@ -258,9 +874,31 @@ class BufMgr
   void allocPage(File* file, PageId &PageNo, Page*& page); 
 
 	/**
-	 * Writes out all dirty pages of the file to disk.
+	 * Allocates a new page like allocPage() above, but takes its frame from the given access
+	 * strategy's ring when it can.
+	 *
+	 * @param file   	File object
+	 * @param PageNo  Page number. The number assigned to the page in the file is returned via this reference.
+	 * @param page  	Reference to page pointer. The newly allocated in-memory Page object is returned via this reference.
+	 * @param strategy	Access strategy of the bulk operation, or NULL for the default
+	 */
+  void allocPage(File* file, PageId &PageNo, Page*& page, BufferAccessStrategy* strategy);
+
+	/**
+	 * Allocates a new page like allocPage() above and returns a handle that unpins it when
+	 * destroyed. Call PageHandle::markDirty() once the page is filled in.
+	 *
+	 * @param file   	File object
+	 * @param PageNo  Page number. The number assigned to the page in the file is returned via this reference.
+	 * @param strategy	Access strategy of the bulk operation, or NULL for the default
+	 * @return  				Handle holding the pin on the page
+	 */
+  PageHandle allocPage(File* file, PageId &PageNo, BufferAccessStrategy* strategy = NULL);
+
+	/**
+	 * Writes out all dirty pages of the file to disk and syncs the file, so that they are durable.
 	 * All the frames assigned to the file need to be unpinned from buffer pool before this function can be successfully called.
-	 * Otherwise Error returned.
+	 * Otherwise Error returned. Other threads must not access the file through the buffer manager while it is flushed.
 	 *
 	 * @param file   	File object
    * @throws  PagePinnedException If any page of the file is pinned in the buffer pool 
@@ -278,6 +916,57 @@ class BufMgr
   void disposePage(File* file, const PageId PageNo);
 
 	/**
+	 * Start the background writer thread. Does nothing if it is running already.
+	 *
+	 * @param config  	Target dirty ratio and write rate of the writer
+	 */
+  void startBackgroundWriter(const BgWriterConfig& config = BgWriterConfig());
+
+	/**
+	 * Stop the background writer thread and wait for it to exit. Does nothing if it is not
+	 * running. Called by the destructor.
+	 */
+  void stopBackgroundWriter();
+
+	/**
+	 * Start detecting sequential reads and reading ahead of them in a background thread. Does
+	 * nothing if read-ahead is running already.
+	 *
+	 * @param config  	Smallest and largest read-ahead window
+	 */
+  void startReadAhead(const ReadAheadConfig& config = ReadAheadConfig());
+
+	/**
+	 * Stop read-ahead and wait for the read-ahead thread to exit. Pages read ahead stay in the
+	 * buffer pool. Does nothing if read-ahead is not running. Called by the destructor.
+	 */
+  void stopReadAhead();
+
+	/**
+	 * Start an I/O engine, through which misses of readPages(), read-ahead, the background
+	 * writer and flushFile() keep many reads and writes in flight at once. Does nothing if an
+	 * engine is running already. Not to be called while other threads use the buffer manager.
+	 *
+	 * @param config  	Kind and queue depth of the engine
+	 */
+  void startAsyncIo(const IoEngineConfig& config = IoEngineConfig());
+
+	/**
+	 * Stop the I/O engine, going back to reading and writing one page at a time. Does nothing
+	 * if no engine is running. Not to be called while other threads use the buffer manager.
+	 * Called by the destructor.
+	 */
+  void stopAsyncIo();
+
+	/**
+	 * Name of the running I/O engine, or NULL if there is none.
+	 */
+  const char* asyncIoEngine() const
+  {
+		return ioEngine != NULL ? ioEngine->name() : NULL;
+  }
+
+	/**
    * Print member variable values. 
 	 */
   void  printSelf();
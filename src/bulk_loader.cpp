@@ -0,0 +1,53 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#include "bulk_loader.h"
+
+#include "exceptions/insufficient_space_exception.h"
+
+namespace badgerdb {
+
+BulkLoader::BulkLoader(BufMgr* buf_mgr, File* file)
+    : buf_mgr_(buf_mgr),
+      file_(file),
+      strategy_(BufferAccessStrategy::BULK_WRITE_RING),
+      num_pages_(0) {
+}
+
+RecordId BulkLoader::insertRecord(const RecordView& record) {
+  RecordId record_id;
+  insertRecords(&record, 1, &record_id);
+  return record_id;
+}
+
+void BulkLoader::insertRecords(const RecordView* records,
+                               const std::size_t num_records,
+                               RecordId* record_ids) {
+  std::size_t inserted = 0;
+  while (inserted < num_records) {
+    if (!page_) {
+      PageId page_number;
+      page_ = buf_mgr_->allocPage(file_, page_number, &strategy_);
+      page_.markDirty();
+      ++num_pages_;
+    }
+    const std::size_t count = page_->insertRecords(
+        records + inserted, num_records - inserted,
+        record_ids == NULL ? NULL : record_ids + inserted);
+    inserted += count;
+    if (count == 0) {
+      if (page_->getFreeSpace() == Page::DATA_SIZE) {
+        throw InsufficientSpaceException(page_->page_number(),
+                                         records[inserted].length(),
+                                         page_->getFreeSpace());
+      }
+      page_.release();
+    }
+  }
+}
+
+}
@@ -0,0 +1,117 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include "buffer.h"
+#include "page_handle.h"
+#include "record_view.h"
+#include "types.h"
+
+namespace badgerdb {
+
+/**
+ * @brief Appends records to a file through the buffer pool, a page at a time.
+ *
+ * Records are packed into newly allocated pages with Page::insertRecords().
+ * Each page stays pinned while it is being filled and is unpinned dirty once
+ * full, so the per-record cost is a copy into the page.  Pages are allocated
+ * through a bulk write access strategy, so a large load recycles a ring of
+ * frames instead of flushing the rest of the buffer pool.
+ *
+ * The loader only appends: it never puts records on pages that existed before
+ * it was created.  Call finish(), or destroy the loader, to unpin the last
+ * page.  A loader is used by one thread at a time.
+ */
+class BulkLoader {
+ public:
+  /**
+   * Constructs a loader that appends records to the given file.
+   *
+   * @param buf_mgr   Buffer manager to allocate pages through.  Must outlive
+   *                  the loader.
+   * @param file      File to load into.
+   */
+  BulkLoader(BufMgr* buf_mgr, File* file);
+
+  BulkLoader(const BulkLoader&) = delete;
+  BulkLoader& operator=(const BulkLoader&) = delete;
+
+  /**
+   * Unpins the page being filled, if any.
+   */
+  ~BulkLoader() {
+    finish();
+  }
+
+  /**
+   * Appends one record.
+   *
+   * @param record  Record to append.
+   * @return  ID of the record.
+   * @throws  InsufficientSpaceException  Thrown if the record does not fit on
+   *                                      an empty page.
+   */
+  RecordId insertRecord(const RecordView& record);
+
+  /**
+   * Appends a batch of records, in order, moving on to a new page whenever
+   * the current one fills up.
+   *
+   * @param records      Records to append.
+   * @param num_records  Number of records in the batch.
+   * @param record_ids   If not NULL, receives the IDs of the records, in order;
+   *                     must have room for <num_records> IDs.
+   * @throws  InsufficientSpaceException  Thrown if a record does not fit on an
+   *                                      empty page.  The records before it
+   *                                      have been appended.
+   */
+  void insertRecords(const RecordView* records, const std::size_t num_records,
+                     RecordId* record_ids = NULL);
+
+  /**
+   * Unpins the page being filled.  Later inserts start on a new page.
+   */
+  void finish() { page_.release(); }
+
+  /**
+   * Returns the number of pages the loader has allocated.
+   *
+   * @return  Number of pages.
+   */
+  std::size_t num_pages() const { return num_pages_; }
+
+ private:
+  /**
+   * Buffer manager pages are allocated through.
+   */
+  BufMgr* buf_mgr_;
+
+  /**
+   * File being loaded.
+   */
+  File* file_;
+
+  /**
+   * Ring of frames the load recycles.
+   */
+  BufferAccessStrategy strategy_;
+
+  /**
+   * Page being filled, or an empty handle before the first insert and after
+   * finish().
+   */
+  PageHandle page_;
+
+  /**
+   * Number of pages allocated so far.
+   */
+  std::size_t num_pages_;
+};
+
+}
@@ -0,0 +1,214 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#include "crc32c.h"
+
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <nmmintrin.h>
+#endif
+
+namespace badgerdb {
+
+namespace {
+
+/**
+ * CRC-32C polynomial, bit-reversed.
+ */
+const std::uint32_t POLYNOMIAL = 0x82f63b78;
+
+/**
+ * Bytes of each of the three streams checksummed side by side per round of
+ * the hardware version.
+ */
+const std::size_t STRIPE = 256;
+
+/**
+ * The functions below work on the CRC register, which is the checksum with
+ * its bits inverted.
+ */
+typedef std::uint32_t (*ExtendFunction)(std::uint32_t, const unsigned char*,
+                                        std::size_t);
+
+struct Tables {
+  Tables();
+
+  /**
+   * byte[k][n] is the register after byte n followed by k zero bytes,
+   * starting from 0.
+   */
+  std::uint32_t byte[8][256];
+
+  /**
+   * Registers after STRIPE zero bytes, starting from each byte of a register
+   * in turn.  The register for a whole starting register is the exclusive or
+   * of the four.
+   */
+  std::uint32_t stripe_shift[4][256];
+
+  /**
+   * Same as stripe_shift, after 2 * STRIPE zero bytes.
+   */
+  std::uint32_t two_stripe_shift[4][256];
+};
+
+std::uint32_t shiftZeros(const std::uint32_t (&byte)[8][256],
+                         std::uint32_t crc, std::size_t length) {
+  while (length-- > 0) {
+    crc = byte[0][crc & 0xff] ^ (crc >> 8);
+  }
+  return crc;
+}
+
+void buildShift(const std::uint32_t (&byte)[8][256], const std::size_t length,
+                std::uint32_t (&shift)[4][256]) {
+  // Appending zeros is linear in the starting register, so the result for any
+  // register combines the results for its bits.
+  std::uint32_t basis[32];
+  for (std::size_t bit = 0; bit < 32; ++bit) {
+    basis[bit] = shiftZeros(byte, 1u << bit, length);
+  }
+  for (std::size_t k = 0; k < 4; ++k) {
+    for (std::uint32_t n = 0; n < 256; ++n) {
+      std::uint32_t crc = 0;
+      for (std::size_t bit = 0; bit < 8; ++bit) {
+        if (n & (1u << bit)) {
+          crc ^= basis[8 * k + bit];
+        }
+      }
+      shift[k][n] = crc;
+    }
+  }
+}
+
+Tables::Tables() {
+  for (std::uint32_t n = 0; n < 256; ++n) {
+    std::uint32_t crc = n;
+    for (int bit = 0; bit < 8; ++bit) {
+      crc = (crc & 1) ? (crc >> 1) ^ POLYNOMIAL : crc >> 1;
+    }
+    byte[0][n] = crc;
+  }
+  for (std::size_t k = 1; k < 8; ++k) {
+    for (std::uint32_t n = 0; n < 256; ++n) {
+      byte[k][n] = (byte[k - 1][n] >> 8) ^ byte[0][byte[k - 1][n] & 0xff];
+    }
+  }
+  buildShift(byte, STRIPE, stripe_shift);
+  buildShift(byte, 2 * STRIPE, two_stripe_shift);
+}
+
+const Tables& tables() {
+  static const Tables instance;
+  return instance;
+}
+
+std::uint64_t load64(const unsigned char* p) {
+  std::uint64_t value;
+  std::memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+std::uint32_t extendTable(std::uint32_t crc, const unsigned char* data,
+                          std::size_t length) {
+  const Tables& t = tables();
+  while (length >= 8) {
+    // Both words are taken little-endian.
+    const std::uint64_t word = load64(data) ^ crc;
+    const std::uint32_t low = static_cast<std::uint32_t>(word);
+    const std::uint32_t high = static_cast<std::uint32_t>(word >> 32);
+    crc = t.byte[7][low & 0xff] ^ t.byte[6][(low >> 8) & 0xff] ^
+        t.byte[5][(low >> 16) & 0xff] ^ t.byte[4][low >> 24] ^
+        t.byte[3][high & 0xff] ^ t.byte[2][(high >> 8) & 0xff] ^
+        t.byte[1][(high >> 16) & 0xff] ^ t.byte[0][high >> 24];
+    data += 8;
+    length -= 8;
+  }
+  while (length-- > 0) {
+    crc = t.byte[0][(crc ^ *data++) & 0xff] ^ (crc >> 8);
+  }
+  return crc;
+}
+
+#if defined(__x86_64__)
+
+std::uint32_t shift(const std::uint32_t (&table)[4][256],
+                    const std::uint32_t crc) {
+  return table[0][crc & 0xff] ^ table[1][(crc >> 8) & 0xff] ^
+      table[2][(crc >> 16) & 0xff] ^ table[3][crc >> 24];
+}
+
+__attribute__((target("sse4.2")))
+std::uint32_t extendHardware(std::uint32_t crc, const unsigned char* data,
+                             std::size_t length) {
+  // Each crc32 instruction depends on the previous one, so a single stream
+  // waits on its latency.  Three independent streams keep the unit busy; the
+  // checksum of the round is the first stream's shifted past the other two,
+  // combined with the second's shifted past the third, and the third's.
+  const Tables& t = tables();
+  while (length >= 3 * STRIPE) {
+    std::uint64_t first = crc;
+    std::uint64_t second = 0;
+    std::uint64_t third = 0;
+    for (std::size_t i = 0; i < STRIPE; i += 8) {
+      first = _mm_crc32_u64(first, load64(data + i));
+      second = _mm_crc32_u64(second, load64(data + STRIPE + i));
+      third = _mm_crc32_u64(third, load64(data + 2 * STRIPE + i));
+    }
+    crc = shift(t.two_stripe_shift, static_cast<std::uint32_t>(first)) ^
+        shift(t.stripe_shift, static_cast<std::uint32_t>(second)) ^
+        static_cast<std::uint32_t>(third);
+    data += 3 * STRIPE;
+    length -= 3 * STRIPE;
+  }
+  std::uint64_t crc64 = crc;
+  while (length >= 8) {
+    crc64 = _mm_crc32_u64(crc64, load64(data));
+    data += 8;
+    length -= 8;
+  }
+  crc = static_cast<std::uint32_t>(crc64);
+  while (length-- > 0) {
+    crc = _mm_crc32_u8(crc, *data++);
+  }
+  return crc;
+}
+
+#endif
+
+}
+
+std::uint32_t Crc32c::extend(const std::uint32_t crc, const char* data,
+                             const std::size_t length) {
+#if defined(__x86_64__)
+  static const ExtendFunction extend_function =
+      hardwareAvailable() ? extendHardware : extendTable;
+#else
+  static const ExtendFunction extend_function = extendTable;
+#endif
+  return ~extend_function(~crc, reinterpret_cast<const unsigned char*>(data),
+                          length);
+}
+
+std::uint32_t Crc32c::extendPortable(const std::uint32_t crc,
+                                     const char* data,
+                                     const std::size_t length) {
+  return ~extendTable(~crc, reinterpret_cast<const unsigned char*>(data),
+                      length);
+}
+
+bool Crc32c::hardwareAvailable() {
+#if defined(__x86_64__)
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("sse4.2");
+#else
+  return false;
+#endif
+}
+
+}
@@ -0,0 +1,61 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace badgerdb {
+
+/**
+ * @brief CRC-32C (Castagnoli) checksums, used for page checksums.
+ *
+ * On x86-64 processors with SSE4.2 the checksum is computed with the crc32
+ * instruction over three interleaved streams, whose results are then
+ * combined; elsewhere a table-driven version which consumes eight bytes per
+ * step is used.  Both give the same results.
+ */
+class Crc32c {
+ public:
+  /**
+   * Returns the checksum of the given bytes.
+   *
+   * @param data    Bytes to checksum.
+   * @param length  Number of bytes.
+   * @return  Checksum of the bytes.
+   */
+  static std::uint32_t value(const char* data, const std::size_t length) {
+    return extend(0, data, length);
+  }
+
+  /**
+   * Returns the checksum of some bytes followed by the given bytes, given the
+   * checksum of the former.
+   *
+   * @param crc     Checksum of the preceding bytes; 0 for none.
+   * @param data    Bytes to checksum.
+   * @param length  Number of bytes.
+   * @return  Checksum of all the bytes.
+   */
+  static std::uint32_t extend(const std::uint32_t crc, const char* data,
+                              const std::size_t length);
+
+  /**
+   * Same as extend(), always with the table-driven version.
+   */
+  static std::uint32_t extendPortable(const std::uint32_t crc,
+                                      const char* data,
+                                      const std::size_t length);
+
+  /**
+   * Returns true if extend() uses the crc32 instruction.
+   */
+  static bool hardwareAvailable();
+};
+
+}
@@ -0,0 +1,26 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#include "file_version_exception.h"
+
+#include <sstream>
+#include <string>
+
+namespace badgerdb {
+
+FileVersionException::FileVersionException(
+    const std::uint32_t version, const std::string& file)
+    : BadgerDbException(""),
+      version_(version),
+      filename_(file) {
+  std::stringstream ss;
+  ss << "File format version " << version_ << " is not supported."
+     << " File '" << filename_ << "'";
+  message_.assign(ss.str());
+}
+
+}
@@ -0,0 +1,59 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "badgerdb_exception.h"
+
+namespace badgerdb {
+
+/**
+ * @brief An exception that is thrown when a file is laid out in a version of
+ *        the file format this code does not know.
+ */
+class FileVersionException : public BadgerDbException {
+ public:
+  /**
+   * Constructs a file version exception for the given version and filename.
+   *
+   * @param version   Version stored in the file header.
+   * @param file      Name of the file.
+   */
+  FileVersionException(const std::uint32_t version, const std::string& file);
+
+  /**
+   * Destroys the exception.  Does nothing special; just included to make the
+   * compiler happy.
+   */
+  virtual ~FileVersionException() throw() {}
+
+  /**
+   * Returns the version that caused this exception.
+   */
+  virtual std::uint32_t version() const { return version_; }
+
+  /**
+   * Returns name of the file that caused this exception.
+   */
+  virtual const std::string& filename() const { return filename_; }
+
+ protected:
+  /**
+   * Version which caused this exception.
+   */
+  const std::uint32_t version_;
+
+  /**
+   * Name of file which caused this exception.
+   */
+  const std::string filename_;
+};
+
+}
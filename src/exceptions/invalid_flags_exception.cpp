@@ -0,0 +1,27 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#include "invalid_flags_exception.h"
+
+#include <sstream>
+#include <string>
+
+namespace badgerdb {
+
+InvalidFlagsException::InvalidFlagsException(
+    const std::uint32_t flags, const std::string& file)
+    : BadgerDbException(""),
+      flags_(flags),
+      filename_(file) {
+  std::stringstream ss;
+  ss << "Flags 0x" << std::hex << flags_
+     << " do not describe a valid file layout."
+     << " File '" << filename_ << "'";
+  message_.assign(ss.str());
+}
+
+}
@@ -0,0 +1,59 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "badgerdb_exception.h"
+
+namespace badgerdb {
+
+/**
+ * @brief An exception that is thrown when a file is given flags that do not
+ *        describe a layout it can have.
+ */
+class InvalidFlagsException : public BadgerDbException {
+ public:
+  /**
+   * Constructs an invalid flags exception for the given flags and filename.
+   *
+   * @param flags   Flags of the file.
+   * @param file    Name of the file.
+   */
+  InvalidFlagsException(const std::uint32_t flags, const std::string& file);
+
+  /**
+   * Destroys the exception.  Does nothing special; just included to make the
+   * compiler happy.
+   */
+  virtual ~InvalidFlagsException() throw() {}
+
+  /**
+   * Returns the flags that caused this exception.
+   */
+  virtual std::uint32_t flags() const { return flags_; }
+
+  /**
+   * Returns name of the file that caused this exception.
+   */
+  virtual const std::string& filename() const { return filename_; }
+
+ protected:
+  /**
+   * Flags which caused this exception.
+   */
+  const std::uint32_t flags_;
+
+  /**
+   * Name of file which caused this exception.
+   */
+  const std::string filename_;
+};
+
+}
@@ -0,0 +1,27 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#include "io_exception.h"
+
+#include <cstring>
+#include <sstream>
+#include <string>
+
+namespace badgerdb {
+
+IoException::IoException(const std::string& file,
+                         const std::string& operation, const int error)
+    : BadgerDbException(""),
+      filename_(file),
+      error_(error) {
+  std::stringstream ss;
+  ss << "I/O operation " << operation << " failed on file '" << filename_
+     << "': " << std::strerror(error_);
+  message_.assign(ss.str());
+}
+
+}
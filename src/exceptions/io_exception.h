@@ -0,0 +1,60 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <string>
+
+#include "badgerdb_exception.h"
+
+namespace badgerdb {
+
+/**
+ * @brief An exception that is thrown when the operating system fails to open,
+ *        read, write or sync a file.
+ */
+class IoException : public BadgerDbException {
+ public:
+  /**
+   * Constructs an I/O exception for the given file and operation.
+   *
+   * @param file        Name of the file.
+   * @param operation   Name of the operation which failed, such as "pwrite".
+   * @param error       Error number the operation failed with.
+   */
+  IoException(const std::string& file, const std::string& operation,
+              const int error);
+
+  /**
+   * Destroys the exception.  Does nothing special; just included to make the
+   * compiler happy.
+   */
+  virtual ~IoException() throw() {}
+
+  /**
+   * Returns name of the file that caused this exception.
+   */
+  virtual const std::string& filename() const { return filename_; }
+
+  /**
+   * Returns the error number the operation failed with.
+   */
+  virtual int error() const { return error_; }
+
+ protected:
+  /**
+   * Name of file which caused this exception.
+   */
+  const std::string filename_;
+
+  /**
+   * Error number the operation failed with.
+   */
+  const int error_;
+};
+
+}
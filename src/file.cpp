@@ -7,31 +7,58 @@
 
 #include "file.h"
 
+#include <algorithm>
+#include <exception>
 #include <fstream>
 #include <iostream>
 #include <memory>
 #include <string>
+#include <utility>
 #include <cstdio>
 #include <cassert>
+#include <cstddef>
+#include <cstring>
 
+#include "crc32c.h"
+#include "exceptions/corrupt_page_exception.h"
 #include "exceptions/file_exists_exception.h"
 #include "exceptions/file_not_found_exception.h"
 #include "exceptions/file_open_exception.h"
+#include "exceptions/file_version_exception.h"
+#include "exceptions/invalid_flags_exception.h"
 #include "exceptions/invalid_page_exception.h"
+#include "exceptions/io_exception.h"
 #include "file_iterator.h"
+#include "lz_codec.h"
 #include "page.h"
 
 namespace badgerdb {
 
 File::StreamMap File::open_streams_;
 File::CountMap File::open_counts_;
+File::LatchMap File::open_latches_;
+File::ExtentTableMap File::open_extent_tables_;
+File::HeaderCacheMap File::open_headers_;
+std::mutex File::registry_latch_;
 
-File File::create(const std::string& filename) {
-  return File(filename, true /* create_new */);
+const std::uint32_t FileHeader::MAGIC;
+const std::uint32_t FileHeader::VERSION;
+
+static_assert(offsetof(FileHeader, magic) == 16,
+              "Files of version 0 must be told apart by their magic field.");
+
+const std::uint32_t File::COMPRESSED;
+const std::uint32_t File::CHECKSUMS;
+const std::uint32_t File::ALIGNED;
+const std::uint32_t File::EXTENT_ALIGNMENT;
+
+File File::create(const std::string& filename, const std::uint32_t flags,
+                  const FileIoConfig& config) {
+  return File(filename, true /* create_new */, flags, config);
 }
 
-File File::open(const std::string& filename) {
-  return File(filename, false /* create_new */);
+File File::open(const std::string& filename, const FileIoConfig& config) {
+  return File(filename, false /* create_new */, 0 /* flags */, config);
 }
 
 void File::remove(const std::string& filename) {
@@ -48,6 +75,7 @@ bool File::isOpen(const std::string& filename) {
   if (!exists(filename)) {
     return false;
   }
+  std::lock_guard<std::mutex> registry(registry_latch_);
   return open_counts_.find(filename) != open_counts_.end();
 }
 
@@ -64,29 +92,54 @@ bool File::exists(const std::string& filename) {
 
 File::File(const File& other)
   : filename_(other.filename_),
-    stream_(open_streams_[filename_]) {
+    flags_(other.flags_) {
+  std::lock_guard<std::mutex> registry(registry_latch_);
+  stream_ = open_streams_[filename_];
+  latch_ = open_latches_[filename_];
+  extent_table_ = open_extent_tables_[filename_];
+  header_ = open_headers_[filename_];
   ++open_counts_[filename_];
 }
 
 File& File::operator=(const File& rhs) {
-  // This accounts for self-assignment and assignment of a File object for the
-  // same file.
-  close();	//close my file and associate me with the new one
-  filename_ = rhs.filename_;
-  openIfNeeded(false /* create_new */);
+  if (this == &rhs) {
+    return *this;
+  }
+  // Share rhs's open file, with its backend, header and extents, before
+  // letting go of mine, which may be the same file: closing first could drop
+  // its last reference and reopen it with none of them.
+  File copy(rhs);
+  std::swap(filename_, copy.filename_);
+  std::swap(flags_, copy.flags_);
+  std::swap(stream_, copy.stream_);
+  std::swap(latch_, copy.latch_);
+  std::swap(extent_table_, copy.extent_table_);
+  std::swap(header_, copy.header_);
+  copy.close();	//copy holds my old file now
   return *this;
 }
 
 File::~File() {
-  close();
+  try {
+    close();
+  } catch (const IoException&) {
+    // A destructor must not throw; callers wanting the error call close().
+  }
 }
 
 Page File::allocatePage() {
-  FileHeader header = readHeader();
   Page new_page;
+  allocatePage(new_page);
+  return new_page;
+}
+
+void File::allocatePage(Page& new_page) {
+  std::lock_guard<std::recursive_mutex> guard(*latch_);
+  stream_->waitForWrites();
+  FileHeader header = readHeader();
   Page existing_page;
   if (header.num_free_pages > 0) {
-    new_page = readPage(header.first_free_page, true /* allow_free */);
+    readPageData(header.first_free_page, new_page);
     new_page.set_page_number(header.first_free_page);
     header.first_free_page = new_page.next_page_number();
     --header.num_free_pages;
@@ -118,19 +171,17 @@ Page File::allocatePage() {
     assert((header.num_free_pages == 0) ==
            (header.first_free_page == Page::INVALID_NUMBER));
   } else {
+    new_page.initialize();
     new_page.set_page_number(header.num_pages);
     if (header.first_used_page == Page::INVALID_NUMBER) {
       header.first_used_page = new_page.page_number();
     } else {
       // If we have pages allocated, we need to add the new page to the tail
-      // of the linked list.
-      for (FileIterator iter = begin(); iter != end(); ++iter) {
-        if ((*iter).next_page_number() == Page::INVALID_NUMBER) {
-          existing_page = *iter;
-          break;
-        }
-      }
-      assert(existing_page.isUsed());
+      // of the linked list.  With no free pages, every page before the new one
+      // is used, and the list is kept in page number order, so the tail is the
+      // page just before the new one.
+      existing_page = readPage(header.num_pages - 1, false /* allow_free */);
+      assert(existing_page.next_page_number() == Page::INVALID_NUMBER);
       existing_page.set_next_page_number(new_page.page_number());
     }
     ++header.num_pages;
@@ -142,23 +193,119 @@ Page File::allocatePage() {
     writePage(existing_page.page_number(), existing_page);
   }
   writeHeader(header);
-
-  return new_page;
+  syncAfterChange();
 }
 
 Page File::readPage(const PageId page_number) const {
-  FileHeader header = readHeader();
-  if (page_number >= header.num_pages) {
+  if (page_number >= header_->num_pages) {
     throw InvalidPageException(page_number, filename_);
   }
   return readPage(page_number, false /* allow_free */);
 }
 
+std::vector<Page> File::readPages(const PageId first_page_number,
+                                  const PageId count) const {
+  std::unique_lock<std::recursive_mutex> guard = lockForRead();
+  const PageId num_pages = header_->num_pages;
+  if (first_page_number == Page::INVALID_NUMBER ||
+      first_page_number >= num_pages) {
+    throw InvalidPageException(first_page_number, filename_);
+  }
+  const PageId num_read = std::min<PageId>(count,
+                                           num_pages - first_page_number);
+
+  std::vector<Page> pages(num_read);
+  std::vector<std::uint32_t> stored_checksums(num_read, 0);
+  if (compressed()) {
+    // Compressed pages have no fixed place in the file, so they are read one
+    // at a time.
+    for (PageId i = 0; i < num_read; ++i) {
+      readCompressedPage(first_page_number + i, pages[i], stored_checksums[i]);
+    }
+  } else if (checksums()) {
+    // Each page is followed by its checksum, so the run is read whole and the
+    // pages are copied out of it.
+    const std::size_t stride = storedPageSize();
+    std::vector<char> stored(num_read * stride);
+    stream_->read(pagePosition(first_page_number), &stored[0], stored.size());
+    for (PageId i = 0; i < num_read; ++i) {
+      std::memcpy(&pages[i], &stored[i * stride], Page::SIZE);
+      std::memcpy(&stored_checksums[i], &stored[i * stride + Page::SIZE],
+                  sizeof(std::uint32_t));
+    }
+  } else {
+    // Pages are laid out in memory exactly as on disk, so the run is read
+    // straight into them.
+    stream_->read(pagePosition(first_page_number),
+                  reinterpret_cast<char*>(&pages[0]), num_read * Page::SIZE);
+  }
+  for (PageId i = 0; i < num_read; ++i) {
+    if (!checksumMatches(pages[i], stored_checksums[i])) {
+      pages[i].header_.current_page_number = Page::INVALID_NUMBER;
+    }
+  }
+  return pages;
+}
+
+void File::readPage(const PageId page_number, Page& page) const {
+  if (page_number == Page::INVALID_NUMBER ||
+      !readPageData(page_number, page) || !page.isUsed()) {
+    throw InvalidPageException(page_number, filename_);
+  }
+}
+
+bool File::readPageData(const PageId page_number, Page& page) const {
+  std::unique_lock<std::recursive_mutex> guard = lockForRead();
+  std::uint32_t checksum = 0;
+  if (compressed()) {
+    if (!readCompressedPage(page_number, page, checksum)) {
+      return false;
+    }
+  } else if (checksums()) {
+    // The checksum follows the page, and is read with it.
+    char stored[Page::SIZE + sizeof(checksum)];
+    if (!stream_->read(pagePosition(page_number), stored, sizeof(stored))) {
+      return false;
+    }
+    std::memcpy(&page, stored, Page::SIZE);
+    std::memcpy(&checksum, stored + Page::SIZE, sizeof(checksum));
+  } else if (!stream_->read(pagePosition(page_number),
+                            reinterpret_cast<char*>(&page), Page::SIZE)) {
+    // Past the end of the file.
+    return false;
+  }
+  if (!checksumMatches(page, checksum)) {
+    throw CorruptPageException(page_number, filename_);
+  }
+  return true;
+}
+
+bool File::validFlags(const std::uint32_t flags) {
+  if ((flags & ~(COMPRESSED | CHECKSUMS | ALIGNED)) != 0) {
+    return false;
+  }
+  // Checksums after the pages would leave them out of alignment.
+  return (flags & ALIGNED) == 0 || (flags & CHECKSUMS) == 0;
+}
+
+std::uint32_t File::pageChecksum(const PageHeader& header, const char* data) {
+  std::uint32_t crc = Crc32c::value(reinterpret_cast<const char*>(&header),
+                                    sizeof(header));
+  crc = Crc32c::extend(crc, data, Page::DATA_SIZE);
+  // 0 is never stored, so that a zeroed checksum never matches.
+  return crc == 0 ? 1 : crc;
+}
+
+bool File::checksumMatches(const Page& page,
+                           const std::uint32_t checksum) const {
+  // Every page of a file with checksums is written with one, so a zeroed
+  // checksum is a torn or lost write like any other mismatch.
+  return !checksums() || checksum == pageChecksum(page.header_, page.data_);
+}
+
 Page File::readPage(const PageId page_number, const bool allow_free) const {
   Page page;
-  stream_->seekg(pagePosition(page_number), std::ios::beg);
-  stream_->read(reinterpret_cast<char*>(&page.header_), sizeof(page.header_));
-  stream_->read(&page.data_[0], Page::DATA_SIZE);
+  readPageData(page_number, page);
   if (!allow_free && !page.isUsed()) {
     throw InvalidPageException(page_number, filename_);
   }
@@ -166,7 +313,39 @@ Page File::readPage(const PageId page_number, const bool allow_free) const {
   return page;
 }
 
+Page* File::mapPage(const PageId page_number) {
+  if (!mapped()) {
+    return NULL;
+  }
+  char* bytes = page_number == Page::INVALID_NUMBER
+      ? NULL
+      : stream_->map(pagePosition(page_number), Page::SIZE);
+  if (bytes == NULL) {
+    // Past the end of the file.
+    throw InvalidPageException(page_number, filename_);
+  }
+  // Pages are laid out in memory exactly as on disk.
+  Page* page = reinterpret_cast<Page*>(bytes);
+  if (!page->isUsed()) {
+    throw InvalidPageException(page_number, filename_);
+  }
+  return page;
+}
+
 void File::writePage(const Page& new_page) {
+  std::lock_guard<std::recursive_mutex> guard(*latch_);
+  if (mapped() && new_page.page_number() != Page::INVALID_NUMBER &&
+      stream_->map(pagePosition(new_page.page_number()), Page::SIZE) ==
+          reinterpret_cast<const char*>(&new_page)) {
+    // A page from mapPage() is the file's own copy, already changed in place.
+    syncAfterChange();
+    return;
+  }
+  writePage(new_page.page_number(), headerToWrite(new_page), new_page);
+  syncAfterChange();
+}
+
+PageHeader File::headerToWrite(const Page& new_page) const {
   PageHeader header = readPageHeader(new_page.page_number());
   if (header.current_page_number == Page::INVALID_NUMBER) {
     // Page has been deleted since it was read.
@@ -178,10 +357,45 @@ void File::writePage(const Page& new_page) {
   const PageId next_page_number = header.next_page_number;
   header = new_page.header_;
   header.next_page_number = next_page_number;
-  writePage(new_page.page_number(), header, new_page);
+  return header;
+}
+
+int File::pageDescriptor() const {
+  // Pages of mapped files may be written in place, which only writePage()
+  // knows how to do.
+  return compressed() || mapped() ? -1 : stream_->descriptor();
+}
+
+PageHeader File::beginAsyncWrite(const Page& new_page,
+                                 std::uint32_t& checksum) {
+  std::lock_guard<std::recursive_mutex> guard(*latch_);
+  PageHeader header = headerToWrite(new_page);
+  checksum = checksums() ? pageChecksum(header, new_page.data_) : 0;
+  stream_->beginWrite();
+  return header;
+}
+
+void File::endAsyncWrite() {
+  stream_->endWrite();
+}
+
+void File::checkAsyncRead(const PageId page_number, const Page& page,
+                          const std::uint32_t checksum,
+                          const bool complete) const {
+  if (page_number == Page::INVALID_NUMBER || !complete) {
+    throw InvalidPageException(page_number, filename_);
+  }
+  if (!checksumMatches(page, checksum)) {
+    throw CorruptPageException(page_number, filename_);
+  }
+  if (!page.isUsed()) {
+    throw InvalidPageException(page_number, filename_);
+  }
 }
 
 void File::deletePage(const PageId page_number) {
+  std::lock_guard<std::recursive_mutex> guard(*latch_);
+  stream_->waitForWrites();
   FileHeader header = readHeader();
   Page existing_page = readPage(page_number);
   Page previous_page;
@@ -209,9 +423,18 @@ void File::deletePage(const PageId page_number) {
   }
   writePage(page_number, existing_page);
   writeHeader(header);
+  syncAfterChange();
+}
+
+void File::sync() const {
+  std::lock_guard<std::recursive_mutex> guard(*latch_);
+  stream_->waitForWrites();
+  flushHeader();
+  stream_->sync();
 }
 
 FileIterator File::begin() {
+  std::lock_guard<std::recursive_mutex> guard(*latch_);
   const FileHeader& header = readHeader();
   return FileIterator(this, header.first_used_page);
 }
@@ -220,50 +443,115 @@ FileIterator File::end() {
   return FileIterator(this, Page::INVALID_NUMBER);
 }
 
-File::File(const std::string& name, const bool create_new) : filename_(name) {
-  openIfNeeded(create_new);
+File::File(const std::string& name, const bool create_new,
+           const std::uint32_t flags, const FileIoConfig& config)
+  : filename_(name),
+    flags_(flags) {
+  if (create_new && !validFlags(flags)) {
+    throw InvalidFlagsException(flags, filename_);
+  }
+  openIfNeeded(create_new, config);
 
   if (create_new) {
     // File starts with 1 page (the header).
     FileHeader header = {1 /* num_pages */, 0 /* first_used_page */,
-                         0 /* num_free_pages */, 0 /* first_free_page */};
+                         0 /* num_free_pages */, 0 /* first_free_page */,
+                         FileHeader::MAGIC, FileHeader::VERSION, flags};
     writeHeader(header);
+    // A new file is written out with its header right away.
+    flushHeader();
+  } else {
+    try {
+      flags_ = readHeader().flags;
+    } catch (...) {
+      // No destructor runs for an object whose constructor throws.
+      close();
+      throw;
+    }
+  }
+  if (compressed()) {
+    loadExtents();
   }
 }
 
-void File::openIfNeeded(const bool create_new) {
+void File::openIfNeeded(const bool create_new, const FileIoConfig& config) {
+  std::lock_guard<std::mutex> registry(registry_latch_);
   if (open_counts_.find(filename_) != open_counts_.end()) {	//exists an entry already
     ++open_counts_[filename_];
     stream_ = open_streams_[filename_];
+    latch_ = open_latches_[filename_];
+    extent_table_ = open_extent_tables_[filename_];
+    header_ = open_headers_[filename_];
   } else {
-    std::ios_base::openmode mode =
-        std::fstream::in | std::fstream::out | std::fstream::binary;
     const bool already_exists = exists(filename_);
     if (create_new) {
       // Error if we try to overwrite an existing file.
       if (already_exists) {
         throw FileExistsException(filename_);
       }
-      // New files have to be truncated on open.
-      mode = mode | std::fstream::trunc;
     } else {
       // Error if we try to open a file that doesn't exist.
       if (!already_exists) {
         throw FileNotFoundException(filename_);
       }
     }
-    stream_.reset(new std::fstream(filename_, mode));
+    stream_.reset(FileIo::open(filename_, create_new, config));
+    latch_.reset(new std::recursive_mutex());
+    extent_table_.reset(new ExtentTable());
+    header_.reset(new HeaderCache());
     open_streams_[filename_] = stream_;
+    open_latches_[filename_] = latch_;
+    open_extent_tables_[filename_] = extent_table_;
+    open_headers_[filename_] = header_;
     open_counts_[filename_] = 1;
   }
 }
 
 void File::close() {
-  --open_counts_[filename_];
-  stream_.reset();
-  if (open_counts_[filename_] == 0) {
-    open_streams_.erase(filename_);
-    open_counts_.erase(filename_);
+  std::exception_ptr error;
+  {
+    std::lock_guard<std::mutex> registry(registry_latch_);
+    if (!stream_) {
+      return;
+    }
+    --open_counts_[filename_];
+    if (open_counts_[filename_] == 0) {
+      // The last File object for the file writes back its header.  The file
+      // is let go of even if that fails, and the error reported after.
+      try {
+        flushHeader();
+      } catch (const IoException&) {
+        error = std::current_exception();
+      }
+    }
+    stream_.reset();
+    latch_.reset();
+    extent_table_.reset();
+    header_.reset();
+    if (open_counts_[filename_] == 0) {
+      open_streams_.erase(filename_);
+      open_counts_.erase(filename_);
+      open_latches_.erase(filename_);
+      open_extent_tables_.erase(filename_);
+      open_headers_.erase(filename_);
+    }
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+std::unique_lock<std::recursive_mutex> File::lockForRead() const {
+  if (!compressed() && stream_->concurrent()) {
+    return std::unique_lock<std::recursive_mutex>(*latch_, std::defer_lock);
+  }
+  return std::unique_lock<std::recursive_mutex>(*latch_);
+}
+
+void File::syncAfterChange() {
+  if (stream_->config().durability == FileIoConfig::SYNC_ALWAYS) {
+    flushHeader();
+    stream_->sync();
   }
 }
 
@@ -273,32 +561,246 @@ void File::writePage(const PageId page_number, const Page& new_page) {
 
 void File::writePage(const PageId page_number, const PageHeader& header,
                      const Page& new_page) {
-  stream_->seekp(pagePosition(page_number), std::ios::beg);
-  stream_->write(reinterpret_cast<const char*>(&header), sizeof(header));
-  stream_->write(&new_page.data_[0], Page::DATA_SIZE);
-  stream_->flush();
+  std::lock_guard<std::recursive_mutex> guard(*latch_);
+  const std::uint32_t checksum =
+      checksums() ? pageChecksum(header, new_page.data_) : 0;
+  if (compressed()) {
+    writeCompressedPage(page_number, header, new_page, checksum);
+    return;
+  }
+  // The header, data and checksum go out together, with a single write.
+  const FileIo::Buffer buffers[] = {
+      {reinterpret_cast<const char*>(&header), sizeof(header)},
+      {&new_page.data_[0], Page::DATA_SIZE},
+      {reinterpret_cast<const char*>(&checksum), sizeof(checksum)}};
+  stream_->write(pagePosition(page_number), buffers, checksums() ? 3 : 2);
 }
 
 FileHeader File::readHeader() const {
-  FileHeader header;
-  stream_->seekg(0 /* pos */, std::ios::beg);
-  stream_->read(reinterpret_cast<char*>(&header), sizeof(header));
+  std::lock_guard<std::recursive_mutex> guard(*latch_);
+  if (!header_->loaded) {
+    FileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    // A file of version 0 has its first page, or nothing, where the rest of
+    // the header would be, and page 1 never starts with the magic number.
+    if (!stream_->read(0 /* offset */, reinterpret_cast<char*>(&header),
+                       sizeof(header)) ||
+        header.magic != FileHeader::MAGIC) {
+      throw FileVersionException(0, filename_);
+    } else if (header.version != FileHeader::VERSION) {
+      throw FileVersionException(header.version, filename_);
+    } else if (!validFlags(header.flags)) {
+      throw InvalidFlagsException(header.flags, filename_);
+    }
+    header_->header = header;
+    header_->num_pages = header.num_pages;
+    header_->loaded = true;
+  }
 
-  return header;
+  return header_->header;
 }
 
 void File::writeHeader(const FileHeader& header) {
-  stream_->seekp(0 /* pos */, std::ios::beg);
-  stream_->write(reinterpret_cast<const char*>(&header), sizeof(header));
-  stream_->flush();
+  std::lock_guard<std::recursive_mutex> guard(*latch_);
+  header_->header = header;
+  header_->num_pages = header.num_pages;
+  header_->loaded = true;
+  header_->dirty = true;
+}
+
+void File::flushHeader() const {
+  std::lock_guard<std::recursive_mutex> guard(*latch_);
+  if (!header_->dirty) {
+    return;
+  }
+  stream_->write(0 /* offset */,
+                 reinterpret_cast<const char*>(&header_->header),
+                 sizeof(FileHeader));
+  header_->dirty = false;
 }
 
 PageHeader File::readPageHeader(PageId page_number) const {
+  std::lock_guard<std::recursive_mutex> guard(*latch_);
   PageHeader header;
-  stream_->seekg(pagePosition(page_number), std::ios::beg);
-  stream_->read(reinterpret_cast<char*>(&header), sizeof(header));
+  std::streamoff offset = pagePosition(page_number);
+  if (compressed()) {
+    // The page header is stored uncompressed after the compressed one.
+    const std::vector<PageExtent>& extents = extent_table_->extents;
+    if (page_number >= extents.size() || extents[page_number].offset == 0) {
+      std::memset(&header, 0, sizeof(header));
+      return header;
+    }
+    offset = extents[page_number].offset + sizeof(CompressedPageHeader);
+  }
+  stream_->read(offset, reinterpret_cast<char*>(&header), sizeof(header));
 
   return header;
 }
 
+void File::loadExtents() {
+  std::lock_guard<std::recursive_mutex> guard(*latch_);
+  if (extent_table_->loaded) {
+    return;
+  }
+  const std::streamoff size = stream_->size();
+  std::streamoff offset = dataOffset();
+  CompressedPageHeader stored;
+  while (offset + static_cast<std::streamoff>(sizeof(stored)) <= size) {
+    if (!stream_->read(offset, reinterpret_cast<char*>(&stored),
+                       sizeof(stored)) ||
+        stored.capacity == 0) {
+      break;
+    }
+    const PageExtent extent = {offset, stored.capacity, stored.data_length};
+    if (stored.page_number == Page::INVALID_NUMBER) {
+      // Space left behind by a page that moved.
+      freeExtent(extent);
+    } else {
+      std::vector<PageExtent>& extents = extent_table_->extents;
+      if (stored.page_number >= extents.size()) {
+        extents.resize(stored.page_number + 1, PageExtent());
+      }
+      if (extents[stored.page_number].capacity > 0) {
+        // A page whose move was cut short is stored twice; both copies are
+        // whole, and the one found first is given up.
+        freeExtent(extents[stored.page_number]);
+      }
+      extents[stored.page_number] = extent;
+    }
+    offset += stored.capacity;
+  }
+  extent_table_->end = offset;
+  extent_table_->loaded = true;
+}
+
+bool File::readCompressedPage(const PageId page_number, Page& page,
+                              std::uint32_t& checksum) const {
+  std::lock_guard<std::recursive_mutex> guard(*latch_);
+  const std::vector<PageExtent>& extents = extent_table_->extents;
+  if (page_number >= extents.size() || extents[page_number].offset == 0) {
+    return false;
+  }
+  const PageExtent& extent = extents[page_number];
+  if (extent.data_length > Page::DATA_SIZE) {
+    return false;
+  }
+  char stored[sizeof(CompressedPageHeader) + sizeof(PageHeader) +
+              Page::DATA_SIZE + sizeof(checksum)];
+  const std::size_t prefix = sizeof(CompressedPageHeader) + sizeof(PageHeader);
+  const std::size_t trailer = checksums() ? sizeof(checksum) : 0;
+  if (!stream_->read(extent.offset, stored,
+                     prefix + extent.data_length + trailer)) {
+    return false;
+  }
+  std::memcpy(&page.header_, stored + sizeof(CompressedPageHeader),
+              sizeof(PageHeader));
+  std::memcpy(&checksum, stored + prefix + extent.data_length, trailer);
+  if (extent.data_length == Page::DATA_SIZE) {
+    std::memcpy(page.data_, stored + prefix, Page::DATA_SIZE);
+    return true;
+  }
+  return LzCodec::decompress(stored + prefix, extent.data_length, page.data_,
+                             Page::DATA_SIZE);
+}
+
+void File::writeCompressedPage(const PageId page_number,
+                               const PageHeader& header,
+                               const Page& new_page,
+                               const std::uint32_t checksum) {
+  std::lock_guard<std::recursive_mutex> guard(*latch_);
+  char stored[sizeof(CompressedPageHeader) + sizeof(PageHeader) +
+              Page::DATA_SIZE + sizeof(checksum)];
+  const std::size_t prefix = sizeof(CompressedPageHeader) + sizeof(PageHeader);
+  // Data which does not shrink is stored as is.
+  std::uint32_t data_length = LzCodec::compress(
+      new_page.data_, Page::DATA_SIZE, stored + prefix, Page::DATA_SIZE - 1);
+  if (data_length == 0) {
+    data_length = Page::DATA_SIZE;
+    std::memcpy(stored + prefix, new_page.data_, Page::DATA_SIZE);
+  }
+  const std::size_t trailer = checksums() ? sizeof(checksum) : 0;
+  std::memcpy(stored + prefix + data_length, &checksum, trailer);
+  const std::uint32_t length = prefix + data_length + trailer;
+
+  std::vector<PageExtent>& extents = extent_table_->extents;
+  if (page_number >= extents.size()) {
+    extents.resize(page_number + 1, PageExtent());
+  }
+  PageExtent& extent = extents[page_number];
+  // Where the page was stored before, if it moves.
+  PageExtent moved_from = PageExtent();
+  if (extent.capacity < length) {
+    // The page's space at least doubles each time it outgrows it, so a page
+    // that keeps growing moves only a few times.
+    const std::uint32_t max_capacity = (sizeof(stored) + EXTENT_ALIGNMENT - 1) /
+        EXTENT_ALIGNMENT * EXTENT_ALIGNMENT;
+    const std::uint32_t wanted = std::max(length, 2 * extent.capacity);
+    const std::uint32_t capacity = std::min(
+        max_capacity,
+        (wanted + EXTENT_ALIGNMENT - 1) / EXTENT_ALIGNMENT * EXTENT_ALIGNMENT);
+    std::vector<std::vector<std::streamoff> >& free_extents =
+        extent_table_->free_extents;
+    if (extent.capacity > 0 &&
+        extent.offset + extent.capacity == extent_table_->end) {
+      // The last page in the file grows where it is.
+      extent_table_->end = extent.offset + capacity;
+    } else {
+      moved_from = extent;
+      const std::size_t size_class = capacity / EXTENT_ALIGNMENT;
+      if (size_class < free_extents.size() &&
+          !free_extents[size_class].empty()) {
+        extent.offset = free_extents[size_class].back();
+        free_extents[size_class].pop_back();
+      } else {
+        extent.offset = extent_table_->end;
+        extent_table_->end += capacity;
+      }
+    }
+    extent.capacity = capacity;
+  }
+  extent.data_length = data_length;
+
+  const CompressedPageHeader stored_header = {page_number, extent.capacity,
+                                              data_length};
+  std::memcpy(stored, &stored_header, sizeof(stored_header));
+  std::memcpy(stored + sizeof(stored_header), &header, sizeof(header));
+  try {
+    stream_->write(extent.offset, stored, length);
+  } catch (...) {
+    if (moved_from.capacity > 0) {
+      // The page is still where it was; its new space is given back.
+      if (extent.offset + extent.capacity == extent_table_->end) {
+        extent_table_->end = extent.offset;
+      } else {
+        freeExtent(extent);
+      }
+      extent = moved_from;
+    }
+    throw;
+  }
+
+  if (moved_from.capacity > 0) {
+    // The old space is freed only once the page is stored in its new space,
+    // so that a crash in between leaves a copy of it.  It is marked free on
+    // disk too, so that it is not mistaken for the page when the file is
+    // opened again.
+    const CompressedPageHeader free_header = {Page::INVALID_NUMBER,
+                                              moved_from.capacity, 0};
+    stream_->write(moved_from.offset,
+                   reinterpret_cast<const char*>(&free_header),
+                   sizeof(free_header));
+    freeExtent(moved_from);
+  }
+}
+
+void File::freeExtent(const PageExtent& extent) {
+  std::vector<std::vector<std::streamoff> >& free_extents =
+      extent_table_->free_extents;
+  const std::size_t size_class = extent.capacity / EXTENT_ALIGNMENT;
+  if (size_class >= free_extents.size()) {
+    free_extents.resize(size_class + 1);
+  }
+  free_extents[size_class].push_back(extent.offset);
+}
+
 }
@@ -7,11 +7,14 @@
 
 #pragma once
 
-#include <fstream>
+#include <atomic>
 #include <string>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <vector>
 
+#include "file_io.h"
 #include "page.h"
 
 namespace badgerdb {
@@ -20,8 +23,25 @@ class FileIterator;
 
 /**
  * @brief Header metadata for files on disk which contain pages.
+ *
+ * Every file stores the whole header.  Files written before the header had
+ * a version stored only the fields before magic, and their pages have the
+ * shorter PageHeader of that time, without the fragmentation count and the
+ * free slot list; they are taken to be of version 0 and are not opened.
  */
 struct FileHeader {
+  /**
+   * Value of magic in every file written by this code.  Both of its 16-bit
+   * halves are at least 0x2000, which the bytes a file of version 0 has in
+   * its place, the free space bounds of page 1, never are.
+   */
+  static const std::uint32_t MAGIC = 0x42444742;
+
+  /**
+   * Version of the layout of files written by this code.
+   */
+  static const std::uint32_t VERSION = 1;
+
   /**
    * Number of pages allocated in the file.
    */
@@ -42,6 +62,21 @@ struct FileHeader {
    */
   PageId first_free_page;
 
+  /**
+   * MAGIC.
+   */
+  std::uint32_t magic;
+
+  /**
+   * Version of the layout of the file, VERSION.
+   */
+  std::uint32_t version;
+
+  /**
+   * Flags the file was created with, such as File::COMPRESSED.
+   */
+  std::uint32_t flags;
+
   /**
    * Returns true if this file header is equal to the other.
    *
@@ -52,15 +87,44 @@ struct FileHeader {
     return num_pages == rhs.num_pages &&
         num_free_pages == rhs.num_free_pages &&
         first_used_page == rhs.first_used_page &&
-        first_free_page == rhs.first_free_page;
+        first_free_page == rhs.first_free_page &&
+        flags == rhs.flags;
   }
 };
 
+/**
+ * @brief Header of a page stored in a compressed file.
+ *
+ * It is followed by the PageHeader of the page, uncompressed, and then by
+ * data_length bytes of the page's data, which are compressed unless
+ * data_length is Page::DATA_SIZE, and by the page's checksum if the file keeps
+ * checksums.  The stored page takes up capacity bytes of the file in all,
+ * leaving room for it to grow when it is rewritten.
+ */
+struct CompressedPageHeader {
+  /**
+   * Number of the page stored here.
+   */
+  PageId page_number;
+
+  /**
+   * Bytes of the file reserved for the page, including this header.  Space
+   * left behind by a page that moved has page number Page::INVALID_NUMBER.
+   */
+  std::uint32_t capacity;
+
+  /**
+   * Number of bytes of page data that follow the page header.
+   */
+  std::uint32_t data_length;
+};
+
 /**
  * @brief Class which represents a file in the filesystem containing database
  *        pages.
  *
- * The File class wraps a stream to an underlying file on disk.  Files contain
+ * The File class wraps a stream to an underlying file on disk, a FileIo chosen
+ * with FileIoConfig when the file is opened.  Files contain
  * fixed-sized pages, and they never deallocate space (though they do reuse
  * deleted pages if possible).  If multiple File objects refer to the same
  * underlying file, they will share the stream in memory.
@@ -68,17 +132,66 @@ struct FileHeader {
  * detects this (by looking in the open_streams_ map) and just returns a file object with
  * the already created stream for the file without actually opening the UNIX file again. 
  *
- * @warning This class is not threadsafe.
+ * The file header is kept in memory, shared like the stream, and written back
+ * by sync() and when the last File object for the file is closed, rather than
+ * with every change to the page lists.
+ *
+ * File objects may be used from several threads.  All File objects for the same
+ * underlying file share one latch, which is held for the duration of every
+ * operation on the stream, except for reads of pages of uncompressed files
+ * when the stream allows concurrent reads, and the open_streams_ registry is
+ * guarded by a global latch.
+ *
+ * Writes are not forced to stable storage until sync() is called, unless the
+ * file was opened with another FileIoConfig::Durability.
  */
 class File {
  public:
+  /**
+   * Flag of files which store their pages compressed.  Pages are compressed
+   * when written and decompressed when read, so frames in the buffer pool
+   * always hold them uncompressed.  A stored page takes only the bytes it
+   * compresses to, rounded up to EXTENT_ALIGNMENT, and is found through a
+   * page-offset map which is rebuilt when the file is opened.
+   */
+  static const std::uint32_t COMPRESSED = 0x1;
+
+  /**
+   * Flag of files which store a checksum with every page, in the four bytes
+   * after it, so that the pages themselves are laid out as in other files.
+   * It is computed when a page is written and checked when it is read, so
+   * corruption on disk is reported instead of being handed to the buffer
+   * pool.  It cannot be combined with ALIGNED.
+   */
+  static const std::uint32_t CHECKSUMS = 0x2;
+
+  /**
+   * Flag of files whose pages start at multiples of Page::SIZE, with the file
+   * header alone in the first Page::SIZE bytes, so that every page is a whole
+   * number of blocks for FileIoConfig::DIRECT.
+   */
+  static const std::uint32_t ALIGNED = 0x4;
+
+  /**
+   * Granularity in bytes of the space reserved for a page in a compressed
+   * file.
+   */
+  static const std::uint32_t EXTENT_ALIGNMENT = 512;
+
   /**
    * Creates a new file.
    *
    * @param filename  Name of the file.
+   * @param flags     Flags of the new file, such as COMPRESSED; they cannot
+   *                  be changed later.
+   * @param config    How the file is read and written while it is open.
    * @throws  FileExistsException     If the requested file already exists.
+   * @throws  InvalidFlagsException   If the flags cannot be combined.
+   * @throws  IoException             If the file cannot be created.
    */
-  static File create(const std::string& filename);
+  static File create(const std::string& filename,
+                     const std::uint32_t flags = 0,
+                     const FileIoConfig& config = FileIoConfig());
 
   /**
    * Opens the file named fileName and returns the corresponding File object.
@@ -88,9 +201,18 @@ class File {
 	 * open_streams_ map.
    *
    * @param filename  Name of the file.
+   * @param config    How the file is read and written, unless it is already
+   *                  open, in which case the settings it was opened with are
+   *                  kept.
    * @throws  FileNotFoundException   If the requested file doesn't exist.
+   * @throws  FileVersionException    If the file has a layout version other
+   *                                  than FileHeader::VERSION, or none.
+   * @throws  InvalidFlagsException   If the file has flags that are not known
+   *                                  or cannot be combined.
+   * @throws  IoException             If the file cannot be opened.
    */
-  static File open(const std::string& filename);
+  static File open(const std::string& filename,
+                   const FileIoConfig& config = FileIoConfig());
 
   /**
    * Deletes an existing file.
@@ -134,10 +256,22 @@ class File {
 
   /**
    * Destructor that automatically closes the underlying file if no other
-   * File objects are using it.
+   * File objects are using it.  An error writing back the file header is not
+   * thrown from here; call close() first to see it.
    */
   ~File();
 
+  /**
+   * Lets go of the file.  The underlying file stream in <stream_> is only
+   * closed if no other File objects exist that access the same file; the last
+   * one writes back the file header first.  Does nothing if this File object
+   * is closed already.
+   *
+   * @throws  IoException   If the file header could not be written back.  The
+   *                        file is closed all the same.
+   */
+  void close();
+
   /**
    * Allocates a new page in the file.
    *
@@ -145,6 +279,14 @@ class File {
    */
   Page allocatePage();
 
+  /**
+   * Allocates a new page in the file, building it directly in the given page,
+   * typically a buffer pool frame.
+   *
+   * @param new_page  Page to overwrite with the new page.
+   */
+  void allocatePage(Page& new_page);
+
   /**
    * Reads an existing page from the file.
    *
@@ -155,6 +297,50 @@ class File {
    */
   Page readPage(const PageId page_number) const;
 
+  /**
+   * Reads an existing page from the file directly into the given page,
+   * typically a buffer pool frame, with a single seek and read.  Pages past
+   * the end of the file are detected by the read failing, so the file header
+   * is not read.  On failure the contents of the page are unspecified.
+   *
+   * @param page_number   Number of page to read.
+   * @param page          Page to overwrite with the page read.
+   * @throws  InvalidPageException  If the page doesn't exist in the file or is
+   *                                not currently used.
+   * @throws  CorruptPageException  If the file keeps checksums and the page
+   *                                does not match its own.
+   */
+  void readPage(const PageId page_number, Page& page) const;
+
+  /**
+   * Reads a run of consecutive pages from the file with a single read, or one
+   * read per page if the file is compressed.  The run is cut short at the end
+   * of the file.  Pages that are not currently used
+   * are returned too, with page number Page::INVALID_NUMBER, and so are pages
+   * that do not match their checksum; reading those on their own reports the
+   * corruption.
+   *
+   * @param first_page_number   Number of the first page to read.
+   * @param count               Number of pages to read.
+   * @return  The pages, in order.
+   * @throws  InvalidPageException  If the first page doesn't exist in the file.
+   */
+  std::vector<Page> readPages(const PageId first_page_number,
+                              const PageId count) const;
+
+  /**
+   * Returns an existing page in place in the mapping of a mapped file, without
+   * copying it.  The page stays valid until the file is closed.  Changes made
+   * to it change the file at once; writePage() on it has nothing left to
+   * write, and sync() makes the changes durable.
+   *
+   * @param page_number   Number of page to map.
+   * @return  The page, or NULL if the file is not mapped().
+   * @throws  InvalidPageException  If the page doesn't exist in the file or is
+   *                                not currently used.
+   */
+  Page* mapPage(const PageId page_number);
+
   /**
    * Writes a page into the file, replacing any existing contents.  The page
    * must have been already allocated in this file by a call to allocatePage().
@@ -171,6 +357,14 @@ class File {
    */
   void deletePage(const PageId page_number);
 
+  /**
+   * Forces every page and header written to the file so far to stable
+   * storage.
+   *
+   * @throws  IoException   If the file cannot be synced.
+   */
+  void sync() const;
+
   /**
    * Returns the name of the file this object represents.
    *
@@ -178,6 +372,44 @@ class File {
    */
   const std::string& filename() const { return filename_; }
 
+  /**
+   * Returns the flags the file was created with.
+   *
+   * @return Flags of file.
+   */
+  std::uint32_t flags() const { return flags_; }
+
+  /**
+   * Returns true if the file stores its pages compressed.
+   */
+  bool compressed() const { return (flags_ & COMPRESSED) != 0; }
+
+  /**
+   * Returns true if the file stores a checksum with every page.
+   */
+  bool checksums() const { return (flags_ & CHECKSUMS) != 0; }
+
+  /**
+   * Returns true if the pages of the file start at multiples of Page::SIZE.
+   */
+  bool aligned() const { return (flags_ & ALIGNED) != 0; }
+
+  /**
+   * Returns true if pages of the file can be reached in place with
+   * mapPage(): the file was opened with FileIoConfig::MAPPED and is neither
+   * compressed nor checksummed.  A page changed in place would not match its
+   * checksum until written back, so pages of files with checksums are copied.
+   */
+  bool mapped() const {
+    return stream_->config().backend == FileIoConfig::MAPPED &&
+        !compressed() && !checksums();
+  }
+
+  /**
+   * Returns the settings the file is read and written with.
+   */
+  const FileIoConfig& io_config() const { return stream_->config(); }
+
   /**
    * Returns an iterator at the first page in the file.
    *
@@ -201,10 +433,35 @@ class File {
    * @param page_number   Number of page.
    * @return  Position of page in file.
    */
-  static std::streampos pagePosition(const PageId page_number) {
-    return sizeof(FileHeader) + ((page_number - 1) * Page::SIZE);
+  std::streamoff pagePosition(const PageId page_number) const {
+    return dataOffset() + ((page_number - 1) * storedPageSize());
+  }
+
+  /**
+   * Returns the number of bytes each page of an uncompressed file takes:
+   * Page::SIZE, and its checksum if the file keeps them.
+   */
+  std::size_t storedPageSize() const {
+    return Page::SIZE + (checksums() ? sizeof(std::uint32_t) : 0);
+  }
+
+  /**
+   * Returns the position in the file of the first page, or of the first
+   * extent of a compressed file: right after the file header, or Page::SIZE
+   * bytes in if the file is aligned.
+   */
+  std::streamoff dataOffset() const {
+    return aligned() ? static_cast<std::streamoff>(Page::SIZE)
+                     : static_cast<std::streamoff>(sizeof(FileHeader));
   }
 
+  /**
+   * Returns true if the given flags are all known and can be combined.
+   *
+   * @param flags   Flags of a file.
+   */
+  static bool validFlags(const std::uint32_t flags);
+
   /**
    * Constructs a file object representing a file on the filesystem.
    * This method should not be called directly; instead use the static methods
@@ -214,12 +471,15 @@ class File {
    * @see File::open()
    * @param name        Name of file.
    * @param create_new  Whether to create a new file.
+   * @param flags       Flags of the new file, if create_new is true.
+   * @param config      How the file is read and written.
    * @throws  FileExistsException     If the underlying file exists and
    *                                  create_new is true.
    * @throws  FileNotFoundException   If the underlying file doesn't exist and
    *                                  create_new is false.
    */
-  File(const std::string& name, const bool create_new);
+  File(const std::string& name, const bool create_new,
+       const std::uint32_t flags, const FileIoConfig& config);
 
   /**
    * Opens the underlying file named in filename_.
@@ -227,26 +487,34 @@ class File {
    * the same filesystem file; otherwise, it reuses the existing stream.
    *
    * @param create_new  Whether to create a new file.
+   * @param config      How the file is read and written, if it is opened.
    * @throws  FileExistsException     If the underlying file exists and
    *                                  create_new is true.
    * @throws  FileNotFoundException   If the underlying file doesn't exist and
    *                                  create_new is false.
    */
-  void openIfNeeded(const bool create_new);
+  void openIfNeeded(const bool create_new,
+                    const FileIoConfig& config = FileIoConfig());
 
   /**
-   * Closes the underlying file stream in <stream_>.
-   * This method only closes the file if no other File objects exist that access
-   * the same file.
+   * Returns a lock on latch_ for reading pages, which is left unlocked if the
+   * stream allows concurrent reads and pages have fixed places in the file.
+   *
+   * @return  Lock for the read.
    */
-  void close();
+  std::unique_lock<std::recursive_mutex> lockForRead() const;
+
+  /**
+   * Syncs the file after an operation that changed it, if the file was opened
+   * with FileIoConfig::SYNC_ALWAYS.
+   */
+  void syncAfterChange();
 
   /**
    * Reads a page from the file.  If <allow_free> is not set, an exception
    * will be thrown if the page read from disk is not currently in use.
    *
-   * No bounds checking is performed; the underlying file stream will throw
-   * an exception if the page is past the end of the file.
+   * No bounds checking is performed beyond the read itself.
    *
    * @param page_number   Number of page to read.
    * @param allow_free    Whether to allow reading a free (unused) page.
@@ -256,6 +524,39 @@ class File {
    */
   Page readPage(const PageId page_number, const bool allow_free) const;
 
+  /**
+   * Reads the header and data of a page into the given page.  No bounds
+   * checking is performed beyond the read itself; a failed read leaves the
+   * stream usable.  The latch is not held if lockForRead() leaves it.
+   *
+   * @param page_number   Number of page to read.
+   * @param page          Page to overwrite with the page read.
+   * @return  False if the page could not be read in full.
+   * @throws  CorruptPageException  If the file keeps checksums and the page
+   *                                does not match its own.
+   */
+  bool readPageData(const PageId page_number, Page& page) const;
+
+  /**
+   * Returns the checksum of a page with the given header and data, which is
+   * never 0.
+   *
+   * @param header  Header of the page.
+   * @param data    Data area of the page.
+   * @return  Checksum of the page.
+   */
+  static std::uint32_t pageChecksum(const PageHeader& header, const char* data);
+
+  /**
+   * Returns false if the file keeps checksums and the page does not match the
+   * checksum stored with it.
+   *
+   * @param page      Page read from the file.
+   * @param checksum  Checksum read with the page.
+   * @return  Whether the page may be used.
+   */
+  bool checksumMatches(const Page& page, const std::uint32_t checksum) const;
+
   /**
    * Writes a page into the file at the given page number.  This does not
    * update ensure that the number in the header equals the position on disk.
@@ -279,19 +580,83 @@ class File {
                  const Page& new_page);
 
   /**
-   * Reads the header for this file from disk.
+   * Returns the header with which a page is written by writePage(): its own,
+   * except for the next page number, which is kept from disk.
+   *
+   * @param new_page  Page to write.
+   * @return  Header to write.
+   * @throws  InvalidPageException  If the page has been deleted since it was
+   *                                read.
+   */
+  PageHeader headerToWrite(const Page& new_page) const;
+
+  /**
+   * Returns the descriptor through which an IoEngine may read and write whole
+   * pages of this file at pagePosition(), or -1 if they have to go through
+   * readPage() and writePage() because the file is compressed, is mapped, or
+   * is not reached through a descriptor.
+   */
+  int pageDescriptor() const;
+
+  /**
+   * Prepares a page to be written by an IoEngine through pageDescriptor(), as
+   * writePage() would write it, and counts the write as in flight until
+   * endAsyncWrite().  Operations that change the page list or the file header
+   * wait for writes in flight, so that they are not overwritten.
+   *
+   * @param new_page  Page to write.
+   * @param checksum  Set to the checksum to store after the page, if the file
+   *                  keeps checksums.
+   * @return  Header to store with the page.
+   * @throws  InvalidPageException  If the page has been deleted since it was
+   *                                read.
+   */
+  PageHeader beginAsyncWrite(const Page& new_page, std::uint32_t& checksum);
+
+  /**
+   * Ends a write started with beginAsyncWrite().
+   */
+  void endAsyncWrite();
+
+  /**
+   * Checks a page read by an IoEngine through pageDescriptor() as readPage()
+   * checks the pages it reads.
+   *
+   * @param page_number   Number of page read.
+   * @param page          Page read.
+   * @param checksum      Checksum read after the page, if the file keeps them.
+   * @param complete      Whether the whole page, checksum included, could be
+   *                      read.
+   * @throws  InvalidPageException  If the page doesn't exist in the file or is
+   *                                not currently used.
+   * @throws  CorruptPageException  If the file keeps checksums and the page
+   *                                does not match its own.
+   */
+  void checkAsyncRead(const PageId page_number, const Page& page,
+                      const std::uint32_t checksum, const bool complete) const;
+
+  /**
+   * Returns the header for this file, read from disk the first time a File
+   * object for the file needs it.
    *
    * @return  The file header.
    */
   FileHeader readHeader() const;
 
   /**
-   * Writes the given header to the disk as the header for this file.
+   * Replaces the header for this file.  It reaches the disk when
+   * flushHeader() is next called.
    *
    * @param header  File header to write.
    */
   void writeHeader(const FileHeader& header);
 
+  /**
+   * Writes the header for this file to disk if it changed since it was last
+   * written.
+   */
+  void flushHeader() const;
+
   /**
    * Reads only the header of the given page from disk (not the record data
    * or slot table).  No bounds checking is performed.
@@ -301,9 +666,135 @@ class File {
    */
   PageHeader readPageHeader(const PageId page_number) const;
 
+  /**
+   * Builds the page-offset map of a compressed file by walking the pages
+   * stored in it, unless another File object for the same file already did.
+   */
+  void loadExtents();
+
+  /**
+   * Reads a page of a compressed file into the given page, decompressing its
+   * data.
+   *
+   * @param page_number   Number of page to read.
+   * @param page          Page to overwrite with the page read.
+   * @param checksum      Set to the checksum stored with the page, if the file
+   *                      keeps checksums.
+   * @return  False if the page is not in the file or cannot be decompressed.
+   */
+  bool readCompressedPage(const PageId page_number, Page& page,
+                          std::uint32_t& checksum) const;
+
+  /**
+   * Compresses a page and writes it into a compressed file.  The page is
+   * rewritten in place if it still fits in the space reserved for it, and is
+   * moved to free space of the size it needs otherwise.
+   *
+   * @param page_number Number of page whose contents to replace.
+   * @param header      Header of page to write.
+   * @param new_page    Page to write.
+   * @param checksum    Checksum to store after the data, if the file keeps
+   *                    checksums.
+   */
+  void writeCompressedPage(const PageId page_number, const PageHeader& header,
+                           const Page& new_page, const std::uint32_t checksum);
+
+  /**
+   * @brief Location of a page stored in a compressed file.
+   */
+  struct PageExtent {
+    /**
+     * Position of the page's CompressedPageHeader in the file; 0 if the page
+     * has not been written.
+     */
+    std::streamoff offset;
+
+    /**
+     * Bytes of the file reserved for the page.
+     */
+    std::uint32_t capacity;
+
+    /**
+     * Number of bytes of page data stored.
+     */
+    std::uint32_t data_length;
+  };
+
+  /**
+   * @brief Page-offset map of a compressed file, shared by all File objects
+   * for the file.
+   */
+  struct ExtentTable {
+    ExtentTable() : end(sizeof(FileHeader)), loaded(false) {}
+
+    /**
+     * Location of every page, by page number.
+     */
+    std::vector<PageExtent> extents;
+
+    /**
+     * Position after the last page stored, where moved pages go when no free
+     * space of their size is left.
+     */
+    std::streamoff end;
+
+    /**
+     * Positions of the space left behind by moved pages, by capacity in units
+     * of EXTENT_ALIGNMENT.
+     */
+    std::vector<std::vector<std::streamoff> > free_extents;
+
+    /**
+     * Whether the map has been built from the file.
+     */
+    bool loaded;
+  };
+
+  /**
+   * Adds the space of a page of a compressed file to the free space of its
+   * size, for a page that moves to take.
+   *
+   * @param extent  Space to free.
+   */
+  void freeExtent(const PageExtent& extent);
+
+  /**
+   * @brief File header of a file, kept in memory and shared by all File
+   * objects for the file.
+   */
+  struct HeaderCache {
+    HeaderCache() : num_pages(0), loaded(false), dirty(false) {}
+
+    /**
+     * The header, guarded by the file's latch.
+     */
+    FileHeader header;
+
+    /**
+     * Copy of header.num_pages, for checking page numbers without the latch.
+     */
+    std::atomic<PageId> num_pages;
+
+    /**
+     * Whether header has been read from the file.
+     */
+    bool loaded;
+
+    /**
+     * Whether header has changed since it was last written to the file.
+     */
+    bool dirty;
+  };
+
   typedef std::map<std::string,
-                   std::shared_ptr<std::fstream> > StreamMap;
+                   std::shared_ptr<FileIo> > StreamMap;
   typedef std::map<std::string, int> CountMap;
+  typedef std::map<std::string,
+                   std::shared_ptr<std::recursive_mutex> > LatchMap;
+  typedef std::map<std::string,
+                   std::shared_ptr<ExtentTable> > ExtentTableMap;
+  typedef std::map<std::string,
+                   std::shared_ptr<HeaderCache> > HeaderCacheMap;
 
   /**
    * Streams for opened files.
@@ -315,6 +806,27 @@ class File {
    */
   static CountMap open_counts_;
 
+  /**
+   * Latches for opened files.
+   */
+  static LatchMap open_latches_;
+
+  /**
+   * Page-offset maps for opened files; unused unless they are compressed.
+   */
+  static ExtentTableMap open_extent_tables_;
+
+  /**
+   * Headers of opened files.
+   */
+  static HeaderCacheMap open_headers_;
+
+  /**
+   * Guards open_streams_, open_counts_, open_latches_, open_extent_tables_
+   * and open_headers_.
+   */
+  static std::mutex registry_latch_;
+
   /**
    * Name of the file this object represents.
    */
@@ -323,10 +835,32 @@ class File {
   /**
    * Stream for underlying filesystem object.
    */
-  std::shared_ptr<std::fstream> stream_;
+  std::shared_ptr<FileIo> stream_;
+
+  /**
+   * Latch serializing access to stream_, shared by all File objects for the
+   * same underlying file.
+   */
+  std::shared_ptr<std::recursive_mutex> latch_;
+
+  /**
+   * Page-offset map of the file, guarded by latch_.
+   */
+  std::shared_ptr<ExtentTable> extent_table_;
+
+  /**
+   * Header of the file.
+   */
+  std::shared_ptr<HeaderCache> header_;
+
+  /**
+   * Flags the file was created with.
+   */
+  std::uint32_t flags_;
 
   friend class FileIterator;
   friend class FileTest;
+  friend class IoEngine;
 };
 
 }
@@ -0,0 +1,597 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#include "file_io.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+#include "exceptions/io_exception.h"
+
+namespace badgerdb {
+
+namespace {
+
+/**
+ * Opens the named file with open(), retrying when interrupted.
+ */
+int openDescriptor(const std::string& filename, const int flags) {
+  int fd;
+  do {
+    fd = ::open(filename.c_str(), flags, 0644);
+  } while (fd < 0 && errno == EINTR);
+  if (fd < 0) {
+    throw IoException(filename, "open", errno);
+  }
+  return fd;
+}
+
+/**
+ * Forces the data of the file behind a descriptor to stable storage.
+ */
+void syncDescriptor(const std::string& filename, const int fd) {
+  int result;
+  do {
+    result = ::fdatasync(fd);
+  } while (result < 0 && errno == EINTR);
+  if (result < 0) {
+    throw IoException(filename, "fdatasync", errno);
+  }
+}
+
+/**
+ * Returns the posix_fadvise() advice for an access pattern.
+ */
+int fileAdvice(const FileIoConfig::Access access) {
+  switch (access) {
+    case FileIoConfig::SEQUENTIAL:
+      return POSIX_FADV_SEQUENTIAL;
+    case FileIoConfig::RANDOM:
+      return POSIX_FADV_RANDOM;
+    case FileIoConfig::NORMAL:
+    default:
+      return POSIX_FADV_NORMAL;
+  }
+}
+
+/**
+ * Returns the madvise() advice for an access pattern.
+ */
+int memoryAdvice(const FileIoConfig::Access access) {
+  switch (access) {
+    case FileIoConfig::SEQUENTIAL:
+      return MADV_SEQUENTIAL;
+    case FileIoConfig::RANDOM:
+      return MADV_RANDOM;
+    case FileIoConfig::NORMAL:
+    default:
+      return MADV_NORMAL;
+  }
+}
+
+/**
+ * @brief File reached through a std::fstream.
+ */
+class StreamFileIo : public FileIo {
+ public:
+  StreamFileIo(const std::string& filename, const bool create_new,
+               const FileIoConfig& config)
+      : FileIo(filename, config) {
+    std::ios_base::openmode mode =
+        std::fstream::in | std::fstream::out | std::fstream::binary;
+    if (create_new) {
+      // New files have to be truncated on open.
+      mode = mode | std::fstream::trunc;
+    }
+    stream_.open(filename_, mode);
+    if (!stream_) {
+      throw IoException(filename_, "open", errno);
+    }
+  }
+
+  ~StreamFileIo() {
+    if (config_.durability == FileIoConfig::SYNC_ON_CLOSE) {
+      try {
+        sync();
+      } catch (const IoException&) {
+      }
+    }
+  }
+
+  bool read(const std::streamoff offset, char* data,
+            const std::size_t length) {
+    stream_.seekg(offset, std::ios::beg);
+    stream_.read(data, length);
+    if (!stream_) {
+      // Past the end of the file.
+      stream_.clear();
+      return false;
+    }
+    return true;
+  }
+
+  void write(const std::streamoff offset, const Buffer* buffers,
+             const std::size_t count) {
+    stream_.seekp(offset, std::ios::beg);
+    for (std::size_t i = 0; i < count; ++i) {
+      stream_.write(buffers[i].data, buffers[i].length);
+    }
+    stream_.flush();
+    if (!stream_) {
+      stream_.clear();
+      throw IoException(filename_, "write", errno);
+    }
+  }
+
+  std::streamoff size() {
+    stream_.seekg(0, std::ios::end);
+    return stream_.tellg();
+  }
+
+  void sync() {
+    // A stream has no descriptor of its own to sync, but the data of a file
+    // is synced through any descriptor for it.
+    stream_.flush();
+    const int fd = openDescriptor(filename_, O_RDONLY);
+    try {
+      syncDescriptor(filename_, fd);
+    } catch (const IoException&) {
+      ::close(fd);
+      throw;
+    }
+    ::close(fd);
+  }
+
+  bool concurrent() const { return false; }
+
+ private:
+  std::fstream stream_;
+};
+
+/**
+ * @brief File reached through a descriptor with pread() and pwrite().
+ */
+class PositionalFileIo : public FileIo {
+ public:
+  PositionalFileIo(const std::string& filename, const bool create_new,
+                   const FileIoConfig& config, const int flags = 0)
+      : FileIo(filename, config),
+        fd_(openDescriptor(filename,
+                           O_RDWR | flags |
+                               (create_new ? O_CREAT | O_TRUNC : 0))) {
+    if (config_.access != FileIoConfig::NORMAL) {
+      // Only a hint; the file works the same if the kernel ignores it.
+      ::posix_fadvise(fd_, 0, 0, fileAdvice(config_.access));
+    }
+  }
+
+  ~PositionalFileIo() {
+    if (config_.durability == FileIoConfig::SYNC_ON_CLOSE) {
+      try {
+        sync();
+      } catch (const IoException&) {
+      }
+    }
+    ::close(fd_);
+  }
+
+  bool read(std::streamoff offset, char* data, std::size_t length) {
+    while (length > 0) {
+      const ssize_t done = ::pread(fd_, data, length, offset);
+      if (done < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        throw IoException(filename_, "pread", errno);
+      }
+      if (done == 0) {
+        // Past the end of the file.
+        return false;
+      }
+      data += done;
+      length -= done;
+      offset += done;
+    }
+    return true;
+  }
+
+  void write(std::streamoff offset, const Buffer* buffers,
+             const std::size_t count) {
+    std::vector<iovec> pending(count);
+    for (std::size_t i = 0; i < count; ++i) {
+      pending[i].iov_base = const_cast<char*>(buffers[i].data);
+      pending[i].iov_len = buffers[i].length;
+    }
+    // Everything normally goes out with the first call; a short write is
+    // resumed where it stopped.
+    std::size_t first = 0;
+    while (first < count) {
+      const ssize_t done =
+          ::pwritev(fd_, &pending[first], count - first, offset);
+      if (done < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        throw IoException(filename_, "pwritev", errno);
+      }
+      offset += done;
+      std::size_t left = done;
+      while (first < count && left >= pending[first].iov_len) {
+        left -= pending[first].iov_len;
+        ++first;
+      }
+      if (first < count) {
+        pending[first].iov_base =
+            static_cast<char*>(pending[first].iov_base) + left;
+        pending[first].iov_len -= left;
+      }
+    }
+  }
+
+  std::streamoff size() {
+    struct stat status;
+    if (::fstat(fd_, &status) < 0) {
+      throw IoException(filename_, "fstat", errno);
+    }
+    return status.st_size;
+  }
+
+  void sync() { syncDescriptor(filename_, fd_); }
+
+  bool concurrent() const { return true; }
+
+  int descriptor() const { return fd_; }
+
+ private:
+  const int fd_;
+};
+
+/**
+ * @brief File reached like PositionalFileIo, and also mapped into memory.
+ *
+ * The file is mapped in chunks as they are first needed, each overlapping the
+ * next by CHUNK_OVERLAP bytes so that any run of bytes that short lies wholly
+ * in one chunk.  Chunks stay in place until the file is closed, and may reach
+ * past the end of the file; bytes are only handed out once the file holds
+ * them.
+ */
+class MappedFileIo : public PositionalFileIo {
+ public:
+  MappedFileIo(const std::string& filename, const bool create_new,
+               const FileIoConfig& config)
+      : PositionalFileIo(filename, create_new, config),
+        size_(0) {
+    size_ = PositionalFileIo::size();
+  }
+
+  ~MappedFileIo() {
+    for (std::size_t i = 0; i < chunks_.size(); ++i) {
+      if (chunks_[i] == NULL) {
+        continue;
+      }
+      // Changes made in place have to be synced before they are unmapped;
+      // the base class syncs the rest.
+      if (config_.durability == FileIoConfig::SYNC_ON_CLOSE) {
+        ::msync(chunks_[i], CHUNK_SIZE + CHUNK_OVERLAP, MS_SYNC);
+      }
+      ::munmap(chunks_[i], CHUNK_SIZE + CHUNK_OVERLAP);
+    }
+  }
+
+  bool read(const std::streamoff offset, char* data,
+            const std::size_t length) {
+    const char* bytes = map(offset, length);
+    if (bytes == NULL) {
+      return PositionalFileIo::read(offset, data, length);
+    }
+    std::memcpy(data, bytes, length);
+    return true;
+  }
+
+  void write(const std::streamoff offset, const Buffer* buffers,
+             const std::size_t count) {
+    PositionalFileIo::write(offset, buffers, count);
+    std::streamoff end = offset;
+    for (std::size_t i = 0; i < count; ++i) {
+      end += buffers[i].length;
+    }
+    grow(end);
+  }
+
+  std::streamoff size() {
+    const std::streamoff size = PositionalFileIo::size();
+    grow(size);
+    return size;
+  }
+
+  void sync() {
+    std::vector<char*> chunks;
+    {
+      std::lock_guard<std::mutex> guard(chunks_latch_);
+      chunks = chunks_;
+    }
+    for (std::size_t i = 0; i < chunks.size(); ++i) {
+      if (chunks[i] != NULL &&
+          ::msync(chunks[i], CHUNK_SIZE + CHUNK_OVERLAP, MS_SYNC) < 0) {
+        throw IoException(filename_, "msync", errno);
+      }
+    }
+    PositionalFileIo::sync();
+  }
+
+  char* map(const std::streamoff offset, const std::size_t length) {
+    if (offset < 0 || length > CHUNK_OVERLAP) {
+      return NULL;
+    }
+    // The file may have been extended through another descriptor.
+    const std::streamoff end = offset + length;
+    if (end > size_ && end > size()) {
+      return NULL;
+    }
+
+    const std::size_t chunk = offset / CHUNK_SIZE;
+    std::lock_guard<std::mutex> guard(chunks_latch_);
+    if (chunk >= chunks_.size()) {
+      chunks_.resize(chunk + 1, NULL);
+    }
+    if (chunks_[chunk] == NULL) {
+      void* mapping = ::mmap(NULL, CHUNK_SIZE + CHUNK_OVERLAP,
+                             PROT_READ | PROT_WRITE, MAP_SHARED, descriptor(),
+                             static_cast<off_t>(chunk * CHUNK_SIZE));
+      if (mapping == MAP_FAILED) {
+        throw IoException(filename_, "mmap", errno);
+      }
+      if (config_.access != FileIoConfig::NORMAL) {
+        ::madvise(mapping, CHUNK_SIZE + CHUNK_OVERLAP,
+                  memoryAdvice(config_.access));
+      }
+      chunks_[chunk] = static_cast<char*>(mapping);
+    }
+    return chunks_[chunk] + (offset - chunk * CHUNK_SIZE);
+  }
+
+ private:
+  /**
+   * Bytes of the file starting a new chunk.
+   */
+  static const std::size_t CHUNK_SIZE = 64 << 20;
+
+  /**
+   * Bytes mapped past the end of each chunk, which are also the start of the
+   * next one.
+   */
+  static const std::size_t CHUNK_OVERLAP = 64 << 10;
+
+  /**
+   * Records that the file is at least the given number of bytes long.
+   */
+  void grow(const std::streamoff end) {
+    std::streamoff known = size_;
+    while (end > known && !size_.compare_exchange_weak(known, end)) {
+    }
+  }
+
+  /**
+   * Bytes known to be in the file.
+   */
+  std::atomic<std::streamoff> size_;
+
+  /**
+   * Mappings of the chunks mapped so far, NULL for the others.
+   */
+  std::vector<char*> chunks_;
+
+  /**
+   * Guards chunks_.
+   */
+  std::mutex chunks_latch_;
+};
+
+/**
+ * @brief File reached like PositionalFileIo, through a descriptor opened with
+ *        O_DIRECT.
+ *
+ * O_DIRECT needs the offset, length and memory of every transfer to be whole
+ * blocks.  Transfers that are not go through an aligned copy of the blocks
+ * they touch.  Writes of part of a block read the rest of it first, one at a
+ * time, so that writes of neighbouring bytes do not undo each other.
+ */
+class DirectFileIo : public PositionalFileIo {
+ public:
+  DirectFileIo(const std::string& filename, const bool create_new,
+               const FileIoConfig& config)
+      : PositionalFileIo(filename, create_new, config, O_DIRECT) {
+  }
+
+  bool read(const std::streamoff offset, char* data,
+            const std::size_t length) {
+    if (aligned(offset, data, length)) {
+      return readBlocks(offset, data, length) == length;
+    }
+    const std::streamoff start = blockStart(offset);
+    const std::streamoff end = blockStart(offset + length + BLOCK_SIZE - 1);
+    AlignedBuffer blocks(filename_, end - start);
+    const std::size_t done = readBlocks(start, blocks.data, end - start);
+    if (start + static_cast<std::streamoff>(done) <
+        offset + static_cast<std::streamoff>(length)) {
+      // Past the end of the file.
+      return false;
+    }
+    std::memcpy(data, blocks.data + (offset - start), length);
+    return true;
+  }
+
+  void write(const std::streamoff offset, const Buffer* buffers,
+             const std::size_t count) {
+    std::size_t length = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+      length += buffers[i].length;
+    }
+    if (count == 1 && aligned(offset, buffers[0].data, length)) {
+      PositionalFileIo::write(offset, buffers, count);
+      return;
+    }
+
+    const std::streamoff start = blockStart(offset);
+    const std::streamoff end = blockStart(offset + length + BLOCK_SIZE - 1);
+    AlignedBuffer blocks(filename_, end - start);
+    char* const last = blocks.data + (end - start - BLOCK_SIZE);
+    std::lock_guard<std::mutex> guard(partial_latch_);
+    if (offset != start) {
+      readBlock(start, blocks.data);
+    }
+    if (offset + static_cast<std::streamoff>(length) != end &&
+        (last != blocks.data || offset == start)) {
+      readBlock(end - BLOCK_SIZE, last);
+    }
+    char* next = blocks.data + (offset - start);
+    for (std::size_t i = 0; i < count; ++i) {
+      std::memcpy(next, buffers[i].data, buffers[i].length);
+      next += buffers[i].length;
+    }
+    const Buffer whole = {blocks.data, static_cast<std::size_t>(end - start)};
+    PositionalFileIo::write(start, &whole, 1);
+  }
+
+  int descriptor() const {
+    // Transfers through the descriptor have to be aligned, which io_uring
+    // requests for pages are not.
+    return -1;
+  }
+
+ private:
+  /**
+   * Size of a block, to which transfers are aligned.  Pages of File::ALIGNED
+   * files are whole blocks.
+   */
+  static const std::size_t BLOCK_SIZE = 4096;
+
+  /**
+   * @brief Memory aligned to a block, freed when it goes out of scope.
+   */
+  struct AlignedBuffer {
+    AlignedBuffer(const std::string& filename, const std::size_t length) {
+      void* memory;
+      const int result = ::posix_memalign(&memory, BLOCK_SIZE, length);
+      if (result != 0) {
+        throw IoException(filename, "posix_memalign", result);
+      }
+      data = static_cast<char*>(memory);
+    }
+
+    ~AlignedBuffer() { std::free(data); }
+
+    char* data;
+
+   private:
+    AlignedBuffer(const AlignedBuffer&);
+    AlignedBuffer& operator=(const AlignedBuffer&);
+  };
+
+  /**
+   * Returns the offset of the block holding the given byte.
+   */
+  static std::streamoff blockStart(const std::streamoff offset) {
+    return offset / BLOCK_SIZE * BLOCK_SIZE;
+  }
+
+  /**
+   * Returns true if a transfer may go straight to the descriptor.
+   */
+  static bool aligned(const std::streamoff offset, const char* data,
+                      const std::size_t length) {
+    return offset % BLOCK_SIZE == 0 && length % BLOCK_SIZE == 0 &&
+        reinterpret_cast<std::uintptr_t>(data) % BLOCK_SIZE == 0;
+  }
+
+  /**
+   * Reads whole blocks into aligned memory, stopping at the end of the file.
+   *
+   * @return  Number of bytes read.
+   */
+  std::size_t readBlocks(const std::streamoff offset, char* data,
+                         const std::size_t length) {
+    std::size_t done = 0;
+    while (done < length) {
+      const ssize_t got = ::pread(PositionalFileIo::descriptor(), data + done,
+                                  length - done, offset + done);
+      if (got < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        throw IoException(filename_, "pread", errno);
+      }
+      done += got;
+      if (got == 0 || got % BLOCK_SIZE != 0) {
+        // Only the end of the file cuts a read short of a whole block.
+        break;
+      }
+    }
+    return done;
+  }
+
+  /**
+   * Reads a block into aligned memory, with zeros for bytes past the end of
+   * the file.
+   */
+  void readBlock(const std::streamoff offset, char* data) {
+    const std::size_t done = readBlocks(offset, data, BLOCK_SIZE);
+    std::memset(data + done, 0, BLOCK_SIZE - done);
+  }
+
+  /**
+   * Serializes writes of part of a block.
+   */
+  std::mutex partial_latch_;
+};
+
+}
+
+void FileIo::beginWrite() {
+  std::lock_guard<std::mutex> guard(writes_latch_);
+  ++writes_in_flight_;
+}
+
+void FileIo::endWrite() {
+  std::lock_guard<std::mutex> guard(writes_latch_);
+  if (--writes_in_flight_ == 0) {
+    writes_done_.notify_all();
+  }
+}
+
+void FileIo::waitForWrites() {
+  std::unique_lock<std::mutex> lock(writes_latch_);
+  writes_done_.wait(lock, [this]() { return writes_in_flight_ == 0; });
+}
+
+FileIo* FileIo::open(const std::string& filename, const bool create_new,
+                     const FileIoConfig& config) {
+  switch (config.backend) {
+    case FileIoConfig::POSITIONAL:
+      return new PositionalFileIo(filename, create_new, config);
+    case FileIoConfig::MAPPED:
+      return new MappedFileIo(filename, create_new, config);
+    case FileIoConfig::DIRECT:
+      return new DirectFileIo(filename, create_new, config);
+    case FileIoConfig::STREAM:
+    default:
+      return new StreamFileIo(filename, create_new, config);
+  }
+}
+
+}
@@ -0,0 +1,309 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <ios>
+#include <mutex>
+#include <string>
+
+namespace badgerdb {
+
+/**
+ * @brief Settings of how a File reads and writes the underlying file.
+ *
+ * The settings of the first File object to open a file apply to every File
+ * object sharing it, until the last of them is closed.
+ */
+struct FileIoConfig {
+  /**
+   * Ways of reaching the underlying file.
+   */
+  enum Backend {
+    /**
+     * A std::fstream, which is positioned before every read and write and
+     * flushed after every write.  Operations on the file are serialized.
+     */
+    STREAM,
+
+    /**
+     * A file descriptor used with pread() and pwrite() at the offset of each
+     * page, with no user-space buffering.  Reads of pages of uncompressed
+     * files do not wait for other operations on the file.
+     */
+    POSITIONAL,
+
+    /**
+     * POSITIONAL, with the file also mapped into memory.  Reads are copied
+     * out of the mapping, and File::mapPage() hands out pages of files that
+     * are neither compressed nor checksummed in place, so that BufMgr does not
+     * copy them at all.  Writes go
+     * through pwrite(), except for changes made in place to mapped pages.
+     * Meant for read-mostly files.
+     */
+    MAPPED,
+
+    /**
+     * A file descriptor opened with O_DIRECT, so that pages are not cached by
+     * the kernel as well as by BufMgr.  Reads of whole blocks into aligned
+     * memory, such as of pages of File::ALIGNED files into buffer frames, go
+     * straight to the file; other reads and all writes go through an aligned
+     * copy, reading the blocks around bytes written part of.  The file may be
+     * left padded with zeros to a whole block.
+     */
+    DIRECT,
+  };
+
+  /**
+   * Ways the pages of the file are expected to be accessed, passed on to the
+   * kernel as a hint.
+   */
+  enum Access {
+    /**
+     * No particular order.
+     */
+    NORMAL,
+
+    /**
+     * In order; the kernel reads further ahead and drops pages sooner.
+     */
+    SEQUENTIAL,
+
+    /**
+     * At random; the kernel reads no further than asked for.
+     */
+    RANDOM,
+  };
+
+  /**
+   * Points at which written pages are forced to stable storage.
+   */
+  enum Durability {
+    /**
+     * Only when File::sync() is called, which BufMgr::flushFile() does.
+     */
+    SYNC_ON_REQUEST,
+
+    /**
+     * Also when the last File object for the file is closed.
+     */
+    SYNC_ON_CLOSE,
+
+    /**
+     * Also after every operation that changes the file.
+     */
+    SYNC_ALWAYS,
+  };
+
+  /**
+   * Way of reaching the underlying file.
+   */
+  Backend backend;
+
+  /**
+   * Points at which writes are made durable.
+   */
+  Durability durability;
+
+  /**
+   * Expected access pattern, given to posix_fadvise() for the descriptor
+   * backends and to madvise() for the mapping.  Ignored by the stream
+   * backend.
+   */
+  Access access;
+
+  /**
+   * Constructor of FileIoConfig class, with the stream backend synced on
+   * request and no access hint.
+   */
+  FileIoConfig()
+      : backend(STREAM),
+        durability(SYNC_ON_REQUEST),
+        access(NORMAL) {
+  }
+};
+
+/**
+ * @brief Reads and writes of the bytes of an underlying file at given
+ *        offsets, shared by all File objects for the file.
+ */
+class FileIo {
+ public:
+  /**
+   * @brief Bytes to be written, one of several written with a single call.
+   */
+  struct Buffer {
+    /**
+     * First byte.
+     */
+    const char* data;
+
+    /**
+     * Number of bytes.
+     */
+    std::size_t length;
+  };
+
+  /**
+   * Opens a file with the given backend.
+   *
+   * @param filename    Name of the file.
+   * @param create_new  Whether to create the file, truncating it.
+   * @param config      Backend and durability of the file.
+   * @return  The opened file, owned by the caller.
+   * @throws  IoException   If the file cannot be opened.
+   */
+  static FileIo* open(const std::string& filename, const bool create_new,
+                      const FileIoConfig& config);
+
+  /**
+   * Closes the file, syncing it first if its durability asks for it.
+   */
+  virtual ~FileIo() {}
+
+  /**
+   * Reads bytes of the file.
+   *
+   * @param offset  Position of the first byte in the file.
+   * @param data    Where to put the bytes.
+   * @param length  Number of bytes to read.
+   * @return  False if the file ends before all of them were read.
+   * @throws  IoException   If the read fails for another reason.
+   */
+  virtual bool read(const std::streamoff offset, char* data,
+                    const std::size_t length) = 0;
+
+  /**
+   * Writes the given buffers one after the other into the file.
+   *
+   * @param offset  Position of the first byte in the file.
+   * @param buffers Buffers to write.
+   * @param count   Number of buffers.
+   * @throws  IoException   If the write fails.
+   */
+  virtual void write(const std::streamoff offset, const Buffer* buffers,
+                     const std::size_t count) = 0;
+
+  /**
+   * Writes bytes into the file.
+   *
+   * @param offset  Position of the first byte in the file.
+   * @param data    Bytes to write.
+   * @param length  Number of bytes.
+   * @throws  IoException   If the write fails.
+   */
+  void write(const std::streamoff offset, const char* data,
+             const std::size_t length) {
+    const Buffer buffer = {data, length};
+    write(offset, &buffer, 1);
+  }
+
+  /**
+   * Returns the size of the file in bytes.
+   */
+  virtual std::streamoff size() = 0;
+
+  /**
+   * Forces everything written so far to stable storage.
+   *
+   * @throws  IoException   If the file cannot be synced.
+   */
+  virtual void sync() = 0;
+
+  /**
+   * Returns true if read() and write() may be called from several threads at
+   * once, as long as they do not touch the same bytes.
+   */
+  virtual bool concurrent() const = 0;
+
+  /**
+   * Returns the file descriptor of the file, for I/O submitted elsewhere, or
+   * -1 if it is not reached through one.
+   */
+  virtual int descriptor() const { return -1; }
+
+  /**
+   * Returns the bytes of the file at the given offset in its mapping, which
+   * stay in place until the file is closed.  Changes made to them change the
+   * file.
+   *
+   * @param offset  Position of the first byte in the file.
+   * @param length  Number of bytes wanted, all of which must be in the file.
+   * @return  The first byte, or NULL if the file is not mapped, does not
+   *          extend that far, or the bytes are not mapped contiguously.
+   */
+  virtual char* map(const std::streamoff offset, const std::size_t length) {
+    return NULL;
+  }
+
+  /**
+   * Counts a write submitted elsewhere through descriptor() as in flight
+   * until endWrite() is called.
+   */
+  void beginWrite();
+
+  /**
+   * Counts a write started with beginWrite() as done.
+   */
+  void endWrite();
+
+  /**
+   * Waits until no write started with beginWrite() is in flight.
+   */
+  void waitForWrites();
+
+  /**
+   * Returns the settings the file was opened with.
+   */
+  const FileIoConfig& config() const { return config_; }
+
+ protected:
+  /**
+   * Constructs the file.
+   *
+   * @param filename  Name of the file.
+   * @param config    Backend and durability of the file.
+   */
+  FileIo(const std::string& filename, const FileIoConfig& config)
+      : filename_(filename),
+        config_(config),
+        writes_in_flight_(0) {
+  }
+
+  /**
+   * Name of the file.
+   */
+  const std::string filename_;
+
+  /**
+   * Settings the file was opened with.
+   */
+  const FileIoConfig config_;
+
+ private:
+  FileIo(const FileIo&);
+  FileIo& operator=(const FileIo&);
+
+  /**
+   * Number of writes started with beginWrite() and not ended yet.
+   */
+  int writes_in_flight_;
+
+  /**
+   * Guards writes_in_flight_.
+   */
+  std::mutex writes_latch_;
+
+  /**
+   * Signalled when writes_in_flight_ drops to 0.
+   */
+  std::condition_variable writes_done_;
+};
+
+}
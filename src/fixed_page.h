@@ -0,0 +1,365 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#include <utility>
+
+#include "exceptions/insufficient_space_exception.h"
+#include "exceptions/invalid_record_exception.h"
+#include "page.h"
+#include "record_view.h"
+#include "types.h"
+
+namespace badgerdb {
+
+/**
+ * @brief Metadata at the start of the data area of a page laid out as a
+ * FixedPage.
+ */
+struct FixedPageHeader {
+  /**
+   * Size in bytes of every record on the page.
+   */
+  std::uint16_t record_size;
+
+  /**
+   * Number of records currently on the page.
+   */
+  std::uint16_t num_records;
+
+  /**
+   * Index of the first record position which may be unused.  All positions
+   * before it are in use.
+   */
+  std::uint16_t first_free;
+};
+
+/**
+ * @brief Layout of a Page holding records of one fixed size.
+ *
+ * The data area of the page holds a FixedPageHeader, a bitmap with one bit per
+ * record position, and the records themselves back to back, with no slot
+ * directory.  Record n (slot number n + 1 of its RecordId) lies at a fixed
+ * offset, so finding it is plain arithmetic.
+ *
+ * A FixedPage is a view over a Page; the page stays the unit File and BufMgr
+ * deal in, so fixed-length pages are allocated, pinned, read, and written
+ * exactly like slotted ones.  Call format() once on a newly allocated page,
+ * then construct a FixedPage over it whenever it is accessed.  The slotted
+ * record methods of Page must not be used on such a page; format() leaves it
+ * with no free space and no slots as far as they are concerned.
+ *
+ * @warning This class is not threadsafe.
+ */
+template <std::size_t RecordSize>
+class FixedPage {
+ public:
+  /**
+   * Maximum number of records on a page.
+   */
+  static const std::size_t CAPACITY =
+      (8 * (Page::DATA_SIZE - sizeof(FixedPageHeader)) - 7) /
+      (8 * RecordSize + 1);
+
+  /**
+   * Size of the record bitmap in bytes.
+   */
+  static const std::size_t BITMAP_SIZE = (CAPACITY + 7) / 8;
+
+  /**
+   * Offset of the first record in the data area of the page.
+   */
+  static const std::size_t RECORDS_OFFSET =
+      sizeof(FixedPageHeader) + BITMAP_SIZE;
+
+  static_assert(RecordSize > 0, "Records must not be empty.");
+  static_assert(CAPACITY > 0, "Page must be able to hold a record.");
+  static_assert(CAPACITY <= std::numeric_limits<SlotId>::max(),
+                "Record positions must fit in a slot number.");
+  static_assert(RECORDS_OFFSET + CAPACITY * RecordSize <= Page::DATA_SIZE,
+                "Records must fit in the data area of the page.");
+
+  /**
+   * @brief Iterator over the records of a FixedPage, yielding record IDs and
+   * views of the records like RecordViewIterator.
+   */
+  class Iterator {
+   public:
+    /**
+     * Record ID and view of its bytes.
+     */
+    typedef std::pair<RecordId, RecordView> value_type;
+
+    Iterator(const FixedPage& page, const SlotId slot_number)
+        : page_(page),
+          slot_number_(slot_number) {
+    }
+
+    Iterator& operator++() {
+      slot_number_ = page_.nextUsedSlot(slot_number_);
+      return *this;
+    }
+
+    bool operator==(const Iterator& rhs) const {
+      return slot_number_ == rhs.slot_number_;
+    }
+
+    bool operator!=(const Iterator& rhs) const {
+      return slot_number_ != rhs.slot_number_;
+    }
+
+    value_type operator*() const {
+      const RecordId record_id = {page_.page_number(), slot_number_};
+      return value_type(record_id,
+                        RecordView(page_.record(slot_number_ - 1), RecordSize));
+    }
+
+   private:
+    /**
+     * Page we're iterating over.
+     */
+    FixedPage page_;
+
+    /**
+     * Slot number of the current record, or Page::INVALID_SLOT at the end.
+     */
+    SlotId slot_number_;
+  };
+
+  /**
+   * Lays out the given page to hold records of RecordSize bytes, discarding
+   * any records on it.  The page's number and its place in the file are kept.
+   *
+   * @param page  Page to lay out.
+   * @return  View of the page.
+   */
+  static FixedPage format(Page* page) {
+    page->header_.free_space_lower_bound = Page::DATA_SIZE;
+    page->header_.free_space_upper_bound = Page::DATA_SIZE;
+    page->header_.num_slots = 0;
+    page->header_.num_free_slots = 0;
+    page->header_.fragmented_bytes = 0;
+    page->header_.first_free_slot = Page::INVALID_SLOT;
+    std::memset(page->data_, 0, Page::DATA_SIZE);
+    FixedPageHeader* header = reinterpret_cast<FixedPageHeader*>(page->data_);
+    header->record_size = RecordSize;
+    return FixedPage(page);
+  }
+
+  /**
+   * Constructs a view of a page laid out by format().
+   *
+   * @param page  Page to view.
+   */
+  explicit FixedPage(Page* page)
+      : page_(page) {
+    assert(header().record_size == RecordSize);
+  }
+
+  /**
+   * Inserts a new record into the page, at the first unused position.
+   *
+   * @param record_data  RecordSize bytes that compose the record.
+   * @return  ID of the newly inserted record.
+   * @throws  InsufficientSpaceException  Thrown if the page is full.
+   */
+  RecordId insertRecord(const char* record_data) {
+    FixedPageHeader& page_header = header();
+    if (page_header.num_records == CAPACITY) {
+      throw InsufficientSpaceException(page_number(), RecordSize, 0);
+    }
+    // Every position before the hint is used, so the first byte with a clear
+    // bit holds the first unused position.
+    std::size_t byte = page_header.first_free / 8;
+    while (bitmap()[byte] == 0xff) {
+      ++byte;
+    }
+    std::size_t index = byte * 8;
+    while (bitmap()[byte] & (1 << (index % 8))) {
+      ++index;
+    }
+    bitmap()[byte] |= 1 << (index % 8);
+    ++page_header.num_records;
+    page_header.first_free = index + 1;
+    std::memcpy(record(index), record_data, RecordSize);
+    return {page_number(), static_cast<SlotId>(index + 1)};
+  }
+
+  /**
+   * Returns a pointer to the RecordSize bytes of the record with the given ID.
+   * The pointer is valid while the page stays pinned and the record is not
+   * deleted.
+   *
+   * @param record_id  ID of the record to return.
+   * @return  The record.
+   * @throws  InvalidRecordException  Thrown if the ID does not refer to a
+   *                                  record on this page.
+   */
+  const char* getRecord(const RecordId& record_id) const {
+    validateRecordId(record_id);
+    return record(record_id.slot_number - 1);
+  }
+
+  /**
+   * Returns a view of the record with the given ID.
+   *
+   * @see getRecord
+   * @param record_id  ID of the record to return.
+   * @return  View of the record.
+   */
+  RecordView getRecordView(const RecordId& record_id) const {
+    return RecordView(getRecord(record_id), RecordSize);
+  }
+
+  /**
+   * Replaces the data of the record with the given ID.
+   *
+   * @param record_id    ID of record to update.
+   * @param record_data  RecordSize bytes that compose the updated record.
+   * @throws  InvalidRecordException  Thrown if the ID does not refer to a
+   *                                  record on this page.
+   */
+  void updateRecord(const RecordId& record_id, const char* record_data) {
+    validateRecordId(record_id);
+    std::memmove(record(record_id.slot_number - 1), record_data, RecordSize);
+  }
+
+  /**
+   * Deletes the record with the given ID.  Its position is reused by later
+   * inserts.
+   *
+   * @param record_id   ID of the record to delete.
+   * @throws  InvalidRecordException  Thrown if the ID does not refer to a
+   *                                  record on this page.
+   */
+  void deleteRecord(const RecordId& record_id) {
+    validateRecordId(record_id);
+    const std::size_t index = record_id.slot_number - 1;
+    bitmap()[index / 8] &= ~(1 << (index % 8));
+    std::memset(record(index), 0, RecordSize);
+    FixedPageHeader& page_header = header();
+    --page_header.num_records;
+    if (index < page_header.first_free) {
+      page_header.first_free = index;
+    }
+  }
+
+  /**
+   * Returns true if the page has room for another record.
+   *
+   * @return  Whether the page can hold another record.
+   */
+  bool hasSpaceForRecord() const { return header().num_records < CAPACITY; }
+
+  /**
+   * Returns the number of records on the page.
+   *
+   * @return  Number of records.
+   */
+  std::size_t num_records() const { return header().num_records; }
+
+  /**
+   * Returns this page's number in its file.
+   *
+   * @return  Page number.
+   */
+  PageId page_number() const { return page_->page_number(); }
+
+  /**
+   * Returns the slot number of the first record after the given slot, or
+   * Page::INVALID_SLOT if there is none.
+   *
+   * @param slot_number   Slot to start search after; Page::INVALID_SLOT to
+   *                      start at the beginning.
+   * @return  Next used slot after given slot or Page::INVALID_SLOT.
+   */
+  SlotId nextUsedSlot(const SlotId slot_number) const {
+    // Slot n + 1 is record position n, so the next position is slot_number.
+    std::size_t index = slot_number;
+    while (index < CAPACITY) {
+      if ((index % 8) == 0 && bitmap()[index / 8] == 0) {
+        index += 8;
+      } else if (bitmap()[index / 8] & (1 << (index % 8))) {
+        return index + 1;
+      } else {
+        ++index;
+      }
+    }
+    return Page::INVALID_SLOT;
+  }
+
+  /**
+   * Returns an iterator at the first record in the page.
+   *
+   * @return  Iterator at first record of page.
+   */
+  Iterator begin() const {
+    return Iterator(*this, nextUsedSlot(Page::INVALID_SLOT));
+  }
+
+  /**
+   * Returns an iterator representing the record after the last record in the
+   * page.  This iterator should not be dereferenced.
+   *
+   * @return  Iterator representing record after the last record in the page.
+   */
+  Iterator end() const {
+    return Iterator(*this, Page::INVALID_SLOT);
+  }
+
+ private:
+  FixedPageHeader& header() const {
+    return *reinterpret_cast<FixedPageHeader*>(page_->data_);
+  }
+
+  unsigned char* bitmap() const {
+    return reinterpret_cast<unsigned char*>(
+        &page_->data_[sizeof(FixedPageHeader)]);
+  }
+
+  char* record(const std::size_t index) const {
+    return &page_->data_[RECORDS_OFFSET + index * RecordSize];
+  }
+
+  /**
+   * Throws an exception if the given record ID does not refer to a record on
+   * this page.
+   *
+   * @param record_id   Record ID to validate.
+   * @throws  InvalidRecordException  Thrown if the ID has a bad page or slot
+   *                                  number.
+   */
+  void validateRecordId(const RecordId& record_id) const {
+    const std::size_t index = record_id.slot_number - 1;
+    if (record_id.page_number != page_number() ||
+        record_id.slot_number == Page::INVALID_SLOT || index >= CAPACITY ||
+        !(bitmap()[index / 8] & (1 << (index % 8)))) {
+      throw InvalidRecordException(record_id, page_number());
+    }
+  }
+
+  /**
+   * Page being viewed.
+   */
+  Page* page_;
+};
+
+template <std::size_t RecordSize>
+const std::size_t FixedPage<RecordSize>::CAPACITY;
+
+template <std::size_t RecordSize>
+const std::size_t FixedPage<RecordSize>::BITMAP_SIZE;
+
+template <std::size_t RecordSize>
+const std::size_t FixedPage<RecordSize>::RECORDS_OFFSET;
+
+}
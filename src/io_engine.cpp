@@ -0,0 +1,582 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#include "io_engine.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define BADGERDB_IO_URING 1
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+#endif
+
+#include "exceptions/invalid_page_exception.h"
+#include "exceptions/io_exception.h"
+
+namespace badgerdb {
+
+namespace {
+
+/**
+ * @brief Engine running every request with File::readPage() or
+ *        File::writePage() on a pool of threads.
+ */
+class ThreadPoolEngine : public IoEngine {
+ public:
+  explicit ThreadPoolEngine(const std::uint32_t threads)
+      : stop_(false) {
+    for (std::uint32_t i = 0; i < threads; ++i) {
+      threads_.push_back(std::thread(&ThreadPoolEngine::run, this));
+    }
+  }
+
+  ~ThreadPoolEngine() {
+    {
+      std::lock_guard<std::mutex> guard(latch_);
+      stop_ = true;
+    }
+    work_.notify_all();
+    for (std::size_t i = 0; i < threads_.size(); ++i) {
+      threads_[i].join();
+    }
+  }
+
+  void submit(IoRequest* requests, const std::size_t count) {
+    {
+      std::lock_guard<std::mutex> guard(latch_);
+      for (std::size_t i = 0; i < count; ++i) {
+        requests[i].done = false;
+        requests[i].submitted = false;
+        requests[i].error = std::exception_ptr();
+        queue_.push_back(&requests[i]);
+      }
+    }
+    work_.notify_all();
+  }
+
+  void wait(IoRequest* requests, const std::size_t count) {
+    std::unique_lock<std::mutex> lock(latch_);
+    for (std::size_t i = 0; i < count; ++i) {
+      done_.wait(lock, [&requests, i]() { return requests[i].done; });
+    }
+  }
+
+  const char* name() const { return "thread pool"; }
+
+ private:
+  /**
+   * Body of the threads, running queued requests in order.
+   */
+  void run() {
+    std::unique_lock<std::mutex> lock(latch_);
+    for (;;) {
+      work_.wait(lock, [this]() { return stop_ || !queue_.empty(); });
+      if (queue_.empty()) {
+        return;
+      }
+      IoRequest* request = queue_.front();
+      queue_.pop_front();
+      lock.unlock();
+      execute(*request);
+      lock.lock();
+      request->done = true;
+      done_.notify_all();
+    }
+  }
+
+  std::vector<std::thread> threads_;
+
+  /**
+   * Requests not picked up by a thread yet.
+   */
+  std::deque<IoRequest*> queue_;
+
+  /**
+   * Tells the threads to exit once the queue is empty.
+   */
+  bool stop_;
+
+  /**
+   * Guards queue_, stop_ and the done flags of requests.
+   */
+  std::mutex latch_;
+
+  /**
+   * Wakes threads when requests are queued or they should exit.
+   */
+  std::condition_variable work_;
+
+  /**
+   * Signalled when a request is done.
+   */
+  std::condition_variable done_;
+};
+
+#if defined(BADGERDB_IO_URING)
+
+/**
+ * @brief Engine handing reads and writes of pages to io_uring.
+ *
+ * The rings are set up and driven with the io_uring system calls directly.
+ * Requests are queued in the submission ring under latch_ and handed to the
+ * kernel at the end of submit().  One waiting thread at a time blocks in the
+ * kernel for completions, with latch_ released; others wait for it to hand
+ * them theirs.
+ */
+class UringEngine : public IoEngine {
+ public:
+  /**
+   * Sets up a ring with room for the given number of requests.
+   *
+   * @return  The engine, or NULL if the kernel does not offer io_uring.
+   */
+  static UringEngine* open(const std::uint32_t entries) {
+    UringEngine* engine = new UringEngine();
+    if (!engine->setUp(entries)) {
+      delete engine;
+      return NULL;
+    }
+    return engine;
+  }
+
+  ~UringEngine() {
+    if (sqes_ != MAP_FAILED) {
+      ::munmap(sqes_, sqes_size_);
+    }
+    if (cq_ring_ != MAP_FAILED && cq_ring_ != sq_ring_) {
+      ::munmap(cq_ring_, cq_ring_size_);
+    }
+    if (sq_ring_ != MAP_FAILED) {
+      ::munmap(sq_ring_, sq_ring_size_);
+    }
+    if (ring_fd_ >= 0) {
+      ::close(ring_fd_);
+    }
+  }
+
+  void submit(IoRequest* requests, const std::size_t count) {
+    // Requests are prepared before latch_ is taken: preparing a write takes
+    // the latch of its file, which may be held by a thread waiting for the
+    // writes in flight, whose owners need latch_ to complete them.
+    for (std::size_t i = 0; i < count; ++i) {
+      requests[i].done = false;
+      requests[i].submitted = false;
+      requests[i].error = std::exception_ptr();
+    }
+    for (std::size_t i = 0; i < count; ++i) {
+      IoRequest& request = requests[i];
+      if (request.done || request.submitted) {
+        // Prepared with an earlier request for its file.
+        continue;
+      }
+      if (descriptor(request) < 0) {
+        execute(request);
+        request.done = true;
+        continue;
+      }
+      // All requests of the batch for the file are prepared under one hold
+      // of its latch.  Waiting for the latch again with some of their writes
+      // counted in flight would deadlock with a thread that holds it while
+      // waiting for those writes, such as File::allocatePage().
+      std::unique_lock<std::recursive_mutex> file_latch = lockFile(request);
+      for (std::size_t j = i; j < count; ++j) {
+        IoRequest& other = requests[j];
+        if (other.file != request.file || other.done || other.submitted ||
+            descriptor(other) < 0) {
+          continue;
+        }
+        if (prepare(other)) {
+          other.submitted = true;
+        } else {
+          other.done = true;
+        }
+      }
+    }
+
+    std::unique_lock<std::mutex> lock(latch_);
+    for (std::size_t i = 0; i < count; ++i) {
+      if (!requests[i].submitted) {
+        continue;
+      }
+      while (in_flight_ + queued_ >= capacity_) {
+        reap(lock);
+      }
+      queue(requests[i]);
+    }
+    enter(lock, false /* wait */);
+  }
+
+  void wait(IoRequest* requests, const std::size_t count) {
+    {
+      std::unique_lock<std::mutex> lock(latch_);
+      for (std::size_t i = 0; i < count; ++i) {
+        while (!requests[i].done) {
+          reap(lock);
+        }
+      }
+    }
+    for (std::size_t i = 0; i < count; ++i) {
+      if (requests[i].submitted) {
+        finish(requests[i]);
+      }
+    }
+    syncWrites(requests, count);
+  }
+
+  const char* name() const { return "io_uring"; }
+
+ private:
+  UringEngine()
+      : ring_fd_(-1),
+        sq_ring_(MAP_FAILED),
+        sq_ring_size_(0),
+        cq_ring_(MAP_FAILED),
+        cq_ring_size_(0),
+        sqes_(static_cast<io_uring_sqe*>(MAP_FAILED)),
+        sqes_size_(0),
+        capacity_(0),
+        queued_(0),
+        in_flight_(0),
+        reaping_(false) {
+  }
+
+  bool setUp(const std::uint32_t entries) {
+    io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    ring_fd_ = static_cast<int>(::syscall(__NR_io_uring_setup,
+                                          entries < 1 ? 1 : entries, &params));
+    if (ring_fd_ < 0) {
+      return false;
+    }
+    sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_ring_size_ =
+        params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    const bool single = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single) {
+      sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+    }
+    sq_ring_ = ::mmap(NULL, sq_ring_size_, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQ_RING);
+    if (sq_ring_ == MAP_FAILED) {
+      return false;
+    }
+    cq_ring_ = single ? sq_ring_
+                      : ::mmap(NULL, cq_ring_size_, PROT_READ | PROT_WRITE,
+                               MAP_SHARED | MAP_POPULATE, ring_fd_,
+                               IORING_OFF_CQ_RING);
+    if (cq_ring_ == MAP_FAILED) {
+      return false;
+    }
+    sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+    sqes_ = static_cast<io_uring_sqe*>(
+        ::mmap(NULL, sqes_size_, PROT_READ | PROT_WRITE,
+               MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQES));
+    if (sqes_ == MAP_FAILED) {
+      return false;
+    }
+
+    char* sq = static_cast<char*>(sq_ring_);
+    sq_tail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    sq_mask_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    sq_array_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    char* cq = static_cast<char*>(cq_ring_);
+    cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    cq_mask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+    // The completion ring is at least as large as the submission ring, so
+    // it cannot overflow while no more than this many are in flight.
+    capacity_ = params.sq_entries;
+    return true;
+  }
+
+  /**
+   * Puts a prepared request into the submission ring.  Called with latch_
+   * held.
+   */
+  void queue(IoRequest& request) {
+    const unsigned tail = *sq_tail_;
+    const unsigned index = tail & sq_mask_;
+    io_uring_sqe& sqe = sqes_[index];
+    std::memset(&sqe, 0, sizeof(sqe));
+    sqe.opcode = request.op == IoRequest::READ ? IORING_OP_READV
+                                               : IORING_OP_WRITEV;
+    sqe.fd = descriptor(request);
+    sqe.off = position(request);
+    sqe.addr = reinterpret_cast<std::uint64_t>(request.buffers);
+    sqe.len = request.num_buffers;
+    sqe.user_data = reinterpret_cast<std::uint64_t>(&request);
+    sq_array_[index] = index;
+    __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+    ++queued_;
+  }
+
+  /**
+   * Hands queued requests to the kernel and, if asked to, waits for at least
+   * one completion.  Called with latch_ held, which is released while
+   * waiting.
+   *
+   * @return  False if the call was interrupted or the kernel was busy.
+   */
+  bool enter(std::unique_lock<std::mutex>& lock, const bool wait) {
+    const unsigned to_submit = queued_;
+    // Nothing may be waited for if nothing is in flight.
+    const unsigned min_complete = wait && in_flight_ + to_submit > 0 ? 1 : 0;
+    if (to_submit == 0 && min_complete == 0) {
+      return true;
+    }
+    if (wait) {
+      lock.unlock();
+    }
+    const int submitted = static_cast<int>(::syscall(
+        __NR_io_uring_enter, ring_fd_, to_submit, min_complete,
+        min_complete > 0 ? IORING_ENTER_GETEVENTS : 0, NULL, 0));
+    const int error = errno;
+    if (wait) {
+      lock.lock();
+    }
+    if (submitted > 0) {
+      // Requests queued while the lock was released are handed over by a
+      // later call.
+      queued_ -= submitted;
+      in_flight_ += submitted;
+    }
+    if (submitted < 0 && error != EINTR && error != EAGAIN && error != EBUSY) {
+      throw IoException("io_uring", "io_uring_enter", error);
+    }
+    return submitted >= 0;
+  }
+
+  /**
+   * Marks the requests whose completions are in the completion ring as done.
+   * Called with latch_ held.
+   */
+  void collect() {
+    unsigned head = *cq_head_;
+    const unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+    while (head != tail) {
+      const io_uring_cqe& cqe = cqes_[head & cq_mask_];
+      IoRequest* request = reinterpret_cast<IoRequest*>(cqe.user_data);
+      request->result = cqe.res;
+      request->done = true;
+      --in_flight_;
+      ++head;
+    }
+    __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+  }
+
+  /**
+   * Waits for some requests to complete, in the kernel unless another thread
+   * already does.  Called with latch_ held.
+   */
+  void reap(std::unique_lock<std::mutex>& lock) {
+    collect();
+    if (reaping_) {
+      done_.wait(lock);
+      return;
+    }
+    reaping_ = true;
+    try {
+      enter(lock, true /* wait */);
+    } catch (...) {
+      reaping_ = false;
+      done_.notify_all();
+      throw;
+    }
+    reaping_ = false;
+    collect();
+    done_.notify_all();
+  }
+
+  int ring_fd_;
+  void* sq_ring_;
+  std::size_t sq_ring_size_;
+  void* cq_ring_;
+  std::size_t cq_ring_size_;
+  io_uring_sqe* sqes_;
+  std::size_t sqes_size_;
+  unsigned* sq_tail_;
+  unsigned sq_mask_;
+  unsigned* sq_array_;
+  unsigned* cq_head_;
+  unsigned* cq_tail_;
+  unsigned cq_mask_;
+  io_uring_cqe* cqes_;
+
+  /**
+   * Most requests queued or in flight at once.
+   */
+  unsigned capacity_;
+
+  /**
+   * Requests in the submission ring not handed to the kernel yet.
+   */
+  unsigned queued_;
+
+  /**
+   * Requests handed to the kernel whose completions were not collected yet.
+   */
+  unsigned in_flight_;
+
+  /**
+   * Whether a thread is waiting in the kernel for completions.
+   */
+  bool reaping_;
+
+  /**
+   * Guards the rings, the counts above and the done flags of requests.
+   */
+  std::mutex latch_;
+
+  /**
+   * Signalled when completions have been collected.
+   */
+  std::condition_variable done_;
+};
+
+#endif
+
+}
+
+IoEngine* IoEngine::create(const IoEngineConfig& config) {
+#if defined(BADGERDB_IO_URING)
+  if (config.kind == IoEngineConfig::AUTO) {
+    IoEngine* engine = UringEngine::open(config.queue_depth);
+    if (engine != NULL) {
+      return engine;
+    }
+  }
+#endif
+  return new ThreadPoolEngine(config.threads < 1 ? 1 : config.threads);
+}
+
+void IoEngine::execute(IoRequest& request) {
+  try {
+    if (request.op == IoRequest::READ) {
+      request.file->readPage(request.page_number, *request.page);
+    } else {
+      request.file->writePage(*request.page);
+    }
+  } catch (...) {
+    request.error = std::current_exception();
+  }
+}
+
+std::streamoff IoEngine::position(const IoRequest& request) {
+  return request.file->pagePosition(request.op == IoRequest::READ
+                                        ? request.page_number
+                                        : request.page->page_number());
+}
+
+bool IoEngine::prepare(IoRequest& request) {
+  // Pages are laid out in memory as on disk, header first.
+  char* page = reinterpret_cast<char*>(request.page);
+  if (request.op == IoRequest::READ) {
+    if (request.page_number == Page::INVALID_NUMBER) {
+      request.error = std::make_exception_ptr(
+          InvalidPageException(request.page_number, request.file->filename()));
+      return false;
+    }
+    request.buffers[0].iov_base = page;
+    request.buffers[0].iov_len = Page::SIZE;
+    request.buffers[1].iov_base = &request.checksum;
+    request.buffers[1].iov_len = sizeof(request.checksum);
+    request.num_buffers = request.file->checksums() ? 2 : 1;
+    return true;
+  }
+  try {
+    request.header =
+        request.file->beginAsyncWrite(*request.page, request.checksum);
+  } catch (...) {
+    request.error = std::current_exception();
+    return false;
+  }
+  request.buffers[0].iov_base = &request.header;
+  request.buffers[0].iov_len = sizeof(request.header);
+  request.buffers[1].iov_base = page + sizeof(PageHeader);
+  request.buffers[1].iov_len = Page::DATA_SIZE;
+  request.buffers[2].iov_base = &request.checksum;
+  request.buffers[2].iov_len = sizeof(request.checksum);
+  request.num_buffers = request.file->checksums() ? 3 : 2;
+  return true;
+}
+
+void IoEngine::finish(IoRequest& request) {
+  File& file = *request.file;
+  if (request.op == IoRequest::READ) {
+    if (request.result < 0) {
+      request.error = std::make_exception_ptr(
+          IoException(file.filename(), "read", -request.result));
+      return;
+    }
+    try {
+      file.checkAsyncRead(
+          request.page_number, *request.page, request.checksum,
+          request.result == static_cast<int>(file.storedPageSize()));
+    } catch (...) {
+      request.error = std::current_exception();
+    }
+    return;
+  }
+
+  try {
+    if (request.result < 0) {
+      throw IoException(file.filename(), "write", -request.result);
+    }
+    if (request.result < static_cast<int>(file.storedPageSize())) {
+      // Short writes are unusual enough to simply be redone in full.
+      FileIo::Buffer buffers[3];
+      for (int i = 0; i < request.num_buffers; ++i) {
+        buffers[i].data = static_cast<const char*>(request.buffers[i].iov_base);
+        buffers[i].length = request.buffers[i].iov_len;
+      }
+      file.stream_->write(position(request), buffers, request.num_buffers);
+    }
+  } catch (...) {
+    request.error = std::current_exception();
+  }
+  file.endAsyncWrite();
+}
+
+void IoEngine::syncWrites(IoRequest* requests, const std::size_t count) {
+  std::vector<File*> synced;
+  for (std::size_t i = 0; i < count; ++i) {
+    const IoRequest& request = requests[i];
+    // Writes run by execute() were synced by File::writePage().
+    if (request.op != IoRequest::WRITE || !request.submitted ||
+        request.error != NULL ||
+        std::find(synced.begin(), synced.end(), request.file) != synced.end()) {
+      continue;
+    }
+    synced.push_back(request.file);
+    try {
+      request.file->syncAfterChange();
+    } catch (...) {
+      const std::exception_ptr error = std::current_exception();
+      for (std::size_t j = i; j < count; ++j) {
+        if (requests[j].op == IoRequest::WRITE && requests[j].submitted &&
+            requests[j].file == request.file && requests[j].error == NULL) {
+          requests[j].error = error;
+        }
+      }
+    }
+  }
+}
+
+}
@@ -0,0 +1,305 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <sys/uio.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <ios>
+#include <mutex>
+
+#include "file.h"
+#include "page.h"
+#include "types.h"
+
+namespace badgerdb {
+
+/**
+ * @brief Settings of an IoEngine.
+ */
+struct IoEngineConfig {
+  /**
+   * Kinds of engine.
+   */
+  enum Kind {
+    /**
+     * io_uring if the kernel offers it, a thread pool otherwise.
+     */
+    AUTO,
+
+    /**
+     * Always a thread pool.
+     */
+    THREAD_POOL,
+  };
+
+  /**
+   * Kind of engine to create.
+   */
+  Kind kind;
+
+  /**
+   * Most requests in flight at once in io_uring; later submissions wait for
+   * earlier ones to complete.
+   */
+  std::uint32_t queue_depth;
+
+  /**
+   * Number of threads of the thread pool.
+   */
+  std::uint32_t threads;
+
+  /**
+   * Constructor of IoEngineConfig class, with io_uring if available, 128
+   * requests in flight and 4 threads.
+   */
+  IoEngineConfig()
+      : kind(AUTO),
+        queue_depth(128),
+        threads(4) {
+  }
+};
+
+/**
+ * @brief A page read or write submitted to an IoEngine.
+ *
+ * The caller fills in op, file and page, and page_number for reads, and keeps
+ * the request and the page in place until IoEngine::wait() returns for it.
+ */
+struct IoRequest {
+  /**
+   * Kinds of request.
+   */
+  enum Op {
+    /**
+     * Read page page_number of file into page, as File::readPage() does.
+     */
+    READ,
+
+    /**
+     * Write page into file, as File::writePage() does.
+     */
+    WRITE,
+  };
+
+  /**
+   * Kind of request.
+   */
+  Op op;
+
+  /**
+   * File to read from or write to.
+   */
+  File* file;
+
+  /**
+   * Number of page to read; unused by writes, which take it from the page.
+   */
+  PageId page_number;
+
+  /**
+   * Page to read into or write.
+   */
+  Page* page;
+
+  /**
+   * Exception the request failed with, null if it succeeded.  Set when
+   * IoEngine::wait() returns.
+   */
+  std::exception_ptr error;
+
+  /**
+   * Whether the engine has finished with the request.  Used by the engine.
+   */
+  bool done;
+
+  /**
+   * Whether the request was handed to the kernel.  Used by the engine.
+   */
+  bool submitted;
+
+  /**
+   * Result of the read or write system call: bytes transferred, or minus an
+   * error number.  Used by the engine.
+   */
+  int result;
+
+  /**
+   * Header stored with a page written through a descriptor.  Used by the
+   * engine.
+   */
+  PageHeader header;
+
+  /**
+   * Checksum read or written after the page, for a file which keeps them.
+   * Used by the engine.
+   */
+  std::uint32_t checksum;
+
+  /**
+   * Buffers read into or written from.  Used by the engine.
+   */
+  iovec buffers[3];
+
+  /**
+   * Number of buffers in use.  Used by the engine.
+   */
+  int num_buffers;
+
+  /**
+   * Constructor of IoRequest class, for a read of no page.
+   */
+  IoRequest()
+      : op(READ),
+        file(NULL),
+        page_number(Page::INVALID_NUMBER),
+        page(NULL),
+        done(false),
+        submitted(false),
+        result(0),
+        header(),
+        checksum(0),
+        buffers(),
+        num_buffers(0) {
+  }
+};
+
+/**
+ * @brief Asynchronous page reads and writes, keeping many of them in flight.
+ *
+ * Requests for uncompressed files opened with FileIoConfig::POSITIONAL go to
+ * io_uring, through its system calls, when the kernel offers it.  Others, and
+ * all requests when io_uring is not available, are run by File::readPage()
+ * and File::writePage(): in a thread pool, or at submission for io_uring.
+ *
+ * An engine may be used by several threads at once; each waits for its own
+ * requests.  A write through io_uring counts as in flight until wait()
+ * returns for it, and holds up File::allocatePage(), File::deletePage() and
+ * File::sync() on its file until then, so submitted requests should be waited
+ * for promptly.
+ */
+class IoEngine {
+ public:
+  /**
+   * Creates an engine.
+   *
+   * @param config  Kind and size of the engine.
+   * @return  The engine, owned by the caller.
+   */
+  static IoEngine* create(const IoEngineConfig& config = IoEngineConfig());
+
+  /**
+   * Destroys the engine.  No request may be in flight.
+   */
+  virtual ~IoEngine() {}
+
+  /**
+   * Starts requests.  Waits for earlier requests to complete while the
+   * engine has too many in flight.
+   *
+   * @param requests  Requests to start.
+   * @param count     Number of requests.
+   */
+  virtual void submit(IoRequest* requests, const std::size_t count) = 0;
+
+  /**
+   * Waits until the given requests, all submitted earlier, are complete, and
+   * sets their error.
+   *
+   * @param requests  Requests to wait for.
+   * @param count     Number of requests.
+   */
+  virtual void wait(IoRequest* requests, const std::size_t count) = 0;
+
+  /**
+   * Submits requests and waits for them.
+   *
+   * @param requests  Requests to run.
+   * @param count     Number of requests.
+   */
+  void run(IoRequest* requests, const std::size_t count) {
+    submit(requests, count);
+    wait(requests, count);
+  }
+
+  /**
+   * Returns the name of the engine: "io_uring" or "thread pool".
+   */
+  virtual const char* name() const = 0;
+
+ protected:
+  /**
+   * Runs a request with File::readPage() or File::writePage(), recording its
+   * error.
+   *
+   * @param request   Request to run.
+   */
+  static void execute(IoRequest& request);
+
+  /**
+   * Returns the descriptor through which the request's page may be read or
+   * written, or -1 if it has to be run with execute().
+   *
+   * @param request   Request to look at.
+   */
+  static int descriptor(const IoRequest& request) {
+    return request.file->pageDescriptor();
+  }
+
+  /**
+   * Returns the position of the request's page in its file.
+   *
+   * @param request   Request to look at.
+   */
+  static std::streamoff position(const IoRequest& request);
+
+  /**
+   * Locks the latch of the request's file, under which requests for the file
+   * are prepared.
+   *
+   * @param request   Request to look at.
+   * @return  Lock on the latch.
+   */
+  static std::unique_lock<std::recursive_mutex> lockFile(
+      const IoRequest& request) {
+    return std::unique_lock<std::recursive_mutex>(*request.file->latch_);
+  }
+
+  /**
+   * Prepares the buffers of a request before it is handed to the kernel.
+   *
+   * @param request   Request to prepare.
+   * @return  False if the request failed already; its error is set.
+   */
+  static bool prepare(IoRequest& request);
+
+  /**
+   * Sets the error of a request from the result of its system call, once the
+   * kernel has completed it.  A write is no longer in flight afterwards, but
+   * its file is not synced yet; see syncWrites().
+   *
+   * @param request   Request completed.
+   */
+  static void finish(IoRequest& request);
+
+  /**
+   * Syncs each file written by the given finished requests once, as
+   * File::writePage() does after every write, and sets the error of the
+   * file's writes if that fails.  Called once none of the requests is in
+   * flight, since syncing takes the latch of the file, which File::allocatePage()
+   * holds while it waits for the writes in flight.
+   *
+   * @param requests  Requests finished.
+   * @param count     Number of requests.
+   */
+  static void syncWrites(IoRequest* requests, const std::size_t count);
+};
+
+}
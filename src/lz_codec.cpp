@@ -0,0 +1,246 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#include "lz_codec.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+namespace badgerdb {
+
+namespace {
+
+/**
+ * Number of bits of the hash of the next MIN_MATCH bytes, which indexes the
+ * table of their last positions.
+ */
+const std::size_t HASH_BITS = 12;
+
+/**
+ * Longest back reference distance that can be encoded.
+ */
+const std::size_t MAX_DISTANCE = 65535;
+
+/**
+ * Nibble value which means that the length continues in the following bytes.
+ */
+const std::size_t LONG_LENGTH = 15;
+
+std::uint32_t load32(const unsigned char* p) {
+  std::uint32_t value;
+  std::memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+std::uint64_t load64(const unsigned char* p) {
+  std::uint64_t value;
+  std::memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+std::size_t hash(const std::uint32_t sequence) {
+  return (sequence * 2654435761u) >> (32 - HASH_BITS);
+}
+
+/**
+ * Returns the number of equal bytes at a and b, stopping at end, which bounds
+ * a.  b precedes a.
+ */
+std::size_t matchLength(const unsigned char* a, const unsigned char* b,
+                        const unsigned char* end) {
+  const unsigned char* start = a;
+  while (a + sizeof(std::uint64_t) <= end) {
+    const std::uint64_t difference = load64(a) ^ load64(b);
+    if (difference != 0) {
+      // The first differing byte is the lowest set one on little-endian
+      // machines.
+      return a - start + __builtin_ctzll(difference) / 8;
+    }
+    a += sizeof(std::uint64_t);
+    b += sizeof(std::uint64_t);
+  }
+  while (a < end && *a == *b) {
+    ++a;
+    ++b;
+  }
+  return a - start;
+}
+
+/**
+ * Appends the continuation bytes of a length whose nibble is LONG_LENGTH.
+ */
+unsigned char* writeLength(unsigned char* out, std::size_t length) {
+  length -= LONG_LENGTH;
+  while (length >= 255) {
+    *out++ = 255;
+    length -= 255;
+  }
+  *out++ = static_cast<unsigned char>(length);
+  return out;
+}
+
+/**
+ * Reads the continuation bytes of a length whose nibble is LONG_LENGTH and
+ * adds them to length.
+ */
+bool readLength(const unsigned char*& in, const unsigned char* end,
+                std::size_t& length) {
+  unsigned char byte;
+  do {
+    if (in == end) {
+      return false;
+    }
+    byte = *in++;
+    length += byte;
+  } while (byte == 255);
+  return true;
+}
+
+/**
+ * Appends a token of the given literals followed by a back reference, or by
+ * nothing if match_length is 0.
+ *
+ * @return  False if the token does not fit before out_end.
+ */
+bool writeToken(unsigned char*& out, const unsigned char* out_end,
+                const unsigned char* literals, const std::size_t num_literals,
+                const std::size_t distance, const std::size_t match_length) {
+  const std::size_t match_code =
+      match_length == 0 ? 0 : match_length - LzCodec::MIN_MATCH;
+  const std::size_t worst_case = 1 + num_literals / 255 + 1 + num_literals +
+      2 + match_code / 255 + 1;
+  if (worst_case > static_cast<std::size_t>(out_end - out)) {
+    return false;
+  }
+  unsigned char* token = out++;
+  *token = static_cast<unsigned char>(
+      std::min(num_literals, LONG_LENGTH) << 4 |
+      std::min(match_code, LONG_LENGTH));
+  if (num_literals >= LONG_LENGTH) {
+    out = writeLength(out, num_literals);
+  }
+  std::memcpy(out, literals, num_literals);
+  out += num_literals;
+  if (match_length != 0) {
+    *out++ = static_cast<unsigned char>(distance);
+    *out++ = static_cast<unsigned char>(distance >> 8);
+    if (match_code >= LONG_LENGTH) {
+      out = writeLength(out, match_code);
+    }
+  }
+  return true;
+}
+
+}
+
+const std::size_t LzCodec::MIN_MATCH;
+
+std::size_t LzCodec::compress(const char* source,
+                              const std::size_t source_size, char* dest,
+                              const std::size_t capacity) {
+  const unsigned char* const base =
+      reinterpret_cast<const unsigned char*>(source);
+  const unsigned char* const end = base + source_size;
+  unsigned char* out = reinterpret_cast<unsigned char*>(dest);
+  unsigned char* const out_end = out + capacity;
+
+  // Last position of each hashed sequence, plus one so that 0 means none.
+  std::uint32_t last_position[1 << HASH_BITS];
+  std::memset(last_position, 0, sizeof(last_position));
+
+  const unsigned char* in = base;
+  const unsigned char* literals = base;
+  while (source_size >= MIN_MATCH && in <= end - MIN_MATCH) {
+    const std::uint32_t sequence = load32(in);
+    std::uint32_t& slot = last_position[hash(sequence)];
+    const unsigned char* candidate = slot == 0 ? NULL : base + slot - 1;
+    slot = static_cast<std::uint32_t>(in - base + 1);
+    if (candidate != NULL && static_cast<std::size_t>(in - candidate) <=
+        MAX_DISTANCE && load32(candidate) == sequence) {
+      const std::size_t length =
+          MIN_MATCH + matchLength(in + MIN_MATCH, candidate + MIN_MATCH, end);
+      if (!writeToken(out, out_end, literals, in - literals, in - candidate,
+                      length)) {
+        return 0;
+      }
+      in += length;
+      literals = in;
+    } else {
+      // Step faster through data that keeps failing to match.
+      in += 1 + ((in - literals) >> 6);
+    }
+  }
+  if (!writeToken(out, out_end, literals, end - literals, 0, 0)) {
+    return 0;
+  }
+  return out - reinterpret_cast<unsigned char*>(dest);
+}
+
+bool LzCodec::decompress(const char* source, const std::size_t source_size,
+                         char* dest, const std::size_t dest_size) {
+  const unsigned char* in = reinterpret_cast<const unsigned char*>(source);
+  const unsigned char* const in_end = in + source_size;
+  unsigned char* const out_begin = reinterpret_cast<unsigned char*>(dest);
+  unsigned char* out = out_begin;
+  unsigned char* const out_end = out + dest_size;
+
+  for (;;) {
+    if (in == in_end) {
+      // Truncated before the last token.
+      return false;
+    }
+    const unsigned char token = *in++;
+    std::size_t num_literals = token >> 4;
+    if (num_literals == LONG_LENGTH && !readLength(in, in_end, num_literals)) {
+      return false;
+    }
+    if (num_literals > static_cast<std::size_t>(in_end - in) ||
+        num_literals > static_cast<std::size_t>(out_end - out)) {
+      return false;
+    }
+    std::memcpy(out, in, num_literals);
+    in += num_literals;
+    out += num_literals;
+    if (in == in_end) {
+      // The last token has no back reference.
+      return out == out_end;
+    }
+
+    if (in_end - in < 2) {
+      return false;
+    }
+    const std::size_t distance = in[0] | in[1] << 8;
+    in += 2;
+    std::size_t length = token & 0xf;
+    if (length == LONG_LENGTH && !readLength(in, in_end, length)) {
+      return false;
+    }
+    length += MIN_MATCH;
+    if (distance == 0 || distance > static_cast<std::size_t>(out - out_begin) ||
+        length > static_cast<std::size_t>(out_end - out)) {
+      return false;
+    }
+    const unsigned char* match = out - distance;
+    if (distance == 1) {
+      std::memset(out, *match, length);
+      out += length;
+    } else {
+      // Copy in pieces no longer than the distance so that no piece overlaps
+      // the bytes it is copied from.
+      while (length > 0) {
+        const std::size_t piece = std::min(length, distance);
+        std::memcpy(out, match, piece);
+        out += piece;
+        match += piece;
+        length -= piece;
+      }
+    }
+  }
+}
+
+}
@@ -0,0 +1,61 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+namespace badgerdb {
+
+/**
+ * @brief Small LZ77 compressor used for pages of compressed files.
+ *
+ * The output is a sequence of tokens, each made of a run of literal bytes
+ * followed by a back reference of at least MIN_MATCH bytes into the last 64KB
+ * of output, in the style of LZ4.  The last token has literals only.  A token
+ * byte holds the literal count in its high nibble and the match length less
+ * MIN_MATCH in its low nibble; a nibble of 15 is continued by bytes of 255
+ * until a smaller byte ends the count.  The back reference distance follows
+ * the literals as two little-endian bytes.
+ *
+ * Pages compress well because of the unused space between the slot directory
+ * and the records, which becomes a single overlapping back reference.
+ */
+class LzCodec {
+ public:
+  /**
+   * Shortest back reference that is encoded.
+   */
+  static const std::size_t MIN_MATCH = 4;
+
+  /**
+   * Compresses a buffer.
+   *
+   * @param source        Bytes to compress.
+   * @param source_size   Number of bytes to compress.
+   * @param dest          Buffer for the compressed bytes.
+   * @param capacity      Size of dest.
+   * @return  Number of compressed bytes, or 0 if they do not fit in dest.
+   */
+  static std::size_t compress(const char* source, const std::size_t source_size,
+                              char* dest, const std::size_t capacity);
+
+  /**
+   * Decompresses a buffer produced by compress().
+   *
+   * @param source      Compressed bytes.
+   * @param source_size Number of compressed bytes.
+   * @param dest        Buffer for the decompressed bytes.
+   * @param dest_size   Exact number of bytes expected.
+   * @return  False if the input is malformed or does not decompress to exactly
+   *          dest_size bytes.
+   */
+  static bool decompress(const char* source, const std::size_t source_size,
+                         char* dest, const std::size_t dest_size);
+};
+
+}
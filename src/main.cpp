@@ -13,16 +13,40 @@
 #include <stdlib.h>
 //#include <stdio.h>
 #include <cstring>
+#include <chrono>
+#include <fstream>
 #include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
 #include "page.h"
+#include "pax_page.h"
 #include "buffer.h"
+#include "bulk_loader.h"
+#include "replacement/clock_policy.h"
+#include "replacement/lru_k_policy.h"
+#include "replacement/two_q_policy.h"
+#include "replacement/arc_policy.h"
+#include "replacement/clock_pro_policy.h"
 #include "file_iterator.h"
+#include "crc32c.h"
+#include "fixed_page.h"
+#include "io_engine.h"
+#include "lz_codec.h"
 #include "page_iterator.h"
+#include "slot_scan.h"
 #include "exceptions/file_not_found_exception.h"
+#include "exceptions/file_version_exception.h"
 #include "exceptions/invalid_page_exception.h"
 #include "exceptions/page_not_pinned_exception.h"
 #include "exceptions/page_pinned_exception.h"
 #include "exceptions/buffer_exceeded_exception.h"
+#include "exceptions/corrupt_page_exception.h"
+#include "exceptions/hash_already_present_exception.h"
+#include "exceptions/hash_not_found_exception.h"
+#include "exceptions/invalid_flags_exception.h"
+#include "exceptions/invalid_record_exception.h"
+#include "exceptions/io_exception.h"
 
 #define PRINT_ERROR(str) \
 { \
@@ -47,6 +71,33 @@ void test3();
 void test4();
 void test5();
 void test6();
+void test7();
+void test8();
+void test9();
+void test10();
+void test11();
+void test12();
+void test13();
+void test14();
+void test15();
+void test16();
+void test17();
+void test18();
+void test19();
+void test20();
+void test21();
+void test22();
+void test23();
+void test24();
+void test25();
+void test26();
+void test27();
+void test28();
+void test29();
+void test30();
+void test31();
+void test32();
+void test33();
 void testBufMgr();
 
 int main() 
@@ -159,6 +210,33 @@ void testBufMgr()
 	test4();
 	test5();
 	test6();
+	test7();
+	test8();
+	test9();
+	test10();
+	test11();
+	test12();
+	test13();
+	test14();
+	test15();
+	test16();
+	test17();
+	test18();
+	test19();
+	test20();
+	test21();
+	test22();
+	test23();
+	test24();
+	test25();
+	test26();
+	test27();
+	test28();
+	test29();
+	test30();
+	test31();
+	test32();
+	test33();
 
 	//Close files before deleting them
 	file1.~File();
@@ -333,6 +411,2500 @@ void test6()
 	bufMgr->flushFile(file1ptr);
 }
 
-void test8(){
+void test7()
+{
+	//Several threads pin and read pages of file1 concurrently; every read must see the page's own record
+	const int numThreads = 4;
+	std::vector<std::thread> threads;
+	std::vector<int> mismatches(numThreads, 0);
+
+	for (int t = 0; t < numThreads; t++)
+	{
+		threads.push_back(std::thread([t, &mismatches]() {
+			Page* threadPage;
+			char expected[100];
+			for (PageId n = 0; n < 4 * num; n++)
+			{
+				const PageId pageNo = ((n * (t + 3)) % num) + 1;
+				bufMgr->readPage(file1ptr, pageNo, threadPage);
+				sprintf(expected, "test.1 Page %u %7.1f", pageNo, (float)pageNo);
+				const RecordId recordId = {pageNo, 1};
+				if(strncmp(threadPage->getRecord(recordId).c_str(), expected, strlen(expected)) != 0)
+					mismatches[t]++;
+				bufMgr->unPinPage(file1ptr, pageNo, false);
+			}
+		}));
+	}
+	for (int t = 0; t < numThreads; t++)
+	{
+		threads[t].join();
+		if (mismatches[t] != 0)
+		{
+			PRINT_ERROR("ERROR :: CONTENTS DID NOT MATCH");
+		}
+	}
+
+	bufMgr->flushFile(file1ptr);
+
+	std::cout << "Test 7 passed" << "\n";
+}
+
+void test8()
+{
+	//Every replacement policy must serve correct pages from a pool much smaller than the
+	//working set, and must report BufferExceeded once all of its frames are pinned
+	const std::uint32_t poolSize = 10;
+	ReplacementPolicy* policies[] = {new ClockPolicy(), new LruKPolicy(2), new TwoQPolicy(),
+	                                 new ArcPolicy(), new ClockProPolicy()};
+
+	for (ReplacementPolicy* policy : policies)
+	{
+		BufMgr policyMgr(poolSize, policy);
+
+		//A hot set of 5 pages interleaved with a scan over all pages, some unpinned dirty
+		for (PageId n = 0; n < 4 * num; n++)
+		{
+			const PageId pageNo = (n % 2 == 0) ? (n / 2) % 5 + 1 : (n / 2) % num + 1;
+			policyMgr.readPage(file1ptr, pageNo, page);
+			sprintf(tmpbuf, "test.1 Page %u %7.1f", pageNo, (float)pageNo);
+			const RecordId recordId = {pageNo, 1};
+			if(strncmp(page->getRecord(recordId).c_str(), tmpbuf, strlen(tmpbuf)) != 0)
+			{
+				PRINT_ERROR("ERROR :: CONTENTS DID NOT MATCH");
+			}
+			policyMgr.unPinPage(file1ptr, pageNo, n % 3 == 0);
+		}
+
+		if (policyMgr.getBufStats().hits == 0)
+		{
+			PRINT_ERROR("ERROR :: Hot pages were never found in the buffer pool.");
+		}
+
+		for (i = 1; i <= poolSize; i++)
+			policyMgr.readPage(file1ptr, i, page);
+
+		try
+		{
+			policyMgr.readPage(file1ptr, poolSize + 1, page);
+			PRINT_ERROR("ERROR :: No more frames left for allocation. Exception should have been thrown before execution reaches this point.");
+		}
+		catch(const BufferExceededException &e)
+		{
+		}
+
+		for (i = 1; i <= poolSize; i++)
+			policyMgr.unPinPage(file1ptr, i, false);
+
+		policyMgr.flushFile(file1ptr);
+	}
+
+	std::cout << "Test 8 passed" << "\n";
+}
+
+void test9()
+{
+	//The background writer must clean dirty unpinned pages, so that later misses find clean victims
+	const std::uint32_t poolSize = 20;
+	BufMgr writerMgr(poolSize);
+	BgWriterConfig config;
+	config.dirtyRatio = 0;
+	config.delayMs = 1;
+	writerMgr.startBackgroundWriter(config);
+
+	for (i = 1; i <= poolSize; i++)
+	{
+		writerMgr.readPage(file1ptr, i, page);
+		writerMgr.unPinPage(file1ptr, i, true);
+	}
+
+	//Wait for the writer to catch up
+	for (int wait = 0; wait < 5000 && writerMgr.getBufStats().bgwrites < (int)poolSize; wait++)
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	if (writerMgr.getBufStats().bgwrites != (int)poolSize)
+	{
+		PRINT_ERROR("ERROR :: Background writer did not clean the dirty pages.");
+	}
+
+	//Every eviction now finds a clean victim
+	for (i = poolSize + 1; i <= 2 * poolSize; i++)
+	{
+		writerMgr.readPage(file1ptr, i, page);
+		sprintf(tmpbuf, "test.1 Page %u %7.1f", i, (float)i);
+		const RecordId recordId = {i, 1};
+		if(strncmp(page->getRecord(recordId).c_str(), tmpbuf, strlen(tmpbuf)) != 0)
+		{
+			PRINT_ERROR("ERROR :: CONTENTS DID NOT MATCH");
+		}
+		writerMgr.unPinPage(file1ptr, i, false);
+	}
+	if (writerMgr.getBufStats().diskwrites != writerMgr.getBufStats().bgwrites)
+	{
+		PRINT_ERROR("ERROR :: A miss wrote back a dirty victim itself.");
+	}
+
+	writerMgr.stopBackgroundWriter();
+	writerMgr.flushFile(file1ptr);
+
+	std::cout << "Test 9 passed" << "\n";
+}
+
+void test10()
+{
+	//A sequential scan must be read ahead into unpinned frames; scattered reads must not
+	BufMgr scanMgr(50);
+	scanMgr.startReadAhead();
+
+	for (i = 1; i <= num; i++)
+	{
+		scanMgr.readPage(file1ptr, i, page);
+		sprintf(tmpbuf, "test.1 Page %u %7.1f", i, (float)i);
+		const RecordId recordId = {i, 1};
+		if(strncmp(page->getRecord(recordId).c_str(), tmpbuf, strlen(tmpbuf)) != 0)
+		{
+			PRINT_ERROR("ERROR :: CONTENTS DID NOT MATCH");
+		}
+		scanMgr.unPinPage(file1ptr, i, false);
+
+		//Give the read-ahead thread time to start
+		for (int wait = 0; i == 2 && wait < 5000 && scanMgr.getBufStats().prefetches == 0; wait++)
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	if (scanMgr.getBufStats().prefetchHits == 0)
+	{
+		PRINT_ERROR("ERROR :: Sequential scan was not read ahead.");
+	}
+
+	scanMgr.flushFile(file1ptr);
+	scanMgr.clearBufStats();
+	const PageId scattered[] = {50, 10, 70, 30, 90, 20};
+	for (PageId pageNo : scattered)
+	{
+		scanMgr.readPage(file1ptr, pageNo, page);
+		scanMgr.unPinPage(file1ptr, pageNo, false);
+	}
+	if (scanMgr.getBufStats().prefetches != 0)
+	{
+		PRINT_ERROR("ERROR :: Scattered reads were read ahead.");
+	}
+
+	scanMgr.stopReadAhead();
+	scanMgr.flushFile(file1ptr);
+
+	std::cout << "Test 10 passed" << "\n";
+}
+
+void test11()
+{
+	//Scans and bulk loads through an access strategy must recycle their own frames, leaving hot pages alone
+	const std::uint32_t poolSize = 24;
+	const PageId hotPages = 10;
+	BufMgr ringMgr(poolSize);
+
+	for (int round = 0; round < 3; round++)
+	{
+		for (i = 1; i <= hotPages; i++)
+		{
+			ringMgr.readPage(file1ptr, i, page);
+			ringMgr.unPinPage(file1ptr, i, false);
+		}
+	}
+
+	BufferAccessStrategy scan(BufferAccessStrategy::BULK_READ_RING);
+	for (i = hotPages + 1; i <= num; i++)
+	{
+		ringMgr.readPage(file1ptr, i, page, &scan);
+		sprintf(tmpbuf, "test.1 Page %u %7.1f", i, (float)i);
+		const RecordId recordId = {i, 1};
+		if(strncmp(page->getRecord(recordId).c_str(), tmpbuf, strlen(tmpbuf)) != 0)
+		{
+			PRINT_ERROR("ERROR :: CONTENTS DID NOT MATCH");
+		}
+		ringMgr.unPinPage(file1ptr, i, false);
+	}
+
+	BufferAccessStrategy load(BufferAccessStrategy::BULK_WRITE_RING);
+	PageId loaded[30];
+	for (int n = 0; n < 30; n++)
+	{
+		ringMgr.allocPage(file3ptr, loaded[n], page, &load);
+		sprintf(tmpbuf, "bulk %u", loaded[n]);
+		page->insertRecord(tmpbuf);
+		ringMgr.unPinPage(file3ptr, loaded[n], true);
+	}
+
+	ringMgr.clearBufStats();
+	for (i = 1; i <= hotPages; i++)
+	{
+		ringMgr.readPage(file1ptr, i, page);
+		ringMgr.unPinPage(file1ptr, i, false);
+	}
+	if (ringMgr.getBufStats().hits != (int)hotPages)
+	{
+		PRINT_ERROR("ERROR :: Hot pages were evicted by a scan with an access strategy.");
+	}
+
+	ringMgr.flushFile(file1ptr);
+	ringMgr.flushFile(file3ptr);
+	for (int n = 0; n < 30; n++)
+	{
+		sprintf(tmpbuf, "bulk %u", loaded[n]);
+		const RecordId recordId = {loaded[n], 1};
+		if(file3ptr->readPage(loaded[n]).getRecord(recordId) != tmpbuf)
+		{
+			PRINT_ERROR("ERROR :: CONTENTS DID NOT MATCH");
+		}
+	}
+
+	std::cout << "Test 11 passed" << "\n";
+}
+
+void test12()
+{
+	//Page handles must unpin exactly once, when destroyed, released, or unwound by an exception
+	std::vector<PageHandle> handles;
+	for (i = 1; i <= 10; i++)
+	{
+		PageHandle handle = bufMgr->readPage(file1ptr, i);
+		sprintf(tmpbuf, "test.1 Page %u %7.1f", i, (float)i);
+		const RecordId recordId = {i, 1};
+		if(strncmp(handle->getRecord(recordId).c_str(), tmpbuf, strlen(tmpbuf)) != 0)
+		{
+			PRINT_ERROR("ERROR :: CONTENTS DID NOT MATCH");
+		}
+		handles.push_back(std::move(handle));
+		if (handle)
+		{
+			PRINT_ERROR("ERROR :: Moved-from page handle still holds its pin.");
+		}
+	}
+
+	try
+	{
+		bufMgr->flushFile(file1ptr);
+		PRINT_ERROR("ERROR :: Pages pinned for file being flushed. Exception should have been thrown before execution reaches this point.");
+	}
+	catch(const PagePinnedException &e)
+	{
+	}
+	handles.clear();
+
+	try
+	{
+		PageHandle handle = bufMgr->readPage(file1ptr, 1);
+		throw InvalidPageException(1, "test.1");
+	}
+	catch(const InvalidPageException &e)
+	{
+	}
+	bufMgr->flushFile(file1ptr);
+
+	PageId loaded;
+	{
+		PageHandle handle = bufMgr->allocPage(file3ptr, loaded);
+		sprintf(tmpbuf, "handle %u", loaded);
+		handle->insertRecord(tmpbuf);
+		handle.markDirty();
+		handle.release();
+		handle.release();
+	}
+	bufMgr->flushFile(file3ptr);
+	const RecordId recordId = {loaded, 1};
+	if(file3ptr->readPage(loaded).getRecord(recordId) != tmpbuf)
+	{
+		PRINT_ERROR("ERROR :: CONTENTS DID NOT MATCH");
+	}
+
+	//The pin of a disposed page goes with it; its handle must not unpin the page that takes over the frame
+	{
+		PageId disposed;
+		PageHandle handle = bufMgr->allocPage(file3ptr, disposed);
+		bufMgr->disposePage(file3ptr, disposed);
+		bufMgr->readPage(file1ptr, 1, page);
+		if(page != &bufMgr->bufPool[handle.frame()])
+		{
+			PRINT_ERROR("ERROR :: Frame of the disposed page was not reused.");
+		}
+		handle.release();
+		try
+		{
+			bufMgr->flushFile(file1ptr);
+			PRINT_ERROR("ERROR :: Page pinned for file being flushed. Exception should have been thrown before execution reaches this point.");
+		}
+		catch(const PagePinnedException &e)
+		{
+		}
+		bufMgr->unPinPage(file1ptr, 1, false);
+	}
+	bufMgr->flushFile(file1ptr);
+
+	//A handle whose pin was already dropped is destroyed during unwinding without terminating the program
+	try
+	{
+		PageHandle handle = bufMgr->readPage(file1ptr, 2);
+		bufMgr->unPinPage(file1ptr, 2, false);
+		throw InvalidPageException(2, "test.1");
+	}
+	catch(const InvalidPageException &e)
+	{
+	}
+	bufMgr->flushFile(file1ptr);
+
+	std::cout << "Test 12 passed" << "\n";
+}
+
+void test13()
+{
+	//Pages are read straight into frames; reads past the end of the file or of deleted pages must still fail
+	try
+	{
+		bufMgr->readPage(file1ptr, num + 1, page);
+		PRINT_ERROR("ERROR :: Page is past the end of the file. Exception should have been thrown before execution reaches this point.");
+	}
+	catch(const InvalidPageException &e)
+	{
+	}
+
+	bufMgr->readPage(file1ptr, num, page);
+	sprintf(tmpbuf, "test.1 Page %u %7.1f", num, (float)num);
+	const RecordId recordId = {num, 1};
+	if(strncmp(page->getRecord(recordId).c_str(), tmpbuf, strlen(tmpbuf)) != 0)
+	{
+		PRINT_ERROR("ERROR :: CONTENTS DID NOT MATCH");
+	}
+	bufMgr->unPinPage(file1ptr, num, false);
+
+	PageId disposed;
+	bufMgr->allocPage(file3ptr, disposed, page);
+	bufMgr->unPinPage(file3ptr, disposed, true);
+	bufMgr->disposePage(file3ptr, disposed);
+	try
+	{
+		bufMgr->readPage(file3ptr, disposed, page);
+		PRINT_ERROR("ERROR :: Page was deleted. Exception should have been thrown before execution reaches this point.");
+	}
+	catch(const InvalidPageException &e)
+	{
+	}
+
+	std::cout << "Test 13 passed" << "\n";
+}
+
+void test14()
+{
+	//Frames are aligned pages in one arena, and a page copy is a plain copy of its bytes
+	for (i = 0; i < num; i++)
+	{
+		if (reinterpret_cast<std::uintptr_t>(&bufMgr->bufPool[i]) % Page::ALIGNMENT != 0)
+		{
+			PRINT_ERROR("ERROR :: Buffer pool frame is not aligned.");
+		}
+	}
+
+	bufMgr->readPage(file1ptr, 1, page);
+	Page copy;
+	std::memcpy(static_cast<void*>(&copy), page, sizeof(Page));
+	bufMgr->unPinPage(file1ptr, 1, false);
+	sprintf(tmpbuf, "test.1 Page %u %7.1f", 1, 1.0f);
+	const RecordId recordId = {1, 1};
+	if(strncmp(copy.getRecord(recordId).c_str(), tmpbuf, strlen(tmpbuf)) != 0)
+	{
+		PRINT_ERROR("ERROR :: CONTENTS DID NOT MATCH");
+	}
+
+	std::cout << "Test 14 passed" << "\n";
+}
+
+void test15()
+{
+	//Record views point into the pinned frame and match the copies
+	bufMgr->readPage(file1ptr, 2, page);
+	sprintf(tmpbuf, "test.1 Page %u %7.1f", 2, 2.0f);
+	int records = 0;
+	for (RecordViewIterator iter = page->beginViews(); iter != page->endViews(); ++iter)
+	{
+		const RecordViewIterator::value_type record = *iter;
+		const RecordView view = record.second;
+		if (record.first.page_number != 2 || view.data() < reinterpret_cast<const char*>(page) ||
+			view.data() + view.length() > reinterpret_cast<const char*>(page) + Page::SIZE)
+		{
+			PRINT_ERROR("ERROR :: Record view does not point into the frame.");
+		}
+		if (view != RecordView(page->getRecord(record.first)))
+		{
+			PRINT_ERROR("ERROR :: Record view does not match the record.");
+		}
+		records++;
+	}
+	if (records != 1 || strncmp(page->getRecordView({2, 1}).data(), tmpbuf, strlen(tmpbuf)) != 0)
+	{
+		PRINT_ERROR("ERROR :: CONTENTS DID NOT MATCH");
+	}
+	bufMgr->unPinPage(file1ptr, 2, false);
+
+	//Pointer and length inserts and updates keep binary data as is
+	Page scratch;
+	const char bytes[] = {'a', '\0', 'b', '\0'};
+	if (!scratch.hasSpaceForRecord(sizeof(bytes)) || scratch.hasSpaceForRecord(Page::DATA_SIZE))
+	{
+		PRINT_ERROR("ERROR :: Wrong free space for record.");
+	}
+	const RecordId rid = scratch.insertRecord(bytes, sizeof(bytes));
+	if (scratch.getRecordView(rid) != RecordView(bytes, sizeof(bytes)) ||
+		scratch.getRecord(rid) != std::string(bytes, sizeof(bytes)))
+	{
+		PRINT_ERROR("ERROR :: Binary record was not stored as is.");
+	}
+	scratch.updateRecord(rid, bytes + 2, 2);
+	if (scratch.getRecordView(rid) != RecordView(bytes + 2, 2))
+	{
+		PRINT_ERROR("ERROR :: Binary record was not updated.");
+	}
+
+	std::cout << "Test 15 passed" << "\n";
+}
+
+void test16()
+{
+	//Deletes leave holes which inserts and updates reclaim by compacting the page
+	Page scratch;
+	std::vector<std::pair<RecordId, std::string> > records;
+	std::srand(16);
+	for (int op = 0; op < 20000; op++)
+	{
+		const std::string record(1 + std::rand() % 64, 'a' + op % 26);
+		const int choice = std::rand() % 3;
+		if (choice == 0 && scratch.hasSpaceForRecord(record))
+		{
+			records.push_back(std::make_pair(scratch.insertRecord(record), record));
+		}
+		else if (choice == 1 && !records.empty())
+		{
+			const std::size_t victim = std::rand() % records.size();
+			scratch.deleteRecord(records[victim].first);
+			records[victim] = records.back();
+			records.pop_back();
+		}
+		else if (choice == 2 && !records.empty())
+		{
+			std::pair<RecordId, std::string>& updated = records[std::rand() % records.size()];
+			if (record.length() <= scratch.getFreeSpace() + updated.second.length())
+			{
+				scratch.updateRecord(updated.first, record);
+				updated.second = record;
+			}
+		}
+		if (op % 100 == 0)
+		{
+			for (std::size_t r = 0; r < records.size(); r++)
+			{
+				if (scratch.getRecordView(records[r].first) != RecordView(records[r].second))
+				{
+					PRINT_ERROR("ERROR :: Record changed by deleting or updating another record.");
+				}
+			}
+		}
+	}
+
+	//Free space left by every other record can be used by a single record
+	for (std::size_t r = 0; r < records.size(); r += 2)
+	{
+		scratch.deleteRecord(records[r].first);
+	}
+	const std::string filler(scratch.getFreeSpace(), 'z');
+	const RecordId fillerId = scratch.insertRecord(filler);
+	if (scratch.getFreeSpace() != 0 || scratch.getRecord(fillerId) != filler)
+	{
+		PRINT_ERROR("ERROR :: Page was not compacted to hold the record.");
+	}
+	for (std::size_t r = 1; r < records.size(); r += 2)
+	{
+		if (scratch.getRecordView(records[r].first) != RecordView(records[r].second))
+		{
+			PRINT_ERROR("ERROR :: Record changed by compacting the page.");
+		}
+		scratch.deleteRecord(records[r].first);
+	}
+	scratch.deleteRecord(fillerId);
+	if (scratch.getFreeSpace() != Page::DATA_SIZE)
+	{
+		PRINT_ERROR("ERROR :: Empty page does not have all of its space free.");
+	}
+
+	std::cout << "Test 16 passed" << "\n";
+}
+
+void test17()
+{
+	//Inserts reuse exactly the slots freed by deletes, most recently freed first
+	Page scratch;
+	std::vector<RecordId> rids;
+	for (i = 0; i < 300; i++)
+	{
+		rids.push_back(scratch.insertRecord("slot"));
+	}
+	for (i = 10; i < 290; i += 7)
+	{
+		scratch.deleteRecord(rids[i]);
+	}
+	Page older = scratch;
+	for (i = 283; i >= 10; i -= 7)
+	{
+		if (scratch.insertRecord("reused").slot_number != rids[i].slot_number)
+		{
+			PRINT_ERROR("ERROR :: Insert did not reuse the last freed slot.");
+		}
+	}
+	if (scratch.insertRecord("new").slot_number != 301)
+	{
+		PRINT_ERROR("ERROR :: Insert did not allocate a new slot when none were free.");
+	}
+
+	//Pages written without a free slot list get one built, lowest slot first
+	PageHeader header;
+	std::memcpy(&header, &older, sizeof(header));
+	header.first_free_slot = Page::INVALID_SLOT;
+	std::memcpy(static_cast<void*>(&older), &header, sizeof(header));
+	for (i = 10; i < 290; i += 7)
+	{
+		if (older.insertRecord("reused").slot_number != rids[i].slot_number)
+		{
+			PRINT_ERROR("ERROR :: Insert did not reuse the lowest free slot of an older page.");
+		}
+	}
+
+	//Deleting the last slots gives their space back
+	const std::uint16_t freeSpace = scratch.getFreeSpace();
+	const RecordId last = scratch.insertRecord("last");
+	scratch.deleteRecord(last);
+	if (scratch.getFreeSpace() != freeSpace)
+	{
+		PRINT_ERROR("ERROR :: Trailing slot was not released.");
+	}
+
+	std::cout << "Test 17 passed" << "\n";
+}
+
+void test18()
+{
+	//A batch fills a page up to the first record that does not fit
+	Page scratch;
+	const std::string big(Page::DATA_SIZE / 3, 'b');
+	const RecordView batch[] = {RecordView(big), RecordView(big), RecordView(big), RecordView("small")};
+	RecordId batchIds[4];
+	if (scratch.insertRecords(batch, 4, batchIds) != 2 || scratch.getRecord(batchIds[1]) != big)
+	{
+		PRINT_ERROR("ERROR :: Batch insert did not stop at the first record that does not fit.");
+	}
+
+	//A bulk load spreads records over new pages, all of them unpinned at the end
+	const std::string filename6 = "test.6";
+	try
+	{
+		File::remove(filename6);
+	}
+	catch(const FileNotFoundException &)
+	{
+	}
+	{
+		File file6 = File::create(filename6);
+		std::vector<std::string> records;
+		for (i = 0; i < 5000; i++)
+		{
+			sprintf(tmpbuf, "test.6 record %u", i);
+			records.push_back(tmpbuf);
+		}
+		std::vector<RecordView> views(records.begin(), records.end());
+		std::vector<RecordId> rids(records.size());
+		std::size_t numPages;
+		{
+			BulkLoader loader(bufMgr, &file6);
+			loader.insertRecords(&views[0], 4000, &rids[0]);
+			for (i = 4000; i < 5000; i++)
+			{
+				rids[i] = loader.insertRecord(views[i]);
+			}
+			numPages = loader.num_pages();
+		}
+		bufMgr->flushFile(&file6);
+
+		if (numPages < 2 || rids[4999].page_number != numPages)
+		{
+			PRINT_ERROR("ERROR :: Bulk load did not fill consecutive pages.");
+		}
+		for (i = 0; i < 5000; i++)
+		{
+			if (file6.readPage(rids[i].page_number).getRecord(rids[i]) != records[i])
+			{
+				PRINT_ERROR("ERROR :: CONTENTS DID NOT MATCH");
+			}
+		}
+	}
+	File::remove(filename6);
+
+	std::cout << "Test 18 passed" << "\n";
+}
+
+void test19()
+{
+	//Fixed-length record pages go through the buffer pool and the file like slotted ones
+	typedef FixedPage<16> Fixed16;
+	const std::string filename6 = "test.6";
+	try
+	{
+		File::remove(filename6);
+	}
+	catch(const FileNotFoundException &)
+	{
+	}
+	{
+		File file6 = File::create(filename6);
+		char record[16];
+		PageId pageNo;
+		bufMgr->allocPage(&file6, pageNo, page);
+		Fixed16 fixed = Fixed16::format(page);
+		for (i = 0; fixed.hasSpaceForRecord(); i++)
+		{
+			std::memset(record, 0, sizeof(record));
+			sprintf(record, "fixed %u", i);
+			if (fixed.insertRecord(record).slot_number != i + 1)
+			{
+				PRINT_ERROR("ERROR :: Fixed-length record was not stored in the next position.");
+			}
+		}
+		if (i != Fixed16::CAPACITY || page->hasSpaceForRecord("slotted"))
+		{
+			PRINT_ERROR("ERROR :: Wrong number of fixed-length records on the page.");
+		}
+
+		//Freed positions are reused lowest first
+		const RecordId third = {pageNo, 3};
+		const RecordId fifth = {pageNo, 5};
+		fixed.deleteRecord(fifth);
+		fixed.deleteRecord(third);
+		try
+		{
+			fixed.getRecord(third);
+			PRINT_ERROR("ERROR :: Deleted record was returned. Exception should have been thrown before execution reaches this point.");
+		}
+		catch(const InvalidRecordException &e)
+		{
+		}
+		sprintf(record, "fixed %u", 2);
+		fixed.insertRecord(record);
+		sprintf(record, "fixed %u", 4);
+		if (fixed.insertRecord(record) != fifth)
+		{
+			PRINT_ERROR("ERROR :: Freed fixed-length record position was not reused.");
+		}
+		bufMgr->unPinPage(&file6, pageNo, true);
+		bufMgr->flushFile(&file6);
+
+		bufMgr->readPage(&file6, pageNo, page);
+		fixed = Fixed16(page);
+		i = 0;
+		for (Fixed16::Iterator iter = fixed.begin(); iter != fixed.end(); ++iter, i++)
+		{
+			const Fixed16::Iterator::value_type entry = *iter;
+			sprintf(record, "fixed %u", i);
+			if (entry.first.slot_number != i + 1 || strncmp(entry.second.data(), record, strlen(record)) != 0)
+			{
+				PRINT_ERROR("ERROR :: CONTENTS DID NOT MATCH");
+			}
+		}
+		if (i != Fixed16::CAPACITY || fixed.num_records() != Fixed16::CAPACITY)
+		{
+			PRINT_ERROR("ERROR :: Fixed-length records were lost on the way to disk.");
+		}
+		bufMgr->unPinPage(&file6, pageNo, false);
+		bufMgr->flushFile(&file6);
+	}
+	File::remove(filename6);
+
+	std::cout << "Test 19 passed" << "\n";
+}
+
+void test20()
+{
+	//PAX pages keep each column contiguous and go through the buffer pool like other pages
+	const std::string filename6 = "test.6";
+	try
+	{
+		File::remove(filename6);
+	}
+	catch(const FileNotFoundException &)
+	{
+	}
+	{
+		File file6 = File::create(filename6);
+		std::vector<std::uint16_t> columns;
+		columns.push_back(sizeof(std::uint32_t));
+		columns.push_back(12);
+		columns.push_back(sizeof(std::uint64_t));
+		PageId pageNo;
+		bufMgr->allocPage(&file6, pageNo, page);
+		PaxPage pax = PaxPage::format(page, columns);
+		if (pax.record_size() != 24 || pax.capacity() * 24 > Page::DATA_SIZE || page->hasSpaceForRecord("slotted"))
+		{
+			PRINT_ERROR("ERROR :: Wrong PAX page layout.");
+		}
+		char record[24];
+		for (i = 0; pax.hasSpaceForRecord(); i++)
+		{
+			const std::uint64_t value = 1000 + i;
+			std::memcpy(record, &i, 4);
+			sprintf(record + 4, "pax %7u", i);
+			std::memcpy(record + 16, &value, 8);
+			pax.insertRecord(record);
+		}
+		const RecordId tenth = {pageNo, 10};
+		pax.deleteRecord(tenth);
+		const std::uint64_t updated = 7;
+		pax.updateField({pageNo, 11}, 2, reinterpret_cast<const char*>(&updated));
+		bufMgr->unPinPage(&file6, pageNo, true);
+		bufMgr->flushFile(&file6);
+
+		bufMgr->readPage(&file6, pageNo, page);
+		pax = PaxPage(page);
+		//Sum the last column straight from its minipage
+		const char* values = pax.column_data(2);
+		std::uint64_t sum = 0, expected = 0;
+		for (SlotId slot = pax.nextUsedSlot(Page::INVALID_SLOT); slot != Page::INVALID_SLOT; slot = pax.nextUsedSlot(slot))
+		{
+			std::uint64_t value;
+			std::memcpy(&value, values + (slot - 1) * sizeof(value), sizeof(value));
+			sum += value;
+		}
+		for (i = 0; i < pax.capacity(); i++)
+		{
+			expected += i == 9 ? 0 : i == 10 ? 7 : 1000 + i;
+		}
+		if (sum != expected || pax.num_records() != pax.capacity() - 1)
+		{
+			PRINT_ERROR("ERROR :: PAX column does not match the records inserted.");
+		}
+		i = 0;
+		for (PaxPage::ColumnIterator iter = pax.beginColumn(1); iter != pax.endColumn(1); ++iter, i++)
+		{
+			const PageId expectedNo = i < 9 ? i : i + 1;
+			sprintf(tmpbuf, "pax %7u", expectedNo);
+			const std::string row = pax.getRecord((*iter).first);
+			if ((*iter).second != RecordView(tmpbuf, 12) || row.compare(4, 12, tmpbuf, 12) != 0)
+			{
+				PRINT_ERROR("ERROR :: CONTENTS DID NOT MATCH");
+			}
+		}
+		try
+		{
+			pax.getField(tenth, 0);
+			PRINT_ERROR("ERROR :: Deleted PAX record was returned. Exception should have been thrown before execution reaches this point.");
+		}
+		catch(const InvalidRecordException &e)
+		{
+		}
+		bufMgr->unPinPage(&file6, pageNo, false);
+		bufMgr->flushFile(&file6);
+	}
+	File::remove(filename6);
+
+	std::cout << "Test 20 passed" << "\n";
+}
+
+void test21()
+{
+	//The codec round-trips repetitive and incompressible data
+	std::string plain(3000, 'a');
+	for (i = 0; i < 1000; i++)
+	{
+		plain[i] = static_cast<char>(random());
+	}
+	std::vector<char> packed(plain.size() + plain.size() / 255 + 16);
+	std::string unpacked(plain.size(), '\0');
+	const std::size_t packedSize = LzCodec::compress(plain.data(), plain.size(), &packed[0], packed.size());
+	if (packedSize == 0 || packedSize > 1100 || !LzCodec::decompress(&packed[0], packedSize, &unpacked[0], unpacked.size()) || unpacked != plain)
+	{
+		PRINT_ERROR("ERROR :: Codec did not round-trip its input.");
+	}
+	if (LzCodec::compress(plain.data(), 1000, &packed[0], 500) != 0 || LzCodec::decompress(&packed[0], packedSize - 1, &unpacked[0], unpacked.size()))
+	{
+		PRINT_ERROR("ERROR :: Codec accepted a buffer that is too small.");
+	}
+
+	//Pages of a compressed file take less space on disk and read back unchanged through the buffer pool
+	const std::string filename6 = "test.6";
+	try
+	{
+		File::remove(filename6);
+	}
+	catch(const FileNotFoundException &)
+	{
+	}
+	const PageId numPages = 20;
+	std::vector<RecordId> rids;
+	std::string noise;
+	{
+		File file6 = File::create(filename6, File::COMPRESSED);
+		for (i = 0; i < numPages; i++)
+		{
+			PageId pageNo;
+			bufMgr->allocPage(&file6, pageNo, page);
+			for (PageId r = 0; r <= i; r++)
+			{
+				sprintf(tmpbuf, "test.6 Page %u record %u", pageNo, r);
+				rids.push_back(page->insertRecord(tmpbuf));
+			}
+			bufMgr->unPinPage(&file6, pageNo, true);
+		}
+		bufMgr->flushFile(&file6);
+
+		//Grow a page past the space it was given, and store one that does not compress
+		bufMgr->readPage(&file6, 2, page);
+		const RecordId grown = page->insertRecord(std::string(3000, 'g'));
+		bufMgr->unPinPage(&file6, 2, true);
+		bufMgr->readPage(&file6, 3, page);
+		noise.resize(page->getFreeSpace() - 8);
+		for (std::size_t n = 0; n < noise.size(); n++)
+		{
+			noise[n] = static_cast<char>(random());
+		}
+		const RecordId noisy = page->insertRecord(noise);
+		bufMgr->unPinPage(&file6, 3, true);
+		bufMgr->flushFile(&file6);
+		rids.push_back(grown);
+		rids.push_back(noisy);
+		bufMgr->disposePage(&file6, numPages);
+	}
+	{
+		std::ifstream onDisk(filename6, std::ios::binary | std::ios::ate);
+		if (onDisk.tellg() >= static_cast<std::streamoff>(numPages * Page::SIZE / 2))
+		{
+			PRINT_ERROR("ERROR :: Compressed file is not smaller than its pages.");
+		}
+	}
+
+	//Reopening rebuilds the page-offset map from the file
+	{
+		File file6 = File::open(filename6);
+		if (!file6.compressed())
+		{
+			PRINT_ERROR("ERROR :: Compressed flag was not kept in the file header.");
+		}
+		for (std::size_t n = 0; n < rids.size(); n++)
+		{
+			const RecordId& rid = rids[n];
+			if (rid.page_number == numPages)
+			{
+				continue;
+			}
+			bufMgr->readPage(&file6, rid.page_number, page);
+			const std::string record = page->getRecord(rid);
+			bufMgr->unPinPage(&file6, rid.page_number, false);
+			if (n == rids.size() - 2)
+			{
+				if (record != std::string(3000, 'g'))
+				{
+					PRINT_ERROR("ERROR :: CONTENTS DID NOT MATCH");
+				}
+				continue;
+			}
+			if (n == rids.size() - 1)
+			{
+				if (record != noise)
+				{
+					PRINT_ERROR("ERROR :: CONTENTS DID NOT MATCH");
+				}
+				continue;
+			}
+			sprintf(tmpbuf, "test.6 Page %u record %u", rid.page_number, rid.slot_number - 1);
+			if (record != tmpbuf)
+			{
+				PRINT_ERROR("ERROR :: CONTENTS DID NOT MATCH");
+			}
+		}
+		try
+		{
+			bufMgr->readPage(&file6, numPages, page);
+			PRINT_ERROR("ERROR :: Deleted page was read. Exception should have been thrown before execution reaches this point.");
+		}
+		catch(const InvalidPageException &e)
+		{
+		}
+		PageId pages = 0;
+		for (FileIterator iter = file6.begin(); iter != file6.end(); ++iter)
+		{
+			pages++;
+		}
+		if (pages != numPages - 1)
+		{
+			PRINT_ERROR("ERROR :: Used page list of the compressed file is wrong.");
+		}
+		bufMgr->flushFile(&file6);
+	}
+
+	//A move cut short before the old space was freed leaves page 3 stored twice; the copy stored last is read
+	{
+		std::fstream onDisk(filename6, std::ios::in | std::ios::out | std::ios::binary);
+		std::streamoff position = sizeof(FileHeader);
+		CompressedPageHeader stored;
+		PageHeader header;
+		for (;;)
+		{
+			onDisk.seekg(position);
+			onDisk.read(reinterpret_cast<char*>(&stored), sizeof(stored));
+			onDisk.read(reinterpret_cast<char*>(&header), sizeof(header));
+			if (!onDisk || (stored.page_number == Page::INVALID_NUMBER && header.current_page_number == 3))
+			{
+				break;
+			}
+			position += stored.capacity;
+		}
+		if (!onDisk)
+		{
+			PRINT_ERROR("ERROR :: Space of the page that moved was not marked free.");
+		}
+		stored.page_number = 3;
+		onDisk.seekp(position);
+		onDisk.write(reinterpret_cast<const char*>(&stored), sizeof(stored));
+	}
+	{
+		File file6 = File::open(filename6);
+		if (file6.readPage(3).getRecord(rids.back()) != noise)
+		{
+			PRINT_ERROR("ERROR :: CONTENTS DID NOT MATCH");
+		}
+	}
+	File::remove(filename6);
+
+	std::cout << "Test 21 passed" << "\n";
+}
+
+void test22()
+{
+	//Both CRC-32C versions give the standard check value and agree on a page
+	std::vector<char> bytes(Page::SIZE);
+	for (std::size_t n = 0; n < bytes.size(); n++)
+	{
+		bytes[n] = static_cast<char>(random());
+	}
+	if (Crc32c::value("123456789", 9) != 0xe3069283 || Crc32c::extendPortable(0, "123456789", 9) != 0xe3069283 ||
+		Crc32c::value(&bytes[3], Page::DATA_SIZE) != Crc32c::extendPortable(Crc32c::value(&bytes[3], 100), &bytes[103], Page::DATA_SIZE - 100))
+	{
+		PRINT_ERROR("ERROR :: CRC-32C versions do not agree.");
+	}
+
+	//A page changed on disk is reported when read from a file that keeps checksums, and only then
+	const std::string filename6 = "test.6";
+	const std::uint32_t modes[] = {File::CHECKSUMS, File::CHECKSUMS | File::COMPRESSED, 0};
+	for (std::size_t m = 0; m < 3; m++)
+	{
+		try
+		{
+			File::remove(filename6);
+		}
+		catch(const FileNotFoundException &)
+		{
+		}
+		File file6 = File::create(filename6, modes[m]);
+		for (i = 0; i < 3; i++)
+		{
+			PageId pageNo;
+			bufMgr->allocPage(&file6, pageNo, page);
+			sprintf(tmpbuf, "test.6 Page %u", pageNo);
+			page->insertRecord(tmpbuf);
+			bufMgr->unPinPage(&file6, pageNo, true);
+		}
+		bufMgr->flushFile(&file6);
+
+		//Pages keep their size; only files that keep checksums store one after each page
+		const std::streamoff headerSize = sizeof(FileHeader);
+		const std::streamoff stride = Page::SIZE + (file6.checksums() ? sizeof(std::uint32_t) : 0);
+		if (!file6.compressed())
+		{
+			std::ifstream stored(filename6, std::ios::binary | std::ios::ate);
+			if (stored.tellg() != headerSize + 3 * stride)
+			{
+				PRINT_ERROR("ERROR :: Pages were not laid out one per Page::SIZE and checksum.");
+			}
+		}
+
+		//Flip a bit in the record of page 2, which is in the last bytes of its data area
+		std::streamoff position = headerSize + stride + Page::SIZE - 3;
+		if (file6.compressed())
+		{
+			position = headerSize;
+			CompressedPageHeader stored;
+			std::ifstream in(filename6, std::ios::binary);
+			for (;;)
+			{
+				in.seekg(position);
+				in.read(reinterpret_cast<char*>(&stored), sizeof(stored));
+				if (stored.page_number == 2)
+				{
+					break;
+				}
+				position += stored.capacity;
+			}
+			position += sizeof(stored) + sizeof(PageHeader) + stored.data_length - 3;
+		}
+		{
+			std::fstream onDisk(filename6, std::ios::in | std::ios::out | std::ios::binary);
+			onDisk.seekg(position);
+			const char flipped = onDisk.get() ^ 0x10;
+			onDisk.seekp(position);
+			onDisk.put(flipped);
+		}
+
+		bool reported = false;
+		try
+		{
+			bufMgr->readPage(&file6, 2, page);
+			bufMgr->unPinPage(&file6, 2, false);
+		}
+		catch(const CorruptPageException &e)
+		{
+			reported = true;
+		}
+		catch(const InvalidPageException &e)
+		{
+			//A compressed page may no longer decompress at all
+			reported = file6.compressed();
+		}
+		if (reported != file6.checksums())
+		{
+			PRINT_ERROR("ERROR :: Corrupt page was not reported by its checksum.");
+		}
+		if (file6.checksums() && file6.readPages(1, 3)[1].page_number() != Page::INVALID_NUMBER)
+		{
+			PRINT_ERROR("ERROR :: Corrupt page was returned from a run of pages.");
+		}
+		for (i = 1; i <= 3; i += 2)
+		{
+			bufMgr->readPage(&file6, i, page);
+			sprintf(tmpbuf, "test.6 Page %u", i);
+			if (page->getRecord({i, 1}) != tmpbuf)
+			{
+				PRINT_ERROR("ERROR :: CONTENTS DID NOT MATCH");
+			}
+			bufMgr->unPinPage(&file6, i, false);
+		}
+		bufMgr->flushFile(&file6);
+
+		//A zeroed checksum, as a torn write may leave behind, does not match either
+		if (file6.checksums() && !file6.compressed())
+		{
+			{
+				const std::uint32_t zero = 0;
+				std::fstream onDisk(filename6, std::ios::in | std::ios::out | std::ios::binary);
+				onDisk.seekp(headerSize + 2 * stride + Page::SIZE);
+				onDisk.write(reinterpret_cast<const char*>(&zero), sizeof(zero));
+			}
+			try
+			{
+				file6.readPage(3);
+				PRINT_ERROR("ERROR :: Page with a zeroed checksum was read. Exception should have been thrown before execution reaches this point.");
+			}
+			catch(const CorruptPageException &e)
+			{
+			}
+		}
+	}
+	File::remove(filename6);
+
+	std::cout << "Test 22 passed" << "\n";
+}
+
+void test23()
+{
+	//Slot searches agree with a slot-by-slot search from every starting point, whatever the occupancy
+	const int percents[] = {100, 95, 50, 10, 1, 0};
+	for (std::size_t p = 0; p < 6; p++)
+	{
+		const SlotId numSlots = 200 + p * 7;
+		std::vector<PageSlot> slots(numSlots);
+		for (SlotId n = 0; n < numSlots; n++)
+		{
+			slots[n].used = random() % 100 < percents[p];
+			slots[n].item_offset = random();
+			slots[n].item_length = random();
+		}
+		for (SlotId start = 0; start <= numSlots; start++)
+		{
+			SlotId nextUsed = Page::INVALID_SLOT, nextFree = Page::INVALID_SLOT;
+			for (SlotId n = numSlots; n > start; n--)
+			{
+				(slots[n - 1].used ? nextUsed : nextFree) = n;
+			}
+			if (SlotScan::nextUsed(&slots[0], numSlots, start) != nextUsed || SlotScan::nextFree(&slots[0], numSlots, start) != nextFree ||
+				(start > 0 && SlotScan::usedMask(&slots[0], numSlots, start) != SlotScan::usedMaskScalar(&slots[0], numSlots, start)))
+			{
+				PRINT_ERROR("ERROR :: Slot search did not find the same slot as a slot-by-slot search.");
+			}
+		}
+	}
+
+	//Iterating a sparse page visits exactly the records left on it
+	Page scratch;
+	std::vector<RecordId> rids;
+	while (scratch.hasSpaceForRecord("ab"))
+	{
+		rids.push_back(scratch.insertRecord("ab"));
+	}
+	std::vector<bool> kept(rids.size(), true);
+	for (std::size_t n = 0; n < rids.size(); n++)
+	{
+		if (random() % 10 != 0)
+		{
+			scratch.deleteRecord(rids[n]);
+			kept[n] = false;
+		}
+	}
+	std::size_t n = 0;
+	for (PageIterator iter = scratch.begin(); iter != scratch.end(); ++iter, n++)
+	{
+		while (!kept[n])
+		{
+			n++;
+		}
+		if (iter.record_id() != rids[n])
+		{
+			PRINT_ERROR("ERROR :: Page iteration did not visit the records left on the page.");
+		}
+	}
+	while (n < kept.size() && !kept[n])
+	{
+		n++;
+	}
+	if (n != kept.size())
+	{
+		PRINT_ERROR("ERROR :: Page iteration stopped early.");
+	}
+
+	//A page changed while iterated over, packed and sparse: records deleted ahead are not returned, records inserted
+	//behind are not visited, and records inserted more than SlotScan::WINDOW slots ahead are
+	const std::size_t spacings[] = {10, 2};
+	for (std::size_t s = 0; s < 2; s++)
+	{
+		const std::size_t spacing = spacings[s];
+		Page changing;
+		std::vector<RecordId> existing;
+		for (n = 0; n < 400; n++)
+		{
+			existing.push_back(changing.insertRecord("ab"));
+		}
+		for (n = 0; n < existing.size(); n += spacing)
+		{
+			changing.deleteRecord(existing[n]);
+		}
+		const SlotId current = existing[101].slot_number;
+		const SlotId deleted[] = {static_cast<SlotId>(current + 1), static_cast<SlotId>(current + SlotScan::WINDOW + 10)};
+		std::vector<RecordId> inserted;
+		std::vector<int> visits(Page::SIZE, 0);
+		SlotId previous = Page::INVALID_SLOT;
+		for (PageIterator iter = changing.begin(); iter != changing.end(); ++iter)
+		{
+			const SlotId slot = iter.record_id().slot_number;
+			if (slot <= previous)
+			{
+				PRINT_ERROR("ERROR :: Page iteration did not go forward through the slots.");
+			}
+			previous = slot;
+			visits[slot]++;
+			if (slot == current)
+			{
+				while (changing.hasSpaceForRecord("ab"))
+				{
+					inserted.push_back(changing.insertRecord("ab"));
+				}
+				for (std::size_t d = 0; d < 2; d++)
+				{
+					changing.deleteRecord(RecordId{changing.page_number(), deleted[d]});
+				}
+			}
+		}
+		for (std::size_t d = 0; d < 2; d++)
+		{
+			if (visits[deleted[d]] != 0)
+			{
+				PRINT_ERROR("ERROR :: Record deleted while iterating was returned.");
+			}
+			visits[deleted[d]] = -1;
+		}
+		for (n = 0; n < existing.size(); n++)
+		{
+			const SlotId slot = existing[n].slot_number;
+			if (n % spacing != 0 && slot > current && visits[slot] == 0)
+			{
+				PRINT_ERROR("ERROR :: Record left on the page was not visited.");
+			}
+		}
+		for (n = 0; n < inserted.size(); n++)
+		{
+			const SlotId slot = inserted[n].slot_number;
+			if ((slot < current && visits[slot] != 0) || (slot > current + SlotScan::WINDOW && visits[slot] == 0))
+			{
+				PRINT_ERROR("ERROR :: Record inserted while iterating was visited against the iteration rules.");
+			}
+		}
+	}
+
+	std::cout << "Test 23 passed" << "\n";
+}
+
+void test24()
+{
+	//Pages written through one backend read back through the other, compressed and checksummed or not
+	const std::string filename6 = "test.6";
+	const FileIoConfig::Backend backends[] = {FileIoConfig::POSITIONAL, FileIoConfig::STREAM};
+	const std::uint32_t modes[] = {0, File::COMPRESSED | File::CHECKSUMS};
+	const PageId numPages = 10;
+	for (std::size_t b = 0; b < 2; b++)
+	{
+		for (std::size_t m = 0; m < 2; m++)
+		{
+			try
+			{
+				File::remove(filename6);
+			}
+			catch(const FileNotFoundException &)
+			{
+			}
+			FileIoConfig config;
+			config.backend = backends[b];
+			{
+				File file6 = File::create(filename6, modes[m], config);
+				for (i = 0; i < numPages; i++)
+				{
+					PageId pageNo;
+					bufMgr->allocPage(&file6, pageNo, page);
+					sprintf(tmpbuf, "test.6 Page %u %7.1f", pageNo, (float)pageNo);
+					page->insertRecord(tmpbuf);
+					bufMgr->unPinPage(&file6, pageNo, true);
+				}
+				bufMgr->flushFile(&file6);
+				bufMgr->disposePage(&file6, 4);
+			}
+			config.backend = backends[1 - b];
+			File file6 = File::open(filename6, config);
+			if (file6.io_config().backend != backends[1 - b] || file6.flags() != modes[m])
+			{
+				PRINT_ERROR("ERROR :: File was not opened as requested.");
+			}
+			for (PageId pageNo = 1; pageNo <= numPages; pageNo++)
+			{
+				if (pageNo == 4)
+				{
+					continue;
+				}
+				bufMgr->readPage(&file6, pageNo, page);
+				sprintf(tmpbuf, "test.6 Page %u %7.1f", pageNo, (float)pageNo);
+				if (page->getRecord(RecordId{pageNo, 1}) != tmpbuf)
+				{
+					PRINT_ERROR("ERROR :: CONTENTS DID NOT MATCH");
+				}
+				bufMgr->unPinPage(&file6, pageNo, false);
+			}
+			try
+			{
+				bufMgr->readPage(&file6, 4, page);
+				PRINT_ERROR("ERROR :: Deleted page was read. Exception should have been thrown before execution reaches this point.");
+			}
+			catch(const InvalidPageException &e)
+			{
+			}
+			try
+			{
+				file6.readPage(numPages + 1);
+				PRINT_ERROR("ERROR :: Page past the end of the file was read. Exception should have been thrown before execution reaches this point.");
+			}
+			catch(const InvalidPageException &e)
+			{
+			}
+			bufMgr->flushFile(&file6);
+		}
+	}
+
+	//Another File object for an open file shares its backend, and pages are read from several threads at once
+	{
+		FileIoConfig config;
+		config.backend = FileIoConfig::POSITIONAL;
+		config.durability = FileIoConfig::SYNC_ALWAYS;
+		File file6 = File::open(filename6, config);
+		File other = File::open(filename6);
+		if (other.io_config().backend != FileIoConfig::POSITIONAL || other.io_config().durability != FileIoConfig::SYNC_ALWAYS)
+		{
+			PRINT_ERROR("ERROR :: Second File object did not share the open file.");
+		}
+		Page written = file6.allocatePage();
+		written.insertRecord("written through the other object");
+		other.writePage(written);
+		file6.sync();
+
+		std::vector<std::thread> readers;
+		std::vector<int> mismatches(4, 0);
+		for (std::size_t t = 0; t < mismatches.size(); t++)
+		{
+			readers.push_back(std::thread([&file6, &mismatches, t, numPages]()
+			{
+				Page read;
+				char expected[100];
+				for (int round = 0; round < 50; round++)
+				{
+					for (PageId pageNo = 1; pageNo <= numPages; pageNo++)
+					{
+						if (pageNo == 4)
+						{
+							continue;
+						}
+						file6.readPage(pageNo, read);
+						sprintf(expected, "test.6 Page %u %7.1f", pageNo, (float)pageNo);
+						if (read.getRecord(RecordId{pageNo, 1}) != expected)
+						{
+							mismatches[t]++;
+						}
+					}
+				}
+			}));
+		}
+		for (std::size_t t = 0; t < readers.size(); t++)
+		{
+			readers[t].join();
+		}
+		for (std::size_t t = 0; t < mismatches.size(); t++)
+		{
+			if (mismatches[t] != 0)
+			{
+				PRINT_ERROR("ERROR :: Concurrent reads returned the wrong page.");
+			}
+		}
+		if (file6.readPage(written.page_number()).getRecord(RecordId{written.page_number(), 1}) != "written through the other object")
+		{
+			PRINT_ERROR("ERROR :: CONTENTS DID NOT MATCH");
+		}
+	}
+	File::remove(filename6);
+
+	//Opening a file that cannot be opened reports why
+	try
+	{
+		FileIoConfig config;
+		config.backend = FileIoConfig::POSITIONAL;
+		File::create("no-such-directory/test.6", 0, config);
+		PRINT_ERROR("ERROR :: File was created in a missing directory. Exception should have been thrown before execution reaches this point.");
+	}
+	catch(const IoException &e)
+	{
+	}
+
+	std::cout << "Test 24 passed" << "\n";
+}
+
+void test25()
+{
+	//Misses, write-backs and read-ahead kept in flight through each kind of I/O engine, on files
+	//io_uring reaches and on files it leaves to File::readPage() and File::writePage()
+	const std::string filename6 = "test.6";
+	const IoEngineConfig::Kind kinds[] = {IoEngineConfig::AUTO, IoEngineConfig::THREAD_POOL};
+	const FileIoConfig::Backend backends[] = {FileIoConfig::POSITIONAL, FileIoConfig::STREAM, FileIoConfig::POSITIONAL};
+	const std::uint32_t modes[] = {0, File::COMPRESSED | File::CHECKSUMS, File::CHECKSUMS};
+	const PageId numPages = 40;
+	for (std::size_t k = 0; k < 2; k++)
+	{
+		for (std::size_t f = 0; f < 3; f++)
+		{
+			try
+			{
+				File::remove(filename6);
+			}
+			catch(const FileNotFoundException &)
+			{
+			}
+			FileIoConfig config;
+			config.backend = backends[f];
+			File file6 = File::create(filename6, modes[f], config);
+
+			BufMgr asyncMgr(64);
+			IoEngineConfig engine;
+			engine.kind = kinds[k];
+			//Smaller than the batches below, so that submissions wait for earlier ones
+			engine.queue_depth = 8;
+			asyncMgr.startAsyncIo(engine);
+			if (asyncMgr.asyncIoEngine() == NULL ||
+			    (kinds[k] == IoEngineConfig::THREAD_POOL && std::string(asyncMgr.asyncIoEngine()) != "thread pool"))
+			{
+				PRINT_ERROR("ERROR :: I/O engine was not started as requested.");
+			}
+
+			for (i = 0; i < numPages; i++)
+			{
+				PageId pageNo;
+				asyncMgr.allocPage(&file6, pageNo, page);
+				sprintf(tmpbuf, "test.6 Page %u %7.1f", pageNo, (float)pageNo);
+				page->insertRecord(tmpbuf);
+				asyncMgr.unPinPage(&file6, pageNo, true);
+			}
+			asyncMgr.flushFile(&file6);
+			if (asyncMgr.getBufStats().diskwrites != (int)numPages)
+			{
+				PRINT_ERROR("ERROR :: Dirty pages were not all written back.");
+			}
+
+			//Every page backwards, then one of them twice more
+			PageId pageNos[numPages + 2];
+			Page* pages[numPages + 2];
+			for (i = 0; i < numPages; i++)
+			{
+				pageNos[i] = numPages - i;
+			}
+			pageNos[numPages] = pageNos[numPages + 1] = 7;
+			asyncMgr.readPages(&file6, pageNos, numPages + 2, pages);
+			for (i = 0; i < numPages + 2; i++)
+			{
+				sprintf(tmpbuf, "test.6 Page %u %7.1f", pageNos[i], (float)pageNos[i]);
+				if (pages[i]->getRecord(RecordId{pageNos[i], 1}) != tmpbuf)
+				{
+					PRINT_ERROR("ERROR :: CONTENTS DID NOT MATCH");
+				}
+			}
+			if (pages[numPages] != pages[numPages - 7] || pages[numPages + 1] != pages[numPages - 7])
+			{
+				PRINT_ERROR("ERROR :: A page asked for twice was read into two frames.");
+			}
+			for (i = 0; i < numPages + 2; i++)
+			{
+				asyncMgr.unPinPage(&file6, pageNos[i], i % 2 == 0);
+			}
+			asyncMgr.flushFile(&file6);
+
+			//A batch with a page past the end of the file leaves nothing pinned
+			const PageId invalid[] = {2, numPages + 5, 3};
+			try
+			{
+				asyncMgr.readPages(&file6, invalid, 3, pages);
+				PRINT_ERROR("ERROR :: Page past the end of the file was read. Exception should have been thrown before execution reaches this point.");
+			}
+			catch(const InvalidPageException &e)
+			{
+			}
+			asyncMgr.flushFile(&file6);
+
+			//Read-ahead and the background writer go through the engine too
+			BgWriterConfig writerConfig;
+			writerConfig.dirtyRatio = 0;
+			writerConfig.delayMs = 1;
+			asyncMgr.startReadAhead();
+			asyncMgr.startBackgroundWriter(writerConfig);
+			asyncMgr.clearBufStats();
+			for (i = 1; i <= numPages; i++)
+			{
+				asyncMgr.readPage(&file6, i, page);
+				sprintf(tmpbuf, "test.6 Page %u %7.1f", i, (float)i);
+				if (page->getRecord(RecordId{i, 1}) != tmpbuf)
+				{
+					PRINT_ERROR("ERROR :: CONTENTS DID NOT MATCH");
+				}
+				page->insertRecord("written back in the background");
+				asyncMgr.unPinPage(&file6, i, true);
+
+				//Give the read-ahead thread time to start
+				for (int wait = 0; i == 2 && wait < 5000 && asyncMgr.getBufStats().prefetches == 0; wait++)
+					std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			}
+			for (int wait = 0; wait < 5000 && asyncMgr.getBufStats().bgwrites < (int)numPages; wait++)
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			if (asyncMgr.getBufStats().prefetchHits == 0 || asyncMgr.getBufStats().bgwrites != (int)numPages)
+			{
+				PRINT_ERROR("ERROR :: Read-ahead or background writer did not go through the I/O engine.");
+			}
+			asyncMgr.stopBackgroundWriter();
+			asyncMgr.stopReadAhead();
+			asyncMgr.flushFile(&file6);
+			asyncMgr.stopAsyncIo();
+
+			//Without the engine the same pages come back the usual way
+			asyncMgr.readPages(&file6, pageNos, numPages, pages);
+			for (i = 0; i < numPages; i++)
+			{
+				if (pages[i]->getRecord(RecordId{pageNos[i], 2}) != "written back in the background")
+				{
+					PRINT_ERROR("ERROR :: CONTENTS DID NOT MATCH");
+				}
+				asyncMgr.unPinPage(&file6, pageNos[i], false);
+			}
+			asyncMgr.flushFile(&file6);
+		}
+	}
+
+	//Requests straight to an engine report their own errors
+	{
+		FileIoConfig config;
+		config.backend = FileIoConfig::POSITIONAL;
+		File file6 = File::open(filename6, config);
+		Page deleted = file6.readPage(5);
+		file6.deletePage(5);
+		std::unique_ptr<IoEngine> engine(IoEngine::create());
+		Page pagesRead[4];
+		IoRequest requests[4];
+		const PageId requested[] = {1, 5, numPages + 1, Page::INVALID_NUMBER};
+		for (std::size_t n = 0; n < 4; n++)
+		{
+			requests[n].op = IoRequest::READ;
+			requests[n].file = &file6;
+			requests[n].page_number = requested[n];
+			requests[n].page = &pagesRead[n];
+		}
+		engine->run(requests, 4);
+		if (requests[0].error != NULL || pagesRead[0].page_number() != 1)
+		{
+			PRINT_ERROR("ERROR :: Page was not read.");
+		}
+		for (std::size_t n = 1; n < 4; n++)
+		{
+			try
+			{
+				if (requests[n].error != NULL)
+					std::rethrow_exception(requests[n].error);
+				PRINT_ERROR("ERROR :: Missing page was read. Exception should have been thrown before execution reaches this point.");
+			}
+			catch(const InvalidPageException &e)
+			{
+			}
+		}
+
+		//Writing a deleted page fails; writing a live one changes it
+		pagesRead[0].insertRecord("written by the engine");
+		requests[0].op = requests[1].op = IoRequest::WRITE;
+		requests[1].page = &deleted;
+		engine->run(requests, 2);
+		if (requests[0].error == NULL && requests[1].error != NULL &&
+		    file6.readPage(1).getRecord(RecordId{1, 3}) == "written by the engine")
+		{
+			file6.allocatePage();
+		}
+		else
+		{
+			PRINT_ERROR("ERROR :: Writes through the engine did not behave like File::writePage().");
+		}
+	}
+
+	//Writes through the engine to a file synced after every change do not wait for pages being allocated, nor hold them up
+	{
+		FileIoConfig config;
+		config.backend = FileIoConfig::POSITIONAL;
+		config.durability = FileIoConfig::SYNC_ALWAYS;
+		File file6 = File::open(filename6, config);
+		std::unique_ptr<IoEngine> engine(IoEngine::create());
+		Page pagesWritten[8];
+		IoRequest requests[8];
+		for (std::size_t n = 0; n < 8; n++)
+		{
+			pagesWritten[n] = file6.readPage(n + 1);
+			requests[n].op = IoRequest::WRITE;
+			requests[n].file = &file6;
+			requests[n].page = &pagesWritten[n];
+		}
+		std::thread allocator([&file6]()
+		{
+			for (int n = 0; n < 50; n++)
+				file6.allocatePage();
+		});
+		for (int round = 0; round < 20; round++)
+		{
+			engine->run(requests, 8);
+			for (std::size_t n = 0; n < 8; n++)
+			{
+				if (requests[n].error != NULL)
+				{
+					PRINT_ERROR("ERROR :: Write through the engine failed.");
+				}
+			}
+		}
+		allocator.join();
+	}
+	File::remove(filename6);
+
+	std::cout << "Test 25 passed" << "\n";
+}
+
+void test26()
+{
+	//Pages of a mapped file are handed out in place, without a copy into the buffer pool
+	const std::string filename6 = "test.6";
+	const PageId numPages = 30;
+	const std::uint32_t poolSize = 10;
+	try
+	{
+		File::remove(filename6);
+	}
+	catch(const FileNotFoundException &)
+	{
+	}
+	{
+		File file6 = File::create(filename6);
+		for (i = 0; i < numPages; i++)
+		{
+			Page written = file6.allocatePage();
+			sprintf(tmpbuf, "test.6 Page %u %7.1f", written.page_number(), (float)written.page_number());
+			written.insertRecord(tmpbuf);
+			file6.writePage(written);
+		}
+		file6.deletePage(4);
+	}
+
+	{
+		FileIoConfig config;
+		config.backend = FileIoConfig::MAPPED;
+		config.access = FileIoConfig::RANDOM;
+		File file6 = File::open(filename6, config);
+		if (!file6.mapped() || file6.mapPage(1) != file6.mapPage(1))
+		{
+			PRINT_ERROR("ERROR :: File was not mapped.");
+		}
+
+		//Twice as many pages as frames, so mapped pages are evicted too
+		BufMgr mapMgr(poolSize);
+		for (int round = 0; round < 2; round++)
+		{
+			for (PageId pageNo = 1; pageNo <= numPages; pageNo++)
+			{
+				if (pageNo == 4)
+				{
+					continue;
+				}
+				mapMgr.readPage(&file6, pageNo, page);
+				if (page >= mapMgr.bufPool && page < mapMgr.bufPool + poolSize)
+				{
+					PRINT_ERROR("ERROR :: Page of a mapped file was copied into the buffer pool.");
+				}
+				sprintf(tmpbuf, "test.6 Page %u %7.1f", pageNo, (float)pageNo);
+				if (page->getRecord(RecordId{pageNo, 1}) != tmpbuf || file6.readPage(pageNo).getRecord(RecordId{pageNo, 1}) != tmpbuf)
+				{
+					PRINT_ERROR("ERROR :: CONTENTS DID NOT MATCH");
+				}
+				//Changes made in place reach the file without being copied back
+				if (round == 0 && pageNo % 3 == 0)
+				{
+					page->insertRecord("changed in place");
+				}
+				mapMgr.unPinPage(&file6, pageNo, round == 0 && pageNo % 3 == 0);
+			}
+		}
+		try
+		{
+			mapMgr.readPage(&file6, 4, page);
+			PRINT_ERROR("ERROR :: Deleted page was read. Exception should have been thrown before execution reaches this point.");
+		}
+		catch(const InvalidPageException &e)
+		{
+		}
+		try
+		{
+			file6.mapPage(numPages + 1);
+			PRINT_ERROR("ERROR :: Page past the end of the file was mapped. Exception should have been thrown before execution reaches this point.");
+		}
+		catch(const InvalidPageException &e)
+		{
+		}
+
+		//Pages allocated after the file was mapped are reached through the mapping once written
+		PageId newPageNo;
+		mapMgr.allocPage(&file6, newPageNo, page);
+		page->insertRecord("allocated while mapped");
+		mapMgr.unPinPage(&file6, newPageNo, true);
+		mapMgr.flushFile(&file6);
+		if (file6.mapPage(newPageNo)->getRecord(RecordId{newPageNo, 1}) != "allocated while mapped")
+		{
+			PRINT_ERROR("ERROR :: CONTENTS DID NOT MATCH");
+		}
+
+		//Frames that held mapped pages go back to holding pages of their own
+		for (i = 1; i <= poolSize; i++)
+		{
+			mapMgr.readPage(file1ptr, i, page);
+			if (page < mapMgr.bufPool || page >= mapMgr.bufPool + poolSize)
+			{
+				PRINT_ERROR("ERROR :: Frame kept pointing into a mapping.");
+			}
+			mapMgr.unPinPage(file1ptr, i, false);
+		}
+		mapMgr.flushFile(file1ptr);
+	}
+
+	//The changes made in place are in the file
+	{
+		File file6 = File::open(filename6);
+		for (PageId pageNo = 3; pageNo <= numPages; pageNo += 3)
+		{
+			if (file6.readPage(pageNo).getRecord(RecordId{pageNo, 2}) != "changed in place")
+			{
+				PRINT_ERROR("ERROR :: CONTENTS DID NOT MATCH");
+			}
+		}
+	}
+
+	//Compressed files have no fixed place for their pages and are read as usual
+	File::remove(filename6);
+	{
+		FileIoConfig config;
+		config.backend = FileIoConfig::MAPPED;
+		File file6 = File::create(filename6, File::COMPRESSED, config);
+		Page written = file6.allocatePage();
+		written.insertRecord("compressed");
+		file6.writePage(written);
+		if (file6.mapped() || file6.mapPage(written.page_number()) != NULL ||
+		    file6.readPage(written.page_number()).getRecord(RecordId{written.page_number(), 1}) != "compressed")
+		{
+			PRINT_ERROR("ERROR :: Compressed file was mapped.");
+		}
+	}
+	File::remove(filename6);
+
+	//Files with checksums are copied into frames, so that a dirty page in the pool never leaves the file failing its checksum
+	{
+		FileIoConfig config;
+		config.backend = FileIoConfig::MAPPED;
+		File file6 = File::create(filename6, File::CHECKSUMS, config);
+		for (i = 0; i < 3; i++)
+		{
+			Page written = file6.allocatePage();
+			written.insertRecord("checksummed");
+			file6.writePage(written);
+		}
+		if (file6.mapped() || file6.mapPage(1) != NULL)
+		{
+			PRINT_ERROR("ERROR :: File with checksums was mapped.");
+		}
+
+		BufMgr mapMgr(poolSize);
+		mapMgr.readPage(&file6, 1, page);
+		if (page < mapMgr.bufPool || page >= mapMgr.bufPool + poolSize)
+		{
+			PRINT_ERROR("ERROR :: Page of a file with checksums was not copied into the buffer pool.");
+		}
+		page->insertRecord("dirty in the pool");
+		mapMgr.unPinPage(&file6, 1, true);
+		if (file6.readPage(1).getRecord(RecordId{1, 1}) != "checksummed")
+		{
+			PRINT_ERROR("ERROR :: CONTENTS DID NOT MATCH");
+		}
+		mapMgr.disposePage(&file6, 3);
+		mapMgr.flushFile(&file6);
+	}
+	{
+		File file6 = File::open(filename6);
+		if (file6.readPage(1).getRecord(RecordId{1, 2}) != "dirty in the pool")
+		{
+			PRINT_ERROR("ERROR :: CONTENTS DID NOT MATCH");
+		}
+	}
+	File::remove(filename6);
+
+	std::cout << "Test 26 passed" << "\n";
+}
+
+void test27()
+{
+	//Files opened with O_DIRECT are read and written whole through the buffer pool, aligned or not
+	const std::string filename7 = "test.7";
+	const PageId numPages = 20;
+	const std::uint32_t poolSize = 8;
+	const std::uint32_t flagSets[] = {File::ALIGNED, File::CHECKSUMS, 0, File::ALIGNED | File::COMPRESSED};
+	try
+	{
+		File::remove(filename7);
+	}
+	catch(const FileNotFoundException &)
+	{
+	}
+	for (std::size_t f = 0; f < sizeof(flagSets) / sizeof(flagSets[0]); f++)
+	{
+		const std::uint32_t flags = flagSets[f];
+		FileIoConfig config;
+		config.backend = FileIoConfig::DIRECT;
+		{
+			File file7 = File::create(filename7, flags, config);
+			BufMgr directMgr(poolSize);
+			PageId pageNo;
+			for (i = 0; i < numPages; i++)
+			{
+				directMgr.allocPage(&file7, pageNo, page);
+				sprintf(tmpbuf, "test.7 Page %u %7.1f", pageNo, (float)pageNo);
+				page->insertRecord(tmpbuf);
+				directMgr.unPinPage(&file7, pageNo, true);
+			}
+			directMgr.flushFile(&file7);
+			directMgr.disposePage(&file7, 5);
+
+			//Pages come back through frames, which are aligned, and through pages of the caller's, which need not be
+			for (pageNo = 1; pageNo <= numPages; pageNo++)
+			{
+				if (pageNo == 5)
+				{
+					continue;
+				}
+				directMgr.readPage(&file7, pageNo, page);
+				sprintf(tmpbuf, "test.7 Page %u %7.1f", pageNo, (float)pageNo);
+				if (page->getRecord(RecordId{pageNo, 1}) != tmpbuf || file7.readPage(pageNo).getRecord(RecordId{pageNo, 1}) != tmpbuf)
+				{
+					PRINT_ERROR("ERROR :: CONTENTS DID NOT MATCH");
+				}
+				directMgr.unPinPage(&file7, pageNo, false);
+			}
+			try
+			{
+				directMgr.readPage(&file7, numPages + 1, page);
+				PRINT_ERROR("ERROR :: Page past the end of the file was read. Exception should have been thrown before execution reaches this point.");
+			}
+			catch(const InvalidPageException &e)
+			{
+			}
+			directMgr.flushFile(&file7);
+		}
+
+		//The file holds the pages where a buffered file expects them
+		{
+			File file7 = File::open(filename7);
+			if (file7.flags() != flags || file7.aligned() != ((flags & File::ALIGNED) != 0))
+			{
+				PRINT_ERROR("ERROR :: Flags of file were not kept.");
+			}
+			for (PageId pageNo = 1; pageNo <= numPages; pageNo++)
+			{
+				sprintf(tmpbuf, "test.7 Page %u %7.1f", pageNo, (float)pageNo);
+				if (pageNo != 5 && file7.readPage(pageNo).getRecord(RecordId{pageNo, 1}) != tmpbuf)
+				{
+					PRINT_ERROR("ERROR :: CONTENTS DID NOT MATCH");
+				}
+			}
+		}
+		if (flags == File::ALIGNED)
+		{
+			std::ifstream stored(filename7, std::ios::binary | std::ios::ate);
+			if (stored.tellg() != static_cast<std::streamoff>((numPages + 1) * Page::SIZE))
+			{
+				PRINT_ERROR("ERROR :: Pages of an aligned file were not laid out one per Page::SIZE.");
+			}
+		}
+		File::remove(filename7);
+	}
+
+	//Checksums after the pages would leave them out of alignment
+	try
+	{
+		File::create(filename7, File::ALIGNED | File::CHECKSUMS);
+		PRINT_ERROR("ERROR :: Aligned file with checksums was created. Exception should have been thrown before execution reaches this point.");
+	}
+	catch(const InvalidFlagsException &e)
+	{
+	}
+	if (File::exists(filename7))
+	{
+		PRINT_ERROR("ERROR :: File with invalid flags was left behind.");
+	}
+
+	std::cout << "Test 27 passed" << "\n";
+}
+
+void test28()
+{
+	//The file header is kept in memory and written back by sync() and the last close
+	const std::string filename8 = "test.8";
+	const PageId numPages = 10;
+	//Header as it is on disk
+	auto storedHeader = [](const std::string& filename)
+	{
+		FileHeader header;
+		std::ifstream in(filename, std::ios::binary);
+		in.read(reinterpret_cast<char*>(&header), sizeof(header));
+		return header;
+	};
+	try
+	{
+		File::remove(filename8);
+	}
+	catch(const FileNotFoundException &)
+	{
+	}
+	{
+		File file8 = File::create(filename8);
+		if (storedHeader(filename8).num_pages != 1)
+		{
+			PRINT_ERROR("ERROR :: New file was not written with its header.");
+		}
+		for (i = 0; i < numPages; i++)
+		{
+			Page written = file8.allocatePage();
+			written.insertRecord("cached header");
+			file8.writePage(written);
+		}
+		if (storedHeader(filename8).num_pages != 1)
+		{
+			PRINT_ERROR("ERROR :: File header was written before a sync.");
+		}
+
+		//Other File objects for the file see the header in memory
+		{
+			File other = File::open(filename8);
+			other.deletePage(3);
+			if (other.readPage(numPages).getRecord(RecordId{numPages, 1}) != "cached header")
+			{
+				PRINT_ERROR("ERROR :: CONTENTS DID NOT MATCH");
+			}
+		}
+		try
+		{
+			file8.readPage(numPages + 1);
+			PRINT_ERROR("ERROR :: Page past the end of the file was read. Exception should have been thrown before execution reaches this point.");
+		}
+		catch(const InvalidPageException &e)
+		{
+		}
+		if (file8.begin() == file8.end() || (*file8.begin()).page_number() != 1)
+		{
+			PRINT_ERROR("ERROR :: Iteration did not start at the first used page.");
+		}
+
+		file8.sync();
+		FileHeader header = storedHeader(filename8);
+		if (header.num_pages != numPages + 1 || header.num_free_pages != 1 || header.first_free_page != 3)
+		{
+			PRINT_ERROR("ERROR :: File header was not written by sync().");
+		}
+
+		Page reused = file8.allocatePage();
+		if (reused.page_number() != 3 || storedHeader(filename8).num_free_pages != 1)
+		{
+			PRINT_ERROR("ERROR :: Free page was not reused in memory.");
+		}
+	}
+
+	//Closing the file wrote back the last change, so the file reads back as it was left
+	{
+		FileHeader header = storedHeader(filename8);
+		if (header.num_pages != numPages + 1 || header.num_free_pages != 0)
+		{
+			PRINT_ERROR("ERROR :: File header was not written on close.");
+		}
+		File file8 = File::open(filename8);
+		PageId count = 0;
+		for (FileIterator iter = file8.begin(); iter != file8.end(); ++iter)
+		{
+			count++;
+		}
+		if (count != numPages)
+		{
+			PRINT_ERROR("ERROR :: Used pages were lost.");
+		}
+	}
+
+	//Assigning a File object, to itself or from another for the same file, keeps the file open as it was
+	{
+		FileIoConfig config;
+		config.backend = FileIoConfig::POSITIONAL;
+		File file8 = File::open(filename8, config);
+		file8 = file8;
+		if (file8.io_config().backend != FileIoConfig::POSITIONAL ||
+		    file8.readPage(numPages).getRecord(RecordId{numPages, 1}) != "cached header")
+		{
+			PRINT_ERROR("ERROR :: File object assigned to itself lost its open file.");
+		}
+		{
+			File other = File::open(filename8);
+			file8 = other;
+		}
+		if (file8.io_config().backend != FileIoConfig::POSITIONAL ||
+		    file8.readPage(numPages).getRecord(RecordId{numPages, 1}) != "cached header")
+		{
+			PRINT_ERROR("ERROR :: File object assigned from another for the same file lost its open file.");
+		}
+	}
+	File::remove(filename8);
+	{
+		File file8 = File::create(filename8, File::COMPRESSED);
+		Page written = file8.allocatePage();
+		written.insertRecord("cached header");
+		file8.writePage(written);
+		file8 = file8;
+		if (file8.readPage(written.page_number()).getRecord(RecordId{written.page_number(), 1}) != "cached header")
+		{
+			PRINT_ERROR("ERROR :: Compressed file assigned to itself lost its extents.");
+		}
+	}
+	File::remove(filename8);
+
+	std::cout << "Test 28 passed" << "\n";
+}
+
+void test29()
+{
+	//Non-throwing hash table operations report hits and misses through their return value
+	BufHashTbl table(num);
+	FrameId frameNo = 12345;
+	if (table.tryLookup(file1ptr, 1, frameNo) || frameNo != 12345 || table.tryRemove(file1ptr, 1))
+	{
+		PRINT_ERROR("ERROR :: Page missing from the hash table was found.");
+	}
+	if (!table.tryInsert(file1ptr, 1, 7) || table.tryInsert(file1ptr, 1, 8))
+	{
+		PRINT_ERROR("ERROR :: Page already in the hash table was inserted again.");
+	}
+	if (!table.tryLookup(file1ptr, 1, frameNo) || frameNo != 7)
+	{
+		PRINT_ERROR("ERROR :: Page in the hash table was not found in its frame.");
+	}
+
+	//The same page number of another file is another entry
+	if (!table.tryInsert(file2ptr, 1, 9) || !table.tryLookup(file2ptr, 1, frameNo) || frameNo != 9 ||
+	    !table.tryLookup(file1ptr, 1, frameNo) || frameNo != 7)
+	{
+		PRINT_ERROR("ERROR :: Pages of different files were mixed up.");
+	}
+
+	//The throwing operations agree with them
+	try
+	{
+		table.insert(file1ptr, 1, 3);
+		PRINT_ERROR("ERROR :: Page already in the hash table was inserted again. Exception should have been thrown before execution reaches this point.");
+	}
+	catch(const HashAlreadyPresentException &e)
+	{
+	}
+	table.remove(file1ptr, 1);
+	try
+	{
+		table.lookup(file1ptr, 1, frameNo);
+		PRINT_ERROR("ERROR :: Removed page was found. Exception should have been thrown before execution reaches this point.");
+	}
+	catch(const HashNotFoundException &e)
+	{
+	}
+	if (table.tryRemove(file1ptr, 1) || !table.tryRemove(file2ptr, 1) || table.getStats().entries != 0)
+	{
+		PRINT_ERROR("ERROR :: Hash table did not end up empty.");
+	}
+
+	std::cout << "Test 29 passed" << "\n";
+}
+
+void test30()
+{
+	//Entries crowded into one partition stay reachable as others are removed from among them
+	BufHashTbl table(1);
+	std::mutex* partition = &table.partitionLatch(file1ptr, 1);
+
+	//As many as fit in the smallest partition, each displaced from its home slot by those before
+	//it, so that removals have to shift entries back; then enough to make the partition grow
+	std::vector<PageId> keySets[2];
+	table.insert(file1ptr, 1, 0);
+	keySets[0].push_back(1);
+	for (PageId pageNo = 2; keySets[0].size() < 6; pageNo++)
+	{
+		if (&table.partitionLatch(file1ptr, pageNo) != partition)
+		{
+			continue;
+		}
+		const BufHashTblStats before = table.getStats();
+		table.insert(file1ptr, pageNo, 0);
+		const BufHashTblStats after = table.getStats();
+		if (after.avgProbeLength * after.entries > before.avgProbeLength * before.entries + 1.5)
+		{
+			keySets[0].push_back(pageNo);
+		}
+		else
+		{
+			table.remove(file1ptr, pageNo);
+		}
+	}
+	for (std::size_t k = 0; k < keySets[0].size(); k++)
+	{
+		table.remove(file1ptr, keySets[0][k]);
+	}
+	for (PageId pageNo = 1; keySets[1].size() < 48; pageNo++)
+	{
+		if (&table.partitionLatch(file1ptr, pageNo) == partition)
+		{
+			keySets[1].push_back(pageNo);
+		}
+	}
+
+	for (std::size_t c = 0; c < 2; c++)
+	{
+		const std::vector<PageId>& keys = keySets[c];
+		const std::size_t count = keys.size();
+		for (std::size_t first = 0; first < count; first += (c == 0 ? 1 : 7))
+		{
+			std::vector<bool> present(count, true);
+			for (std::size_t k = 0; k < count; k++)
+			{
+				if (!table.tryInsert(file1ptr, keys[k], k))
+				{
+					PRINT_ERROR("ERROR :: Page could not be inserted into the hash table.");
+				}
+			}
+			//Remove every other entry starting at a different one each time, put half of them
+			//back in other frames, then remove everything
+			for (int pass = 0; pass < 3; pass++)
+			{
+				for (std::size_t n = 0; n < count; n++)
+				{
+					const std::size_t k = (first + n) % count;
+					if (pass == 0 && n % 2 == 0)
+					{
+						table.remove(file1ptr, keys[k]);
+						present[k] = false;
+					}
+					else if (pass == 1 && n % 4 == 0)
+					{
+						table.insert(file1ptr, keys[k], k + count);
+						present[k] = true;
+					}
+					else if (pass == 2 && present[k])
+					{
+						table.remove(file1ptr, keys[k]);
+						present[k] = false;
+					}
+					else
+					{
+						continue;
+					}
+					for (std::size_t j = 0; j < count; j++)
+					{
+						FrameId frameNo;
+						const bool found = table.tryLookup(file1ptr, keys[j], frameNo);
+						const bool reinserted = (j + count - first) % count % 4 == 0;
+						if (found != present[j] || (found && frameNo != (pass >= 1 && reinserted ? j + count : j)))
+						{
+							PRINT_ERROR("ERROR :: Hash table lost track of an entry after a removal.");
+						}
+					}
+				}
+			}
+			if (table.getStats().entries != 0)
+			{
+				PRINT_ERROR("ERROR :: Hash table did not end up empty.");
+			}
+		}
+	}
+
+	std::cout << "Test 30 passed" << "\n";
+}
+
+void test31()
+{
+	//Frames emptied by disposePage() and flushFile() take the next misses before any page is evicted
+	const std::string filename9 = "test.9";
+	const std::uint32_t poolSize = 8;
+	try
+	{
+		File::remove(filename9);
+	}
+	catch(const FileNotFoundException &)
+	{
+	}
+	{
+		File file9 = File::create(filename9);
+		BufMgr freeMgr(poolSize);
+		PageId pageNos[poolSize];
+		Page* frames[poolSize];
+		for (i = 0; i < poolSize; i++)
+		{
+			freeMgr.allocPage(&file9, pageNos[i], frames[i]);
+			frames[i]->insertRecord("free frames");
+			for (PageId j = 0; j < i; j++)
+			{
+				if (frames[j] == frames[i])
+				{
+					PRINT_ERROR("ERROR :: Two pages were given the same frame.");
+				}
+			}
+		}
+
+		//Every frame is pinned, which is known without looking at them
+		try
+		{
+			freeMgr.readPage(file1ptr, 1, page);
+			PRINT_ERROR("ERROR :: Page was read into a full pool. Exception should have been thrown before execution reaches this point.");
+		}
+		catch(const BufferExceededException &e)
+		{
+		}
+		freeMgr.unPinPage(&file9, pageNos[5], true);
+		freeMgr.readPage(file1ptr, 1, page);
+		if (page != frames[5])
+		{
+			PRINT_ERROR("ERROR :: Miss did not take the only unpinned frame.");
+		}
+		freeMgr.unPinPage(file1ptr, 1, false);
+		freeMgr.readPage(&file9, pageNos[5], frames[5]);
+		for (i = 0; i < poolSize; i++)
+		{
+			freeMgr.unPinPage(&file9, pageNos[i], true);
+		}
+
+		//A disposed page's frame takes the next miss, and every other page stays
+		freeMgr.disposePage(&file9, pageNos[3]);
+		const int reads = freeMgr.getBufStats().diskreads;
+		freeMgr.readPage(file1ptr, 1, page);
+		if (page != frames[3])
+		{
+			PRINT_ERROR("ERROR :: Miss did not reuse the frame of the disposed page.");
+		}
+		freeMgr.unPinPage(file1ptr, 1, false);
+		for (i = 0; i < poolSize; i++)
+		{
+			if (i == 3)
+			{
+				continue;
+			}
+			freeMgr.readPage(&file9, pageNos[i], page);
+			if (page != frames[i])
+			{
+				PRINT_ERROR("ERROR :: Page was evicted while a frame was free.");
+			}
+			freeMgr.unPinPage(&file9, pageNos[i], false);
+		}
+		if (freeMgr.getBufStats().diskreads != reads + 1)
+		{
+			PRINT_ERROR("ERROR :: Resident pages were read again.");
+		}
+
+		//Flushing the file frees all its frames, which the next misses fill, and page 1 of
+		//file1 stays where it is
+		freeMgr.flushFile(&file9);
+		for (PageId pageNo = 2; pageNo <= poolSize; pageNo++)
+		{
+			freeMgr.readPage(file1ptr, pageNo, page);
+			if (page == frames[3])
+			{
+				PRINT_ERROR("ERROR :: Page was evicted while a frame was free.");
+			}
+		}
+		freeMgr.readPage(file1ptr, 1, page);
+		if (page != frames[3] || freeMgr.getBufStats().diskreads != reads + (int) poolSize)
+		{
+			PRINT_ERROR("ERROR :: Page was evicted while a frame was free.");
+		}
+
+		//With the pool pinned again, nothing more fits
+		try
+		{
+			freeMgr.readPage(&file9, pageNos[0], page);
+			PRINT_ERROR("ERROR :: Page was read into a full pool. Exception should have been thrown before execution reaches this point.");
+		}
+		catch(const BufferExceededException &e)
+		{
+		}
+		for (PageId pageNo = 1; pageNo <= poolSize; pageNo++)
+		{
+			freeMgr.unPinPage(file1ptr, pageNo, false);
+		}
+		freeMgr.flushFile(file1ptr);
+	}
+	File::remove(filename9);
+
+	std::cout << "Test 31 passed" << "\n";
+}
+
+void test32()
+{
+	//Every file has a versioned header, checked when it is opened; files from before it are refused
+	const std::string filename10 = "test.10";
+	try
+	{
+		File::remove(filename10);
+	}
+	catch(const FileNotFoundException &)
+	{
+	}
+	{
+		File file10 = File::create(filename10);
+		for (i = 0; i < 2; i++)
+		{
+			Page written = file10.allocatePage();
+			written.insertRecord("no flags");
+			file10.writePage(written);
+		}
+	}
+	{
+		std::ifstream stored(filename10, std::ios::binary | std::ios::ate);
+		if (stored.tellg() != static_cast<std::streamoff>(sizeof(FileHeader) + 2 * Page::SIZE))
+		{
+			PRINT_ERROR("ERROR :: File without flags was not laid out one page after the other.");
+		}
+	}
+	{
+		File file10 = File::open(filename10);
+		if (file10.flags() != 0 || file10.readPage(2).getRecord(RecordId{2, 1}) != "no flags")
+		{
+			PRINT_ERROR("ERROR :: File without flags did not read back.");
+		}
+	}
+	File::remove(filename10);
+
+	//A file of version 0 stored only the fields before magic, then its pages with their shorter header
+	{
+		const FileHeader plain = {2, 1, 0, 0, 0, 0, 0};
+		const std::uint16_t bounds[] = {6, 8176 - 8};
+		std::ofstream stored(filename10, std::ios::binary);
+		stored.write(reinterpret_cast<const char*>(&plain), offsetof(FileHeader, magic));
+		stored.write(reinterpret_cast<const char*>(bounds), sizeof(bounds));
+		stored.write(std::string(8192 - sizeof(bounds), '\0').data(), 8192 - sizeof(bounds));
+	}
+	try
+	{
+		File::open(filename10);
+		PRINT_ERROR("ERROR :: File of version 0 was opened. Exception should have been thrown before execution reaches this point.");
+	}
+	catch(const FileVersionException &e)
+	{
+	}
+	if (File::isOpen(filename10))
+	{
+		PRINT_ERROR("ERROR :: File of version 0 was left open.");
+	}
+	File::remove(filename10);
+
+	{
+		File file10 = File::create(filename10, File::CHECKSUMS);
+		Page written = file10.allocatePage();
+		written.insertRecord("flags");
+		file10.writePage(written);
+	}
+	FileHeader header;
+	{
+		std::ifstream stored(filename10, std::ios::binary);
+		stored.read(reinterpret_cast<char*>(&header), sizeof(header));
+	}
+	if (header.magic != FileHeader::MAGIC || header.version != FileHeader::VERSION || header.flags != File::CHECKSUMS)
+	{
+		PRINT_ERROR("ERROR :: File with flags was not written with a versioned header.");
+	}
+
+	//A version or flag that is not known is refused, and leaves the file closed
+	auto storeHeader = [&filename10](const FileHeader& stored)
+	{
+		std::fstream onDisk(filename10, std::ios::in | std::ios::out | std::ios::binary);
+		onDisk.write(reinterpret_cast<const char*>(&stored), sizeof(stored));
+	};
+	FileHeader changed = header;
+	changed.version = FileHeader::VERSION + 1;
+	storeHeader(changed);
+	try
+	{
+		File::open(filename10);
+		PRINT_ERROR("ERROR :: File of an unknown version was opened. Exception should have been thrown before execution reaches this point.");
+	}
+	catch(const FileVersionException &e)
+	{
+	}
+	changed = header;
+	changed.flags |= 0x80;
+	storeHeader(changed);
+	try
+	{
+		File::open(filename10);
+		PRINT_ERROR("ERROR :: File with an unknown flag was opened. Exception should have been thrown before execution reaches this point.");
+	}
+	catch(const InvalidFlagsException &e)
+	{
+	}
+	if (File::isOpen(filename10))
+	{
+		PRINT_ERROR("ERROR :: File that was refused was left open.");
+	}
+	storeHeader(header);
+	{
+		File file10 = File::open(filename10);
+		if (file10.flags() != File::CHECKSUMS || file10.readPage(1).getRecord(RecordId{1, 1}) != "flags")
+		{
+			PRINT_ERROR("ERROR :: File with flags did not read back.");
+		}
+	}
+	File::remove(filename10);
+
+	try
+	{
+		File::create(filename10, 0x80);
+		PRINT_ERROR("ERROR :: File with an unknown flag was created. Exception should have been thrown before execution reaches this point.");
+	}
+	catch(const InvalidFlagsException &e)
+	{
+	}
+
+	//Closing explicitly lets go of the file once, and the last File object closes it
+	{
+		File file10 = File::create(filename10);
+		File other = File::open(filename10);
+		file10.allocatePage();
+		file10.close();
+		file10.close();
+		if (!File::isOpen(filename10))
+		{
+			PRINT_ERROR("ERROR :: File was closed while another File object used it.");
+		}
+		other.close();
+		if (File::isOpen(filename10))
+		{
+			PRINT_ERROR("ERROR :: File was left open after its last File object closed.");
+		}
+		try
+		{
+			File::open(filename10).readPage(1);
+		}
+		catch(const InvalidPageException &e)
+		{
+			PRINT_ERROR("ERROR :: Closed file did not write back its header.");
+		}
+	}
+	File::remove(filename10);
+
+	std::cout << "Test 32 passed" << "\n";
+}
+
+void test33()
+{
+	//A victim that cannot be written back keeps its frame and stays dirty
+	const std::string filename11 = "test.11";
+	try
+	{
+		File::remove(filename11);
+	}
+	catch(const FileNotFoundException &)
+	{
+	}
+	{
+		File file11 = File::create(filename11);
+		PageId pageNo;
+		for (i = 0; i < 2; i++)
+			file11.allocatePage();
+
+		BufMgr evictMgr(1);
+		evictMgr.readPage(&file11, 1, page);
+		evictMgr.unPinPage(&file11, 1, true);
+		//Page 1 is deleted behind the buffer manager, so writing it back fails
+		file11.deletePage(1);
+		try
+		{
+			evictMgr.readPage(&file11, 2, page);
+			PRINT_ERROR("ERROR :: Deleted page was written back. Exception should have been thrown before execution reaches this point.");
+		}
+		catch(const InvalidPageException &e)
+		{
+		}
+
+		//Once the page exists again, the next miss writes it back
+		pageNo = file11.allocatePage().page_number();
+		if (pageNo != 1)
+		{
+			PRINT_ERROR("ERROR :: Deleted page was not reused.");
+		}
+		evictMgr.readPage(&file11, 2, page);
+		if (evictMgr.getBufStats().diskwrites != 1)
+		{
+			PRINT_ERROR("ERROR :: Victim did not stay dirty after its write back failed.");
+		}
+		evictMgr.unPinPage(&file11, 2, false);
+		evictMgr.flushFile(&file11);
+	}
+	File::remove(filename11);
 
+	std::cout << "Test 33 passed" << "\n";
 }
@@ -6,6 +6,7 @@
  */
 
 #include <cassert>
+#include <cstring>
 
 #include "exceptions/insufficient_space_exception.h"
 #include "exceptions/invalid_record_exception.h"
@@ -13,6 +14,7 @@
 #include "exceptions/slot_in_use_exception.h"
 #include "page_iterator.h"
 #include "page.h"
+#include "slot_scan.h"
 
 namespace badgerdb {
 
@@ -21,46 +23,123 @@ Page::Page() {
 }
 
 void Page::initialize() {
+  // Clear padding as well, since the header is written to disk as is.
+  std::memset(&header_, 0, sizeof(header_));
   header_.free_space_lower_bound = 0;
   header_.free_space_upper_bound = DATA_SIZE;
   header_.num_slots = 0;
   header_.num_free_slots = 0;
   header_.current_page_number = INVALID_NUMBER;
   header_.next_page_number = INVALID_NUMBER;
-  data_.assign(DATA_SIZE, char());
+  header_.fragmented_bytes = 0;
+  header_.first_free_slot = INVALID_SLOT;
+  std::memset(data_, 0, DATA_SIZE);
 }
 
 RecordId Page::insertRecord(const std::string& record_data) {
-  if (!hasSpaceForRecord(record_data)) {
+  return insertRecord(record_data.data(), record_data.length());
+}
+
+RecordId Page::insertRecord(const char* record_data,
+                            const std::size_t record_length) {
+  if (!hasSpaceForRecord(record_length)) {
     throw InsufficientSpaceException(
-        page_number(), record_data.length(), getFreeSpace());
+        page_number(), record_length, getFreeSpace());
   }
+  reserveContiguousSpace(
+      record_length + (header_.num_free_slots == 0 ? sizeof(PageSlot) : 0));
   const SlotId slot_number = getAvailableSlot();
-  insertRecordInSlot(slot_number, record_data);
+  insertRecordInSlot(slot_number, record_data, record_length);
   return {page_number(), slot_number};
 }
 
+std::size_t Page::insertRecords(const RecordView* records,
+                               const std::size_t num_records,
+                               RecordId* record_ids) {
+  loadFreeSlotList();
+  // Count the records that fit, reusing free slots before allocating new ones.
+  const std::size_t free_space = getFreeSpace();
+  std::size_t remaining_space = free_space;
+  std::size_t reusable_slots = header_.num_free_slots;
+  std::size_t count = 0;
+  for (; count < num_records; ++count) {
+    std::size_t record_size = records[count].length();
+    if (reusable_slots > 0) {
+      --reusable_slots;
+    } else {
+      record_size += sizeof(PageSlot);
+    }
+    if (record_size > remaining_space) {
+      break;
+    }
+    remaining_space -= record_size;
+  }
+  reserveContiguousSpace(free_space - remaining_space);
+
+  for (std::size_t i = 0; i < count; ++i) {
+    SlotId slot_number = header_.first_free_slot;
+    if (slot_number != INVALID_SLOT) {
+      unlinkFreeSlot(slot_number);
+      --header_.num_free_slots;
+    } else {
+      slot_number = ++header_.num_slots;
+      header_.free_space_lower_bound += sizeof(PageSlot);
+    }
+    PageSlot* slot = getSlot(slot_number);
+    slot->used = true;
+    slot->item_length = records[i].length();
+    slot->item_offset = header_.free_space_upper_bound - slot->item_length;
+    header_.free_space_upper_bound = slot->item_offset;
+    std::memcpy(&data_[slot->item_offset], records[i].data(),
+                slot->item_length);
+    if (record_ids != NULL) {
+      record_ids[i] = {page_number(), slot_number};
+    }
+  }
+  return count;
+}
+
 std::string Page::getRecord(const RecordId& record_id) const {
+  return getRecordView(record_id).toString();
+}
+
+RecordView Page::getRecordView(const RecordId& record_id) const {
   validateRecordId(record_id);
   const PageSlot& slot = getSlot(record_id.slot_number);
-  return data_.substr(slot.item_offset, slot.item_length);
+  return RecordView(&data_[slot.item_offset], slot.item_length);
 }
 
 void Page::updateRecord(const RecordId& record_id,
                         const std::string& record_data) {
+  updateRecord(record_id, record_data.data(), record_data.length());
+}
+
+void Page::updateRecord(const RecordId& record_id, const char* record_data,
+                        const std::size_t record_length) {
   validateRecordId(record_id);
-  const PageSlot* slot = getSlot(record_id.slot_number);
+  PageSlot* slot = getSlot(record_id.slot_number);
   const std::size_t free_space_after_delete =
       getFreeSpace() + slot->item_length;
-  if (record_data.length() > free_space_after_delete) {
+  if (record_length > free_space_after_delete) {
     throw InsufficientSpaceException(
-        page_number(), record_data.length(), free_space_after_delete);
+        page_number(), record_length, free_space_after_delete);
+  }
+  if (record_length <= slot->item_length) {
+    // Shrinking or same-size records are rewritten where they are, leaving
+    // the unused tail as fragmented space.
+    std::memmove(&data_[slot->item_offset], record_data, record_length);
+    std::memset(&data_[slot->item_offset + record_length], 0,
+                slot->item_length - record_length);
+    header_.fragmented_bytes += slot->item_length - record_length;
+    slot->item_length = record_length;
+    return;
   }
   // We have to disallow slot compaction here because we're going to place the
   // record data in the same slot, and compaction might delete the slot if we
   // permit it.
   deleteRecord(record_id, false /* allow_slot_compaction */);
-  insertRecordInSlot(record_id.slot_number, record_data);
+  reserveContiguousSpace(record_length);
+  insertRecordInSlot(record_id.slot_number, record_data, record_length);
 }
 
 void Page::deleteRecord(const RecordId& record_id) {
@@ -70,60 +149,82 @@ void Page::deleteRecord(const RecordId& record_id) {
 void Page::deleteRecord(const RecordId& record_id,
                         const bool allow_slot_compaction) {
   validateRecordId(record_id);
+  loadFreeSlotList();
   PageSlot* slot = getSlot(record_id.slot_number);
-  data_.replace(slot->item_offset, slot->item_length, slot->item_length, '\0');
+  std::memset(&data_[slot->item_offset], 0, slot->item_length);
 
-  // Compact the data by removing the hole left by this record (if necessary).
-  std::uint16_t move_offset = slot->item_offset; 
-  std::size_t move_bytes = 0;
-  for (SlotId i = 1; i <= header_.num_slots; ++i) {
-    PageSlot* other_slot = getSlot(i);
-    if (other_slot->used && other_slot->item_offset < slot->item_offset) {
-      if (other_slot->item_offset < move_offset) {
-        move_offset = other_slot->item_offset;
-      }
-      move_bytes += other_slot->item_length;
-      // Update the slot for the other data to reflect the soon-to-be-new
-      // location.
-      other_slot->item_offset += slot->item_length;
-    }
-  }
-  // If we have data to move, shift it to the right.
-  if (move_bytes > 0) {
-    const std::string& data_to_move = data_.substr(move_offset, move_bytes);
-    data_.replace(move_offset + slot->item_length, move_bytes, data_to_move);
+  // Leave the hole for the next compaction, unless the record borders the free
+  // space.
+  if (slot->item_offset == header_.free_space_upper_bound) {
+    header_.free_space_upper_bound += slot->item_length;
+  } else {
+    header_.fragmented_bytes += slot->item_length;
   }
-  header_.free_space_upper_bound += slot->item_length;
 
   // Mark slot as unused.
   slot->used = false;
-  slot->item_offset = 0;
-  slot->item_length = 0;
   ++header_.num_free_slots;
+  pushFreeSlot(record_id.slot_number);
 
   if (allow_slot_compaction && record_id.slot_number == header_.num_slots) {
     // Last slot in the list, so we need to free any unused slots that are at
-    // the end of the slot list.
-    int num_slots_to_delete = 1;
-    for (SlotId i = 1; i < header_.num_slots; ++i) {
-      // Traverse list backwards, looking for unused slots.
-      const PageSlot* other_slot = getSlot(header_.num_slots - i);
-      if (!other_slot->used) {
-        ++num_slots_to_delete;
-      } else {
-        // Stop at the first used slot we find, since we can't move used slots
-        // without affecting record IDs.
-        break;
+    // the end of the slot list.  We stop at the first used slot we find, since
+    // we can't move used slots without affecting record IDs.
+    while (header_.num_slots > 0 && !getSlot(header_.num_slots)->used) {
+      unlinkFreeSlot(header_.num_slots);
+      std::memset(getSlot(header_.num_slots), 0, sizeof(PageSlot));
+      --header_.num_slots;
+      --header_.num_free_slots;
+      header_.free_space_lower_bound -= sizeof(PageSlot);
+    }
+  }
+
+  if (header_.num_free_slots == header_.num_slots) {
+    // No records left, and deleted records have been zeroed, so all of the
+    // data area is free space again.
+    header_.free_space_upper_bound = DATA_SIZE;
+    header_.fragmented_bytes = 0;
+  }
+}
+
+void Page::compact() {
+  const std::uint16_t old_upper_bound = header_.free_space_upper_bound;
+  char records[DATA_SIZE];
+  std::memcpy(&records[old_upper_bound], &data_[old_upper_bound],
+              DATA_SIZE - old_upper_bound);
+  // Records which lie back to back in slot order are moved together.
+  std::size_t offset = DATA_SIZE;
+  std::size_t run_offset = DATA_SIZE;
+  std::size_t run_source = DATA_SIZE;
+  for (SlotId i = 1; i <= header_.num_slots; ++i) {
+    PageSlot* slot = getSlot(i);
+    if (!slot->used) {
+      continue;
+    }
+    if (slot->item_offset + slot->item_length != run_source) {
+      if (offset != run_source) {
+        std::memcpy(&data_[offset], &records[run_source], run_offset - offset);
       }
+      run_offset = offset;
     }
-    header_.num_slots -= num_slots_to_delete;
-    header_.num_free_slots -= num_slots_to_delete;
-    header_.free_space_lower_bound -= sizeof(PageSlot) * num_slots_to_delete;
+    offset -= slot->item_length;
+    run_source = slot->item_offset;
+    slot->item_offset = offset;
   }
+  if (offset != run_source) {
+    std::memcpy(&data_[offset], &records[run_source], run_offset - offset);
+  }
+  std::memset(&data_[old_upper_bound], 0, offset - old_upper_bound);
+  header_.free_space_upper_bound = offset;
+  header_.fragmented_bytes = 0;
 }
 
 bool Page::hasSpaceForRecord(const std::string& record_data) const {
-  std::size_t record_size = record_data.length();
+  return hasSpaceForRecord(record_data.length());
+}
+
+bool Page::hasSpaceForRecord(const std::size_t record_length) const {
+  std::size_t record_size = record_length;
   if (header_.num_free_slots == 0) {
     record_size += sizeof(PageSlot);
   }
@@ -138,32 +239,76 @@ const PageSlot& Page::getSlot(const SlotId slot_number) const {
   return *reinterpret_cast<const PageSlot*>(&data_[(slot_number - 1) * sizeof(PageSlot)]);
 }
 
+void Page::pushFreeSlot(const SlotId slot_number) {
+  PageSlot* slot = getSlot(slot_number);
+  slot->item_offset = header_.first_free_slot;
+  slot->item_length = INVALID_SLOT;
+  if (header_.first_free_slot != INVALID_SLOT) {
+    getSlot(header_.first_free_slot)->item_length = slot_number;
+  }
+  header_.first_free_slot = slot_number;
+}
+
+void Page::unlinkFreeSlot(const SlotId slot_number) {
+  const PageSlot* slot = getSlot(slot_number);
+  const SlotId next = slot->item_offset;
+  const SlotId previous = slot->item_length;
+  if (previous == INVALID_SLOT) {
+    header_.first_free_slot = next;
+  } else {
+    getSlot(previous)->item_offset = next;
+  }
+  if (next != INVALID_SLOT) {
+    getSlot(next)->item_length = previous;
+  }
+}
+
+void Page::loadFreeSlotList() {
+  if (header_.num_free_slots == 0 ||
+      header_.first_free_slot != INVALID_SLOT) {
+    return;
+  }
+  // Link the free slots in slot order so that the lowest is reused first.
+  const PageSlot* slots = getSlot(1);
+  SlotId previous = INVALID_SLOT;
+  for (SlotId i = SlotScan::nextFree(slots, header_.num_slots, INVALID_SLOT);
+       i != INVALID_SLOT;
+       i = SlotScan::nextFree(slots, header_.num_slots, i)) {
+    PageSlot* slot = getSlot(i);
+    slot->item_offset = INVALID_SLOT;
+    slot->item_length = previous;
+    if (previous == INVALID_SLOT) {
+      header_.first_free_slot = i;
+    } else {
+      getSlot(previous)->item_offset = i;
+    }
+    previous = i;
+  }
+}
+
 SlotId Page::getAvailableSlot() {
   SlotId slot_number = INVALID_SLOT;
   if (header_.num_free_slots > 0) {
-    // Have an allocated but unused slot that we can reuse.
-    for (SlotId i = 1; i <= header_.num_slots; ++i) {
-      const PageSlot* slot = getSlot(i);
-      if (!slot->used) {
-        // We don't decrement the number of free slots until someone actually
-        // puts data in the slot.
-        slot_number = i;
-        break;
-      }
-    }
+    // Have an allocated but unused slot that we can reuse.  We don't take it
+    // off the free list until someone actually puts data in the slot.
+    loadFreeSlotList();
+    slot_number = header_.first_free_slot;
   } else {
     // Have to allocate a new slot.
     slot_number = header_.num_slots + 1;
     ++header_.num_slots;
     ++header_.num_free_slots;
     header_.free_space_lower_bound = sizeof(PageSlot) * header_.num_slots;
+    getSlot(slot_number)->used = false;
+    pushFreeSlot(slot_number);
   }
   assert(slot_number != INVALID_SLOT);
   return slot_number;
 }
 
 void Page::insertRecordInSlot(const SlotId slot_number,
-                              const std::string& record_data) {
+                              const char* record_data,
+                              const std::size_t record_length) {
   if (slot_number > header_.num_slots ||
       slot_number == INVALID_SLOT) {
     throw InvalidSlotException(page_number(), slot_number);
@@ -172,19 +317,24 @@ void Page::insertRecordInSlot(const SlotId slot_number,
   if (slot->used) {
     throw SlotInUseException(page_number(), slot_number);
   }
-  const int record_length = record_data.length();
+  loadFreeSlotList();
+  unlinkFreeSlot(slot_number);
   slot->used = true;
   slot->item_length = record_length;
   slot->item_offset = header_.free_space_upper_bound - record_length;
   header_.free_space_upper_bound = slot->item_offset;
   --header_.num_free_slots;
-  data_.replace(slot->item_offset, slot->item_length, record_data);
+  std::memcpy(&data_[slot->item_offset], record_data, slot->item_length);
 }
 
 void Page::validateRecordId(const RecordId& record_id) const {
   if (record_id.page_number != page_number()) {
     throw InvalidRecordException(record_id, page_number());
   }
+  if (record_id.slot_number == INVALID_SLOT ||
+      record_id.slot_number > header_.num_slots) {
+    throw InvalidRecordException(record_id, page_number());
+  }
   const PageSlot& slot = getSlot(record_id.slot_number);
   if (!slot.used) {
     throw InvalidRecordException(record_id, page_number());
@@ -200,4 +350,12 @@ PageIterator Page::end() {
   return PageIterator(this, end_record_id);
 }
 
+RecordViewIterator Page::beginViews() {
+  return RecordViewIterator(begin());
+}
+
+RecordViewIterator Page::endViews() {
+  return RecordViewIterator(end());
+}
+
 }
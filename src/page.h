@@ -11,7 +11,9 @@
 #include <stdint.h>
 #include <memory>
 #include <string>
+#include <type_traits>
 
+#include "record_view.h"
 #include "types.h"
 
 namespace badgerdb {
@@ -57,6 +59,21 @@ struct PageHeader {
    */
   PageId next_page_number;
 
+  /**
+   * Number of bytes in the data area, at or above the free space upper bound,
+   * which belong to deleted or shrunk records.  They are reclaimed when the
+   * page is compacted.
+   */
+  std::uint16_t fragmented_bytes;
+
+  /**
+   * First slot in the list of allocated but unused slots, or
+   * Page::INVALID_SLOT if there are none.  A page with free slots but no list,
+   * whose header has this INVALID_SLOT, gets the list built the first time it
+   * is needed.
+   */
+  SlotId first_free_slot;
+
   /**
    * Returns true if this page header is equal to the other.
    *
@@ -82,17 +99,22 @@ struct PageSlot {
   bool used;
 
   /**
-   * Offset of the data item in the page.
+   * Offset of the data item in the page.  For an unused slot, the number of
+   * the next slot in the free slot list.
    */
   std::uint16_t item_offset;
 
   /**
-   * Length of the data item in this slot.
+   * Length of the data item in this slot.  For an unused slot, the number of
+   * the previous slot in the free slot list.
    */
   std::uint16_t item_length;
 };
 
 class PageIterator;
+class RecordViewIterator;
+template <std::size_t RecordSize> class FixedPage;
+class PaxPage;
 
 /**
  * @brief Class which represents a fixed-size database page containing records.
@@ -102,6 +124,10 @@ class PageIterator;
  * slots and identified by a RecordId.  Although a record's actual contents may
  * be moved on the page, accessing a record by its slot is consistent.
  *
+ * A page is a single block of SIZE bytes, header followed by data, with no
+ * indirection, so it is trivially copyable and can be read from or written to
+ * disk as is.
+ *
  * @warning This class is not threadsafe.
  */
 class Page {
@@ -117,6 +143,11 @@ class Page {
    */
   static const std::size_t DATA_SIZE = SIZE - sizeof(PageHeader);
 
+  /**
+   * Alignment of pages in the buffer pool, suitable for direct I/O.
+   */
+  static const std::size_t ALIGNMENT = 4096;
+
   /**
    * Number of page indicating that it's invalid.
    */
@@ -140,6 +171,32 @@ class Page {
    */
   RecordId insertRecord(const std::string& record_data);
 
+  /**
+   * Inserts a new record into the page.  The bytes must not lie on this page.
+   *
+   * @param record_data    First byte of the record.
+   * @param record_length  Length of the record in bytes.
+   * @return  ID of the newly inserted record.
+   */
+  RecordId insertRecord(const char* record_data,
+                        const std::size_t record_length);
+
+  /**
+   * Inserts records from the front of a batch, in order, until the next one
+   * does not fit.  Free space is checked and the page compacted at most once
+   * for the whole batch.  The bytes must not lie on this page.
+   *
+   * @param records      Records to insert.
+   * @param num_records  Number of records in the batch.
+   * @param record_ids   If not NULL, receives the IDs of the inserted records,
+   *                     in order; must have room for <num_records> IDs.
+   * @return  Number of records inserted, which is less than <num_records> if
+   *          the page filled up.
+   */
+  std::size_t insertRecords(const RecordView* records,
+                            const std::size_t num_records,
+                            RecordId* record_ids = NULL);
+
   /**
    * Returns the record with the given ID.  Returned data is a copy of what is
    * stored on the page; use updateRecord to change it.
@@ -150,6 +207,17 @@ class Page {
    */
   std::string getRecord(const RecordId& record_id) const;
 
+  /**
+   * Returns a view of the record with the given ID, without copying it.  The
+   * view points into this page and is only valid while the page stays pinned
+   * and until the next insert, update, or delete on the page.
+   *
+   * @see RecordView
+   * @param record_id  ID of the record to return.
+   * @return  View of the record.
+   */
+  RecordView getRecordView(const RecordId& record_id) const;
+
   /**
    * Updates the record with the given ID, replacing its data with a new
    * version.  This is equivalent to deleting the old record and inserting a
@@ -161,9 +229,21 @@ class Page {
   void updateRecord(const RecordId& record_id, const std::string& record_data);
 
   /**
-   * Deletes the record with the given ID.  Page is compacted upon delete to
-   * ensure that data of all records is contiguous.  Slot array is compacted if
-   * the slot deleted is at the end of the slot array.
+   * Updates the record with the given ID, replacing its data with a new
+   * version.  The bytes must not lie on this page.
+   *
+   * @param record_id      ID of record to update.
+   * @param record_data    First byte of the updated record.
+   * @param record_length  Length of the updated record in bytes.
+   */
+  void updateRecord(const RecordId& record_id, const char* record_data,
+                    const std::size_t record_length);
+
+  /**
+   * Deletes the record with the given ID.  The record's bytes are not
+   * reclaimed until an insert or update needs contiguous space and compacts
+   * the page.  Slot array is compacted if the slot deleted is at the end of
+   * the slot array.
    *
    * @param record_id   ID of the record to delete.
    */
@@ -178,12 +258,22 @@ class Page {
   bool hasSpaceForRecord(const std::string& record_data) const;
 
   /**
-   * Returns this page's free space in bytes.
+   * Returns true if the page has enough free space to hold a record of the
+   * given length.
+   *
+   * @param record_length Length of the record in bytes.
+   * @return  Whether the page can hold the record.
+   */
+  bool hasSpaceForRecord(const std::size_t record_length) const;
+
+  /**
+   * Returns this page's free space in bytes, including the space left by
+   * deleted records that has not been compacted yet.
    *
    * @return  Free space in bytes.
    */
-  std::uint16_t getFreeSpace() const { return header_.free_space_upper_bound -
-                                              header_.free_space_lower_bound; }
+  std::uint16_t getFreeSpace() const { return getContiguousFreeSpace() +
+                                              header_.fragmented_bytes; }
 
   /**
    * Returns this page's number in its file.
@@ -214,6 +304,23 @@ class Page {
    */
   PageIterator end();
 
+  /**
+   * Returns an iterator at the first record in the page which yields record
+   * IDs and views of the records rather than copies.
+   *
+   * @return  Iterator at first record of page.
+   */
+  RecordViewIterator beginViews();
+
+  /**
+   * Returns an iterator representing the record after the last record in the
+   * page, for iterating with beginViews().  This iterator should not be
+   * dereferenced.
+   *
+   * @return  Iterator representing record after the last record in the page.
+   */
+  RecordViewIterator endViews();
+
  private:
   /**
    * Initializes this page as a new page with no header information or data.
@@ -239,10 +346,10 @@ class Page {
   }
 
   /**
-   * Deletes the record with the given ID.  Page is compacted upon delete to
-   * ensure that data of all records is contiguous.  Slot array is compacted if
-   * the slot deleted is at the end of the slot array and
-   * <allow_slot_compaction> is set.
+   * Deletes the record with the given ID.  The record's bytes are counted as
+   * fragmented rather than reclaimed.  Slot array is compacted if the slot
+   * deleted is at the end of the slot array and <allow_slot_compaction> is
+   * set.
    *
    * @param record_id             ID of the record to delete.
    * @param allow_slot_compaction If true, the slot array will be compacted if
@@ -251,6 +358,34 @@ class Page {
   void deleteRecord(const RecordId& record_id,
                     const bool allow_slot_compaction);
 
+  /**
+   * Returns the free space between the slot array and the record data, which
+   * can be used without compacting the page.
+   *
+   * @return  Contiguous free space in bytes.
+   */
+  std::uint16_t getContiguousFreeSpace() const {
+    return header_.free_space_upper_bound - header_.free_space_lower_bound;
+  }
+
+  /**
+   * Compacts the page if it has less than the given contiguous free space.
+   *
+   * @param bytes   Contiguous free space needed.
+   */
+  void reserveContiguousSpace(const std::size_t bytes) {
+    if (bytes > getContiguousFreeSpace()) {
+      compact();
+    }
+  }
+
+  /**
+   * Moves all records to the end of the data area, in the order of their
+   * slots, so that all free space lies between the slot array and the record
+   * data.  Record IDs do not change.
+   */
+  void compact();
+
   /**
    * Returns the slot with the given number.  This method will return
    * unallocated slots if requested; it is up to the caller to ensure they
@@ -271,14 +406,34 @@ class Page {
    */
   const PageSlot& getSlot(const SlotId slot_number) const;
 
+  /**
+   * Adds the given unused slot to the front of the free slot list.
+   *
+   * @param slot_number   Number of slot to add.
+   */
+  void pushFreeSlot(const SlotId slot_number);
+
+  /**
+   * Removes the given unused slot from the free slot list.
+   *
+   * @param slot_number   Number of slot to remove.
+   */
+  void unlinkFreeSlot(const SlotId slot_number);
+
+  /**
+   * Builds the free slot list of a page written before the list was kept.
+   * Does nothing if the page already has its list.
+   */
+  void loadFreeSlotList();
+
   /**
    * Returns the slot number of an available slot.  If no slots are available
    * to be reused, allocates a new slot.  Updates available slot count in the
    * header metadata, but does not mark returned slot as used.  If a new slot is
    * allocated, updates the free space lower bound.
    *
-   * Callers are responsible for making sure there is enough space to allocate a
-   * new slot before calling this method.
+   * Callers are responsible for making sure there is enough contiguous space
+   * to allocate a new slot before calling this method.
    *
    * Since the returned slot is not marked as used, callers must take care to
    * fill the slot or mark it used before someone else calls this method.
@@ -291,17 +446,18 @@ class Page {
    * Inserts record data into the given slot.  The slot should not be currently
    * in use.  <slot_number> must be less than <header_.num_slots>.
    *
-   * Callers are responsible for making sure there is enough space to hold the
-   * record before calling this method.
+   * Callers are responsible for making sure there is enough contiguous space
+   * to hold the record before calling this method.
    *
    * @param slot_number   Number of slot to insert record into.
-   * @param record_data   Bytes that compose the record.
+   * @param record_data   First byte of the record.
+   * @param record_length Length of the record in bytes.
    * @throws  InvalidSlotException  Thrown when given slot number refers to an
    *                                unallocated slot.
    * @throws  SlotInUseException  Thrown when given slot is in use.
    */
-  void insertRecordInSlot(const SlotId slot_number,
-                          const std::string& record_data);
+  void insertRecordInSlot(const SlotId slot_number, const char* record_data,
+                          const std::size_t record_length);
 
   /**
    * Throws an exception if the given record ID is not valid for this page
@@ -329,11 +485,12 @@ class Page {
    * Data stored on the page.  Includes bookkeeping information about slots as
    * well as actual content.
    */
-
-  std::string data_;
+  char data_[DATA_SIZE];
 
   friend class File;
   friend class PageIterator;
+  template <std::size_t RecordSize> friend class FixedPage;
+  friend class PaxPage;
   friend class PageTest;
   friend class BufferTest;
 };
@@ -342,5 +499,11 @@ static_assert(Page::SIZE > sizeof(PageHeader),
               "Page size must be large enough to hold header and data.");
 static_assert(Page::DATA_SIZE > 0,
               "Page must have some space to hold data.");
+static_assert(sizeof(Page) == Page::SIZE,
+              "Page must be stored inline, header followed by data.");
+static_assert(std::is_trivially_copyable<Page>::value,
+              "Page must be copyable as a block of bytes.");
+static_assert(Page::SIZE % Page::ALIGNMENT == 0,
+              "Aligned pages must stay aligned when laid out back to back.");
 
 }
@@ -0,0 +1,46 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#include "page_handle.h"
+
+#include "buffer.h"
+
+namespace badgerdb {
+
+PageHandle::~PageHandle() noexcept {
+  try {
+    release();
+  } catch (...) {
+    // a destructor must not throw; callers wanting the error call release()
+  }
+}
+
+PageHandle& PageHandle::operator=(PageHandle&& other) {
+  if (this != &other) {
+    release();
+    buf_mgr_ = other.buf_mgr_;
+    frame_ = other.frame_;
+    generation_ = other.generation_;
+    page_ = other.page_;
+    dirty_ = other.dirty_;
+    other.buf_mgr_ = NULL;
+    other.page_ = NULL;
+  }
+  return *this;
+}
+
+void PageHandle::release() {
+  if (page_ == NULL) {
+    return;
+  }
+  BufMgr* buf_mgr = buf_mgr_;
+  buf_mgr_ = NULL;
+  page_ = NULL;
+  buf_mgr->unPinFrame(frame_, generation_, dirty_);
+}
+
+}
@@ -0,0 +1,159 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "page.h"
+#include "types.h"
+
+namespace badgerdb {
+
+class BufMgr;
+
+/**
+ * @brief A pin on a page in the buffer pool, released when the handle is
+ * destroyed.
+ *
+ * Returned by the BufMgr::readPage() and BufMgr::allocPage() overloads that do
+ * not take a page pointer.  The handle remembers the frame holding the page
+ * and the frame's generation, so unpinning needs no hash table lookup, and a
+ * pin is never leaked when an
+ * exception unwinds the caller.  Handles can be moved but not copied; a
+ * moved-from handle is empty.  The buffer manager must outlive its handles.
+ *
+ * If the page is disposed of while the handle holds it, the pin goes with it
+ * and releasing the handle does nothing, even if the frame holds another page
+ * by then.
+ */
+class PageHandle {
+ public:
+  /**
+   * Constructs an empty handle.
+   */
+  PageHandle()
+      : buf_mgr_(NULL),
+        frame_(0),
+        generation_(0),
+        page_(NULL),
+        dirty_(false) {
+  }
+
+  /**
+   * Takes over the pin held by another handle.
+   *
+   * @param other   Handle to move from.  It is left empty.
+   */
+  PageHandle(PageHandle&& other)
+      : buf_mgr_(other.buf_mgr_),
+        frame_(other.frame_),
+        generation_(other.generation_),
+        page_(other.page_),
+        dirty_(other.dirty_) {
+    other.buf_mgr_ = NULL;
+    other.page_ = NULL;
+  }
+
+  /**
+   * Releases the pin held by this handle, then takes over the pin held by
+   * another handle.
+   *
+   * @param other   Handle to move from.  It is left empty.
+   */
+  PageHandle& operator=(PageHandle&& other);
+
+  PageHandle(const PageHandle&) = delete;
+  PageHandle& operator=(const PageHandle&) = delete;
+
+  /**
+   * Unpins the page, if the handle holds a pin.  Errors are not thrown, since
+   * the handle may be destroyed while an exception unwinds the stack; call
+   * release() first to see them.
+   */
+  ~PageHandle() noexcept;
+
+  /**
+   * Returns whether the handle holds a pin.
+   */
+  explicit operator bool() const { return page_ != NULL; }
+
+  /**
+   * Returns the pinned page.  The handle must not be empty.
+   */
+  Page& operator*() const { return *page_; }
+  Page* operator->() const { return page_; }
+  Page* get() const { return page_; }
+
+  /**
+   * Returns the frame holding the page.
+   */
+  FrameId frame() const { return frame_; }
+
+  /**
+   * Records that the page was modified, so that it is written back when it
+   * leaves the buffer pool.
+   */
+  void markDirty() { dirty_ = true; }
+
+  /**
+   * Unpins the page now, marking it dirty if markDirty() was called.  The
+   * handle is empty afterwards.  Does nothing on an empty handle, or if the
+   * page has been disposed of.
+   *
+   * @throws  PageNotPinnedException  If the page is not pinned any more.
+   */
+  void release();
+
+ private:
+  /**
+   * Constructs a handle for a page that was just pinned.
+   *
+   * @param buf_mgr     Buffer manager holding the page.
+   * @param frame       Frame holding the page.
+   * @param generation  Generation of the frame when the page was pinned.
+   * @param page        The page.
+   */
+  PageHandle(BufMgr* buf_mgr, const FrameId frame,
+             const std::uint64_t generation, Page* page)
+      : buf_mgr_(buf_mgr),
+        frame_(frame),
+        generation_(generation),
+        page_(page),
+        dirty_(false) {
+  }
+
+  /**
+   * Buffer manager holding the page.
+   */
+  BufMgr* buf_mgr_;
+
+  /**
+   * Frame holding the page.
+   */
+  FrameId frame_;
+
+  /**
+   * Generation of the frame when the page was pinned.  The frame holds
+   * another page, or none, once it differs.
+   */
+  std::uint64_t generation_;
+
+  /**
+   * The pinned page, or NULL if the handle is empty.
+   */
+  Page* page_;
+
+  /**
+   * Whether the page is unpinned dirty.
+   */
+  bool dirty_;
+
+  friend class BufMgr;
+};
+
+}
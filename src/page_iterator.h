@@ -8,8 +8,10 @@
 #pragma once
 
 #include <cassert>
+#include <utility>
 #include "file.h"
 #include "page.h"
+#include "slot_scan.h"
 #include "types.h"
 
 namespace badgerdb {
@@ -19,6 +21,19 @@ namespace badgerdb {
  *
  * This class provides a forward-only iterator that iterates over all the
  * records stored in a Page.
+ *
+ * Where records are packed, advancing checks the very next slot.  Past an
+ * unused slot, the iterator keeps a mask of the used slots in a window of up
+ * to SlotScan::WINDOW slots ahead of it, so that advancing is a matter of
+ * taking the next bit of the mask.
+ *
+ * The page may be changed while it is iterated over:
+ * - A deleted record is never returned, wherever it is.
+ * - A record inserted into a slot before the current one is not visited.
+ * - A record inserted into any of the SlotScan::WINDOW slots after the current
+ *   one may or may not be visited, depending on whether the iterator already
+ *   read that slot's flag.
+ * - A record inserted further ahead is visited.
  */
 class PageIterator {
  public:
@@ -26,7 +41,10 @@ class PageIterator {
    * Constructs an empty iterator.
    */
   PageIterator()
-      : page_(NULL) {
+      : page_(NULL),
+        used_slots_(0),
+        window_start_(Page::INVALID_SLOT),
+        slots_(NULL) {
     current_record_ = {Page::INVALID_NUMBER, Page::INVALID_SLOT};
   }
 
@@ -37,10 +55,13 @@ class PageIterator {
    * @param page  Page to iterate over.
    */
   PageIterator(Page* page)
-      : page_(page)  {
+      : page_(page),
+        used_slots_(0),
+        window_start_(Page::INVALID_SLOT),
+        slots_(page->getSlot(1)) {
     assert(page_ != NULL);
-    const SlotId used_slot = getNextUsedSlot(Page::INVALID_SLOT /* start */);
-    current_record_ = {page_->page_number(), used_slot};
+    current_record_ = {page_->page_number(), Page::INVALID_SLOT};
+    current_record_.slot_number = nextSlot();
   }
 
   /**
@@ -52,7 +73,10 @@ class PageIterator {
    */
   PageIterator(Page* page, const RecordId& record_id)
       : page_(page),
-        current_record_(record_id) {
+        current_record_(record_id),
+        used_slots_(0),
+        window_start_(Page::INVALID_SLOT),
+        slots_(page->getSlot(1)) {
   }
 
   /**
@@ -60,7 +84,7 @@ class PageIterator {
    */
 	inline PageIterator& operator++() {
     assert(page_ != NULL);
-    const SlotId used_slot = getNextUsedSlot(current_record_.slot_number);
+    const SlotId used_slot = nextSlot();
     current_record_ = {page_->page_number(), used_slot};
 
 		return *this;
@@ -70,7 +94,7 @@ class PageIterator {
 		PageIterator tmp = *this;   // copy ourselves
 
     assert(page_ != NULL);
-    const SlotId used_slot = getNextUsedSlot(current_record_.slot_number);
+    const SlotId used_slot = nextSlot();
     current_record_ = {page_->page_number(), used_slot};
 
 		return tmp;
@@ -101,6 +125,25 @@ class PageIterator {
 		return page_->getRecord(current_record_); 
 	}
 
+  /**
+   * Returns the ID of the current record in the page.
+   *
+   * @return  ID of current record.
+   */
+  inline const RecordId& record_id() const {
+    return current_record_;
+  }
+
+  /**
+   * Returns a view of the current record in the page, without copying it.
+   *
+   * @see Page::getRecordView
+   * @return  View of record in page.
+   */
+  inline RecordView view() const {
+    return page_->getRecordView(current_record_);
+  }
+
   /**
    * Returns the next used slot in the page after the given slot or
    * Page::INVALID_SLOT if no slots are used after the given slot.
@@ -109,18 +152,46 @@ class PageIterator {
    * @return  Next used slot after given slot or Page::INVALID_SLOT.
    */
   SlotId getNextUsedSlot(const SlotId start) const {
-    SlotId slot_number = Page::INVALID_SLOT;
-    for (SlotId i = start + 1; i <= page_->header_.num_slots; ++i) {
-      const PageSlot* slot = page_->getSlot(i);
-      if (slot->used) {
-        slot_number = i;
-        break;
+    return SlotScan::nextUsed(page_->getSlot(1), page_->header_.num_slots,
+                              start);
+  }
+
+ private:
+  /**
+   * Returns the next used slot after the current record: the very next slot
+   * if it is used, or else the next one from the mask of used slots, built
+   * when none is left.
+   *
+   * @return  Next used slot after current record or Page::INVALID_SLOT.
+   */
+  SlotId nextSlot() {
+    const SlotId num_slots = page_->header_.num_slots;
+    const SlotId current = current_record_.slot_number;
+    if (used_slots_ == 0) {
+      // Packed records need no mask.
+      if (current < num_slots && slots_[current].used) {
+        return current + 1;
       }
     }
-    return slot_number;
+    while (used_slots_ != 0) {
+      const SlotId slot_number = window_start_ + __builtin_ctzll(used_slots_);
+      used_slots_ &= used_slots_ - 1;
+      if (slot_number <= num_slots && slots_[slot_number - 1].used) {
+        return slot_number;
+      }
+    }
+    for (std::uint32_t first = current + 1;
+         first <= num_slots; first += SlotScan::WINDOW) {
+      const std::uint64_t used = SlotScan::usedMask(slots_, num_slots, first);
+      if (used != 0) {
+        window_start_ = first;
+        used_slots_ = used & (used - 1);
+        return first + __builtin_ctzll(used);
+      }
+    }
+    return Page::INVALID_SLOT;
   }
 
- private:
   /**
    * Page we're iterating over.
    */
@@ -131,6 +202,90 @@ class PageIterator {
    */
   RecordId current_record_;
 
+  /**
+   * Used slots after the current record in the window starting at
+   * window_start_, bit n standing for slot window_start_ + n.
+   */
+  std::uint64_t used_slots_;
+
+  /**
+   * First slot of the window of used_slots_.
+   */
+  SlotId window_start_;
+
+  /**
+   * Slot directory of the page.
+   */
+  const PageSlot* slots_;
+
+};
+
+/**
+ * @brief Iterator for scanning the records in a page without copying them.
+ *
+ * Like PageIterator, but dereferencing yields the record's ID together with a
+ * RecordView of its bytes on the page instead of a fresh std::string.  Views
+ * are subject to the same validity rules as Page::getRecordView.
+ */
+class RecordViewIterator {
+ public:
+  /**
+   * Record ID and view of its bytes.
+   */
+  typedef std::pair<RecordId, RecordView> value_type;
+
+  /**
+   * Constructs an empty iterator.
+   */
+  RecordViewIterator() {
+  }
+
+  /**
+   * Constructs an iterator at the same record as the given page iterator.
+   *
+   * @param iter  Page iterator to start at.
+   */
+  explicit RecordViewIterator(const PageIterator& iter)
+      : iter_(iter) {
+  }
+
+  /**
+   * Advances the iterator to the next record in the page.
+   */
+  inline RecordViewIterator& operator++() {
+    ++iter_;
+    return *this;
+  }
+
+  inline RecordViewIterator operator++(int) {
+    RecordViewIterator tmp = *this;
+    ++iter_;
+    return tmp;
+  }
+
+  inline bool operator==(const RecordViewIterator& rhs) const {
+    return iter_ == rhs.iter_;
+  }
+
+  inline bool operator!=(const RecordViewIterator& rhs) const {
+    return iter_ != rhs.iter_;
+  }
+
+  /**
+   * Dereferences the iterator, returning the ID of the current record and a
+   * view of its bytes.
+   *
+   * @return  Record ID and view of record in page.
+   */
+  inline value_type operator*() const {
+    return value_type(iter_.record_id(), iter_.view());
+  }
+
+ private:
+  /**
+   * Iterator over the used slots of the page.
+   */
+  PageIterator iter_;
 };
 
 }
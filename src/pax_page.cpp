@@ -0,0 +1,156 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#include "pax_page.h"
+
+#include <cassert>
+#include <cstring>
+
+#include "exceptions/insufficient_space_exception.h"
+#include "exceptions/invalid_record_exception.h"
+
+namespace badgerdb {
+
+PaxPage PaxPage::format(Page* page,
+                        const std::vector<std::uint16_t>& column_sizes) {
+  std::size_t record_size = 0;
+  for (std::size_t i = 0; i < column_sizes.size(); ++i) {
+    record_size += column_sizes[i];
+  }
+  const std::size_t metadata_size =
+      sizeof(PaxPageHeader) + 2 * sizeof(std::uint16_t) * column_sizes.size();
+  // Each record takes its fields plus one bit of the bitmap, which is rounded
+  // up to whole bytes.
+  std::size_t capacity = 0;
+  if (record_size > 0 && metadata_size + 1 < Page::DATA_SIZE) {
+    capacity = (8 * (Page::DATA_SIZE - metadata_size) - 7) /
+        (8 * record_size + 1);
+  }
+  if (capacity == 0) {
+    throw InsufficientSpaceException(
+        page->page_number(), record_size,
+        Page::DATA_SIZE > metadata_size ? Page::DATA_SIZE - metadata_size : 0);
+  }
+
+  // Leave no free space and no slots to the slotted layout, so that Page's own
+  // record methods cannot write over the minipages.
+  page->header_.free_space_lower_bound = Page::DATA_SIZE;
+  page->header_.free_space_upper_bound = Page::DATA_SIZE;
+  page->header_.num_slots = 0;
+  page->header_.num_free_slots = 0;
+  page->header_.fragmented_bytes = 0;
+  page->header_.first_free_slot = Page::INVALID_SLOT;
+  std::memset(page->data_, 0, Page::DATA_SIZE);
+
+  PaxPage pax_page(page);
+  PaxPageHeader& header = pax_page.header();
+  header.num_columns = column_sizes.size();
+  header.record_size = record_size;
+  header.capacity = capacity;
+  std::size_t offset = metadata_size + (capacity + 7) / 8;
+  for (std::size_t i = 0; i < column_sizes.size(); ++i) {
+    pax_page.columnOffsets()[i] = offset;
+    pax_page.columnSizes()[i] = column_sizes[i];
+    offset += capacity * column_sizes[i];
+  }
+  assert(offset <= Page::DATA_SIZE);
+  return pax_page;
+}
+
+RecordId PaxPage::insertRecord(const char* record_data) {
+  PaxPageHeader& page_header = header();
+  if (page_header.num_records == page_header.capacity) {
+    throw InsufficientSpaceException(page_number(), page_header.record_size, 0);
+  }
+  // Every position before the hint is used, so the first byte with a clear
+  // bit holds the first unused position.
+  std::size_t byte = page_header.first_free / 8;
+  while (bitmap()[byte] == 0xff) {
+    ++byte;
+  }
+  std::size_t index = byte * 8;
+  while (bitmap()[byte] & (1 << (index % 8))) {
+    ++index;
+  }
+  bitmap()[byte] |= 1 << (index % 8);
+  ++page_header.num_records;
+  page_header.first_free = index + 1;
+  for (std::size_t column = 0; column < page_header.num_columns; ++column) {
+    std::memcpy(field(index, column), record_data, columnSizes()[column]);
+    record_data += columnSizes()[column];
+  }
+  return {page_number(), static_cast<SlotId>(index + 1)};
+}
+
+void PaxPage::getRecord(const RecordId& record_id, char* out) const {
+  validateRecordId(record_id);
+  const std::size_t index = record_id.slot_number - 1;
+  for (std::size_t column = 0; column < header().num_columns; ++column) {
+    std::memcpy(out, field(index, column), columnSizes()[column]);
+    out += columnSizes()[column];
+  }
+}
+
+std::string PaxPage::getRecord(const RecordId& record_id) const {
+  std::string record(header().record_size, '\0');
+  getRecord(record_id, &record[0]);
+  return record;
+}
+
+RecordView PaxPage::getField(const RecordId& record_id,
+                             const std::size_t column) const {
+  validateRecordId(record_id);
+  assert(column < header().num_columns);
+  return RecordView(field(record_id.slot_number - 1, column),
+                    columnSizes()[column]);
+}
+
+void PaxPage::updateRecord(const RecordId& record_id,
+                           const char* record_data) {
+  validateRecordId(record_id);
+  const std::size_t index = record_id.slot_number - 1;
+  for (std::size_t column = 0; column < header().num_columns; ++column) {
+    std::memmove(field(index, column), record_data, columnSizes()[column]);
+    record_data += columnSizes()[column];
+  }
+}
+
+void PaxPage::updateField(const RecordId& record_id, const std::size_t column,
+                          const char* field_data) {
+  validateRecordId(record_id);
+  assert(column < header().num_columns);
+  std::memmove(field(record_id.slot_number - 1, column), field_data,
+               columnSizes()[column]);
+}
+
+void PaxPage::deleteRecord(const RecordId& record_id) {
+  validateRecordId(record_id);
+  const std::size_t index = record_id.slot_number - 1;
+  bitmap()[index / 8] &= ~(1 << (index % 8));
+  for (std::size_t column = 0; column < header().num_columns; ++column) {
+    std::memset(field(index, column), 0, columnSizes()[column]);
+  }
+  PaxPageHeader& page_header = header();
+  --page_header.num_records;
+  if (index < page_header.first_free) {
+    page_header.first_free = index;
+  }
+}
+
+char* PaxPage::field(const std::size_t index, const std::size_t column) const {
+  return &page_->data_[columnOffsets()[column] +
+                       index * columnSizes()[column]];
+}
+
+void PaxPage::validateRecordId(const RecordId& record_id) const {
+  if (record_id.page_number != page_number() ||
+      !isUsed(record_id.slot_number)) {
+    throw InvalidRecordException(record_id, page_number());
+  }
+}
+
+}
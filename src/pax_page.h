@@ -0,0 +1,399 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "page.h"
+#include "record_view.h"
+#include "types.h"
+
+namespace badgerdb {
+
+/**
+ * @brief Metadata at the start of the data area of a page laid out as a
+ * PaxPage.  It is followed by the offset and then the size of each column's
+ * minipage, one std::uint16_t each.
+ */
+struct PaxPageHeader {
+  /**
+   * Number of columns (fields) of every record.
+   */
+  std::uint16_t num_columns;
+
+  /**
+   * Size in bytes of a whole record, the sum of its column sizes.
+   */
+  std::uint16_t record_size;
+
+  /**
+   * Number of record positions in every minipage.
+   */
+  std::uint16_t capacity;
+
+  /**
+   * Number of records currently on the page.
+   */
+  std::uint16_t num_records;
+
+  /**
+   * Index of the first record position which may be unused.  All positions
+   * before it are in use.
+   */
+  std::uint16_t first_free;
+};
+
+/**
+ * @brief Column-by-column (PAX) layout of a Page holding records made of
+ * fixed-size fields.
+ *
+ * The data area of the page is split into one minipage per column.  Minipage
+ * c holds field c of every record on the page back to back, so a scan that
+ * reads one field streams through that minipage alone instead of pulling
+ * whole records through the cache.  Record n (slot number n + 1 of its
+ * RecordId) has its fields at position n of every minipage; a bitmap tracks
+ * which positions are used.
+ *
+ * Records go in and come out in row form, the fields concatenated in column
+ * order.  Single fields can be read and written in place.
+ *
+ * Like FixedPage, a PaxPage is a view over a Page, which File and BufMgr
+ * handle as usual.  Call format() once on a newly allocated page, then
+ * construct a PaxPage over it whenever it is accessed.  The column sizes are
+ * stored on the page.
+ *
+ * @warning This class is not threadsafe.
+ */
+class PaxPage {
+ public:
+  class ColumnIterator;
+
+  /**
+   * Lays out the given page to hold records with the given column sizes,
+   * discarding any records on it.  The page's number and its place in the file
+   * are kept.
+   *
+   * @param page          Page to lay out.
+   * @param column_sizes  Size in bytes of each column, in order.
+   * @return  View of the page.
+   * @throws  InsufficientSpaceException  Thrown if not even one record with
+   *                                      these columns fits on a page.
+   */
+  static PaxPage format(Page* page,
+                        const std::vector<std::uint16_t>& column_sizes);
+
+  /**
+   * Constructs a view of a page laid out by format().
+   *
+   * @param page  Page to view.
+   */
+  explicit PaxPage(Page* page)
+      : page_(page) {
+  }
+
+  /**
+   * Inserts a new record into the page, at the first unused position.
+   *
+   * @param record_data  record_size() bytes: the fields, in column order.
+   * @return  ID of the newly inserted record.
+   * @throws  InsufficientSpaceException  Thrown if the page is full.
+   */
+  RecordId insertRecord(const char* record_data);
+
+  /**
+   * Copies the record with the given ID, in row form, to the given buffer.
+   *
+   * @param record_id  ID of the record to return.
+   * @param out        Buffer of record_size() bytes.
+   * @throws  InvalidRecordException  Thrown if the ID does not refer to a
+   *                                  record on this page.
+   */
+  void getRecord(const RecordId& record_id, char* out) const;
+
+  /**
+   * Returns the record with the given ID, in row form.
+   *
+   * @param record_id  ID of the record to return.
+   * @return  The record.
+   * @throws  InvalidRecordException  Thrown if the ID does not refer to a
+   *                                  record on this page.
+   */
+  std::string getRecord(const RecordId& record_id) const;
+
+  /**
+   * Returns a view of one field of the record with the given ID.  The view is
+   * valid while the page stays pinned and the record is not deleted.
+   *
+   * @param record_id  ID of the record.
+   * @param column     Column of the field.
+   * @return  View of the field.
+   * @throws  InvalidRecordException  Thrown if the ID does not refer to a
+   *                                  record on this page.
+   */
+  RecordView getField(const RecordId& record_id,
+                      const std::size_t column) const;
+
+  /**
+   * Replaces the record with the given ID.
+   *
+   * @param record_id    ID of record to update.
+   * @param record_data  record_size() bytes: the fields, in column order.
+   * @throws  InvalidRecordException  Thrown if the ID does not refer to a
+   *                                  record on this page.
+   */
+  void updateRecord(const RecordId& record_id, const char* record_data);
+
+  /**
+   * Replaces one field of the record with the given ID.
+   *
+   * @param record_id   ID of record to update.
+   * @param column      Column of the field.
+   * @param field_data  column_size(column) bytes of the new field.
+   * @throws  InvalidRecordException  Thrown if the ID does not refer to a
+   *                                  record on this page.
+   */
+  void updateField(const RecordId& record_id, const std::size_t column,
+                   const char* field_data);
+
+  /**
+   * Deletes the record with the given ID.  Its position is reused by later
+   * inserts.
+   *
+   * @param record_id   ID of the record to delete.
+   * @throws  InvalidRecordException  Thrown if the ID does not refer to a
+   *                                  record on this page.
+   */
+  void deleteRecord(const RecordId& record_id);
+
+  /**
+   * Returns true if the page has room for another record.
+   *
+   * @return  Whether the page can hold another record.
+   */
+  bool hasSpaceForRecord() const {
+    return header().num_records < header().capacity;
+  }
+
+  /**
+   * Returns the number of records on the page.
+   */
+  std::size_t num_records() const { return header().num_records; }
+
+  /**
+   * Returns the maximum number of records on the page.
+   */
+  std::size_t capacity() const { return header().capacity; }
+
+  /**
+   * Returns the number of columns of every record.
+   */
+  std::size_t num_columns() const { return header().num_columns; }
+
+  /**
+   * Returns the size in bytes of a record in row form.
+   */
+  std::size_t record_size() const { return header().record_size; }
+
+  /**
+   * Returns the size in bytes of the given column.
+   */
+  std::size_t column_size(const std::size_t column) const {
+    return columnSizes()[column];
+  }
+
+  /**
+   * Returns the minipage of the given column: capacity() fields of
+   * column_size(column) bytes, by record position.  Only positions whose
+   * record is used hold data; unused ones are zeroed.
+   *
+   * @param column  Column of the minipage.
+   * @return  Start of the minipage.
+   */
+  const char* column_data(const std::size_t column) const {
+    return field(0, column);
+  }
+
+  /**
+   * Returns whether the record with the given slot number is in use.
+   *
+   * @param slot_number   Slot number of the record.
+   * @return  Whether the record is in use.
+   */
+  bool isUsed(const SlotId slot_number) const;
+
+  /**
+   * Returns this page's number in its file.
+   *
+   * @return  Page number.
+   */
+  PageId page_number() const { return page_->page_number(); }
+
+  /**
+   * Returns the slot number of the first record after the given slot, or
+   * Page::INVALID_SLOT if there is none.
+   *
+   * @param slot_number   Slot to start search after; Page::INVALID_SLOT to
+   *                      start at the beginning.
+   * @return  Next used slot after given slot or Page::INVALID_SLOT.
+   */
+  SlotId nextUsedSlot(const SlotId slot_number) const;
+
+  /**
+   * Returns an iterator at the first record in the page, over the given
+   * column.
+   *
+   * @param column  Column to iterate over.
+   * @return  Iterator at first record of page.
+   */
+  ColumnIterator beginColumn(const std::size_t column) const;
+
+  /**
+   * Returns an iterator representing the record after the last record in the
+   * page, for iterating over the given column.  This iterator should not be
+   * dereferenced.
+   *
+   * @param column  Column to iterate over.
+   * @return  Iterator representing record after the last record in the page.
+   */
+  ColumnIterator endColumn(const std::size_t column) const;
+
+ private:
+  PaxPageHeader& header() const {
+    return *reinterpret_cast<PaxPageHeader*>(page_->data_);
+  }
+
+  std::uint16_t* columnOffsets() const {
+    return reinterpret_cast<std::uint16_t*>(
+        &page_->data_[sizeof(PaxPageHeader)]);
+  }
+
+  std::uint16_t* columnSizes() const {
+    return columnOffsets() + header().num_columns;
+  }
+
+  unsigned char* bitmap() const {
+    return reinterpret_cast<unsigned char*>(
+        columnSizes() + header().num_columns);
+  }
+
+  /**
+   * Returns the field of the given column at the given record position.
+   *
+   * @param index   Record position.
+   * @param column  Column of the field.
+   * @return  Pointer to the field.
+   */
+  char* field(const std::size_t index, const std::size_t column) const;
+
+  /**
+   * Throws an exception if the given record ID does not refer to a record on
+   * this page.
+   *
+   * @param record_id   Record ID to validate.
+   * @throws  InvalidRecordException  Thrown if the ID has a bad page or slot
+   *                                  number.
+   */
+  void validateRecordId(const RecordId& record_id) const;
+
+  /**
+   * Page being viewed.
+   */
+  Page* page_;
+};
+
+/**
+ * @brief Iterator over one column of a PaxPage, yielding the ID of each
+ * record with a view of its field.
+ */
+class PaxPage::ColumnIterator {
+ public:
+  /**
+   * Record ID and view of its field.
+   */
+  typedef std::pair<RecordId, RecordView> value_type;
+
+  ColumnIterator(const PaxPage& page, const std::size_t column,
+                 const SlotId slot_number)
+      : page_(page),
+        column_(column),
+        slot_number_(slot_number) {
+  }
+
+  ColumnIterator& operator++() {
+    slot_number_ = page_.nextUsedSlot(slot_number_);
+    return *this;
+  }
+
+  bool operator==(const ColumnIterator& rhs) const {
+    return slot_number_ == rhs.slot_number_;
+  }
+
+  bool operator!=(const ColumnIterator& rhs) const {
+    return slot_number_ != rhs.slot_number_;
+  }
+
+  value_type operator*() const {
+    const RecordId record_id = {page_.page_number(), slot_number_};
+    return value_type(record_id,
+                      RecordView(page_.field(slot_number_ - 1, column_),
+                                 page_.column_size(column_)));
+  }
+
+ private:
+  /**
+   * Page we're iterating over.
+   */
+  PaxPage page_;
+
+  /**
+   * Column we're iterating over.
+   */
+  std::size_t column_;
+
+  /**
+   * Slot number of the current record, or Page::INVALID_SLOT at the end.
+   */
+  SlotId slot_number_;
+};
+
+inline bool PaxPage::isUsed(const SlotId slot_number) const {
+  const std::size_t index = slot_number - 1;
+  return slot_number != Page::INVALID_SLOT && index < header().capacity &&
+      (bitmap()[index / 8] & (1 << (index % 8)));
+}
+
+inline SlotId PaxPage::nextUsedSlot(const SlotId slot_number) const {
+  // Slot n + 1 is record position n, so the next position is slot_number.
+  std::size_t index = slot_number;
+  const std::size_t capacity = header().capacity;
+  while (index < capacity) {
+    if ((index % 8) == 0 && bitmap()[index / 8] == 0) {
+      index += 8;
+    } else if (bitmap()[index / 8] & (1 << (index % 8))) {
+      return index + 1;
+    } else {
+      ++index;
+    }
+  }
+  return Page::INVALID_SLOT;
+}
+
+inline PaxPage::ColumnIterator PaxPage::beginColumn(
+    const std::size_t column) const {
+  return ColumnIterator(*this, column, nextUsedSlot(Page::INVALID_SLOT));
+}
+
+inline PaxPage::ColumnIterator PaxPage::endColumn(
+    const std::size_t column) const {
+  return ColumnIterator(*this, column, Page::INVALID_SLOT);
+}
+
+}
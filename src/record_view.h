@@ -0,0 +1,135 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <string>
+
+namespace badgerdb {
+
+/**
+ * @brief Read-only view of a record's bytes where they are stored.
+ *
+ * A view does not own or copy the data it refers to.  A view obtained from a
+ * Page is valid only while that page stays in memory and unchanged: while it
+ * is pinned in the buffer pool and until the next insert, update, or delete on
+ * the page, any of which may move records around.  Use toString() to keep a
+ * copy past that point.
+ */
+class RecordView {
+ public:
+  /**
+   * Constructs an empty view.
+   */
+  RecordView()
+      : data_(NULL),
+        length_(0) {
+  }
+
+  /**
+   * Constructs a view over the given bytes.
+   *
+   * @param data    First byte of the record.
+   * @param length  Length of the record in bytes.
+   */
+  RecordView(const char* data, const std::size_t length)
+      : data_(data),
+        length_(length) {
+  }
+
+  /**
+   * Constructs a view over the contents of the given string.  The view is
+   * invalidated when the string is modified or destroyed.
+   *
+   * @param str   String to view.
+   */
+  RecordView(const std::string& str)
+      : data_(str.data()),
+        length_(str.length()) {
+  }
+
+  /**
+   * Returns a pointer to the first byte of the record.
+   *
+   * @return  Pointer to record bytes.
+   */
+  const char* data() const { return data_; }
+
+  /**
+   * Returns the length of the record in bytes.
+   *
+   * @return  Length of record.
+   */
+  std::size_t length() const { return length_; }
+
+  /**
+   * Returns the length of the record in bytes.
+   *
+   * @return  Length of record.
+   */
+  std::size_t size() const { return length_; }
+
+  /**
+   * Returns true if the record has no bytes.
+   *
+   * @return  Whether the record is empty.
+   */
+  bool empty() const { return length_ == 0; }
+
+  const char* begin() const { return data_; }
+
+  const char* end() const { return data_ + length_; }
+
+  /**
+   * Returns the byte at the given position in the record.
+   *
+   * @param pos   Position of byte, which must be less than length().
+   * @return  Byte at the position.
+   */
+  char operator[](const std::size_t pos) const {
+    assert(pos < length_);
+    return data_[pos];
+  }
+
+  /**
+   * Returns a copy of the record's bytes.
+   *
+   * @return  String holding the record.
+   */
+  std::string toString() const { return std::string(data_, length_); }
+
+  /**
+   * Returns true if this view holds the same bytes as the given view.
+   *
+   * @param rhs   View to compare against.
+   * @return  Whether both views hold the same bytes.
+   */
+  bool operator==(const RecordView& rhs) const {
+    return length_ == rhs.length_ &&
+        (length_ == 0 || std::memcmp(data_, rhs.data_, length_) == 0);
+  }
+
+  bool operator!=(const RecordView& rhs) const {
+    return !(*this == rhs);
+  }
+
+ private:
+  /**
+   * First byte of the record.
+   */
+  const char* data_;
+
+  /**
+   * Length of the record in bytes.
+   */
+  std::size_t length_;
+};
+
+}
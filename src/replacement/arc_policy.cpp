@@ -0,0 +1,128 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#include "replacement/arc_policy.h"
+
+#include <algorithm>
+
+namespace badgerdb {
+
+ArcPolicy::ArcPolicy()
+    : capacity_(0), target_(0) {
+}
+
+void ArcPolicy::init(const std::uint32_t numBufs) {
+  capacity_ = numBufs;
+  t1_.init(numBufs);
+  t2_.init(numBufs);
+  list_.assign(numBufs, NONE);
+  pages_.assign(numBufs, PageKey());
+}
+
+void ArcPolicy::detach(const FrameId frame) {
+  if (t1_.contains(frame)) {
+    t1_.remove(frame);
+  } else if (t2_.contains(frame)) {
+    t2_.remove(frame);
+  }
+}
+
+void ArcPolicy::trimGhosts() {
+  while (b1_.size() > 0 && t1_.size() + b1_.size() > capacity_) {
+    b1_.popBack();
+  }
+  while (b2_.size() > 0 &&
+         t1_.size() + t2_.size() + b1_.size() + b2_.size() > 2 * capacity_) {
+    b2_.popBack();
+  }
+}
+
+void ArcPolicy::recordAccess(const FrameId frame) {
+  std::lock_guard<std::mutex> guard(latch_);
+  // Case I: a hit in T1 or T2 moves the page to the MRU end of T2.
+  if (t1_.contains(frame) || t2_.contains(frame)) {
+    detach(frame);
+    list_[frame] = T2;
+    t2_.pushFront(frame);
+  }
+}
+
+void ArcPolicy::recordLoad(const FrameId frame, const PageKey& key) {
+  std::lock_guard<std::mutex> guard(latch_);
+  pages_[frame] = key;
+  if (b1_.contains(key)) {
+    // Case II: recency would have kept it; favour T1.
+    const double delta = std::max(1.0, (double) b2_.size() / b1_.size());
+    target_ = std::min((double) capacity_, target_ + delta);
+    b1_.remove(key);
+    list_[frame] = T2;
+    t2_.pushFront(frame);
+  } else if (b2_.contains(key)) {
+    // Case III: frequency would have kept it; favour T2.
+    const double delta = std::max(1.0, (double) b1_.size() / b2_.size());
+    target_ = std::max(0.0, target_ - delta);
+    b2_.remove(key);
+    list_[frame] = T2;
+    t2_.pushFront(frame);
+  } else {
+    // Case IV: a page not seen recently.
+    list_[frame] = T1;
+    t1_.pushFront(frame);
+  }
+  trimGhosts();
+}
+
+void ArcPolicy::recordEvict(const FrameId frame) {
+  std::lock_guard<std::mutex> guard(latch_);
+  detach(frame);
+  if (list_[frame] == T1) {
+    b1_.pushFront(pages_[frame]);
+  } else if (list_[frame] == T2) {
+    b2_.pushFront(pages_[frame]);
+  }
+  list_[frame] = NONE;
+  trimGhosts();
+}
+
+void ArcPolicy::recordRemove(const FrameId frame) {
+  std::lock_guard<std::mutex> guard(latch_);
+  detach(frame);
+  list_[frame] = NONE;
+}
+
+bool ArcPolicy::pickVictim(FrameId& frame,
+                           const EvictablePredicate& evictable) {
+  std::lock_guard<std::mutex> guard(latch_);
+  // REPLACE: take the LRU page of T1 while T1 exceeds its target, otherwise
+  // the LRU page of T2.  The incoming page is not known yet, so the tie at
+  // |T1| == p is resolved in favour of T2.
+  FrameList* first = t1_.size() > 0 && (t1_.size() > target_ || t2_.size() == 0)
+      ? &t1_ : &t2_;
+  FrameList* second = first == &t1_ ? &t2_ : &t1_;
+
+  FrameId candidate = first->findFromBack(evictable);
+  if (candidate == FrameList::NONE) {
+    candidate = second->findFromBack(evictable);
+  }
+  if (candidate == FrameList::NONE) {
+    return false;
+  }
+  detach(candidate);
+  frame = candidate;
+  return true;
+}
+
+void ArcPolicy::restore(const FrameId frame) {
+  std::lock_guard<std::mutex> guard(latch_);
+  if (list_[frame] == T1 && !t1_.contains(frame)) {
+    t1_.pushFront(frame);
+  } else if (list_[frame] == T2 && !t2_.contains(frame)) {
+    t2_.pushFront(frame);
+  }
+}
+
+}
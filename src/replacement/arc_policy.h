@@ -0,0 +1,87 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <mutex>
+
+#include "replacement_policy.h"
+
+namespace badgerdb {
+
+/**
+ * @brief Adaptive Replacement Cache (Megiddo and Modha).
+ *
+ * Resident pages are split between T1 (seen once recently) and T2 (seen at
+ * least twice), both LRU ordered, and the pages last evicted from each are
+ * remembered in the ghost lists B1 and B2.  A miss that hits B1 grows the
+ * target size p of T1, a miss that hits B2 shrinks it, so the split between
+ * recency and frequency follows the workload.
+ */
+class ArcPolicy : public ReplacementPolicy {
+ public:
+  ArcPolicy();
+
+  const char* name() const { return "ARC"; }
+  void init(const std::uint32_t numBufs);
+  void recordAccess(const FrameId frame);
+  void recordLoad(const FrameId frame, const PageKey& key);
+  void recordEvict(const FrameId frame);
+  void recordRemove(const FrameId frame);
+  bool pickVictim(FrameId& frame, const EvictablePredicate& evictable);
+  void restore(const FrameId frame);
+
+ private:
+  /**
+   * Where a frame is kept.
+   */
+  enum List { NONE, T1, T2 };
+
+  /**
+   * Removes frame from whichever list holds it.
+   */
+  void detach(const FrameId frame);
+
+  /**
+   * Drops ghost entries so that |T1| + |B1| <= c and the directory holds at
+   * most 2c pages.
+   */
+  void trimGhosts();
+
+  /**
+   * Pool size c.
+   */
+  std::uint32_t capacity_;
+
+  /**
+   * Target size of T1.
+   */
+  double target_;
+
+  FrameList t1_;
+  FrameList t2_;
+  GhostList b1_;
+  GhostList b2_;
+
+  /**
+   * List each frame belongs to.  Detached victims keep the list they were
+   * taken from until they are evicted or restored.
+   */
+  std::vector<List> list_;
+
+  /**
+   * Page held by each frame.
+   */
+  std::vector<PageKey> pages_;
+
+  /**
+   * Guards all of the above.
+   */
+  std::mutex latch_;
+};
+
+}
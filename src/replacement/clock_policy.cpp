@@ -0,0 +1,85 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#include "replacement/clock_policy.h"
+
+namespace badgerdb {
+
+ClockPolicy::ClockPolicy()
+    : numBufs_(0), clockHand_(0), refbits_(NULL) {
+}
+
+ClockPolicy::~ClockPolicy() {
+  delete [] refbits_;
+}
+
+void ClockPolicy::init(const std::uint32_t numBufs) {
+  numBufs_ = numBufs;
+  clockHand_ = numBufs - 1;
+  refbits_ = new std::atomic<bool>[numBufs];
+  for (FrameId i = 0; i < numBufs; ++i) {
+    refbits_[i] = false;
+  }
+}
+
+void ClockPolicy::recordAccess(const FrameId frame) {
+  refbits_[frame] = true;
+}
+
+void ClockPolicy::recordLoad(const FrameId frame, const PageKey& key) {
+  refbits_[frame] = true;
+}
+
+void ClockPolicy::recordEvict(const FrameId frame) {
+  refbits_[frame] = false;
+}
+
+void ClockPolicy::recordRemove(const FrameId frame) {
+  refbits_[frame] = false;
+}
+
+bool ClockPolicy::pickVictim(FrameId& frame,
+                             const EvictablePredicate& evictable) {
+  // Number of frames visited in this pass, and whether any of them was
+  // unpinned.  Give up after a whole pass finds every frame pinned.
+  std::uint32_t visited = 0;
+  bool sawUnpinned = false;
+
+  while (true) {
+    if (visited == numBufs_) {
+      if (!sawUnpinned) {
+        return false;
+      }
+      visited = 0;
+      sawUnpinned = false;
+    }
+    ++visited;
+
+    // Advance the clock to the next frame, modulo number of bufs.
+    const FrameId hand = (clockHand_.fetch_add(1) + 1) % numBufs_;
+
+    // If page is pinned, move on.
+    if (!evictable(hand)) {
+      continue;
+    }
+    sawUnpinned = true;
+
+    // If refbit is set, unset it and move on.
+    if (refbits_[hand].exchange(false)) {
+      continue;
+    }
+
+    frame = hand;
+    return true;
+  }
+}
+
+void ClockPolicy::restore(const FrameId frame) {
+  // The clock keeps no order to restore; the hand has moved on already.
+}
+
+}
@@ -0,0 +1,55 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <atomic>
+
+#include "replacement_policy.h"
+
+namespace badgerdb {
+
+/**
+ * @brief Single reference bit clock ("second chance") replacement.
+ *
+ * The clock hand sweeps the frames in order. A frame whose reference bit is
+ * set gets the bit cleared and is skipped; the first unpinned frame found with
+ * a clear bit is the victim. Hits only set a bit, so the policy takes no latch.
+ */
+class ClockPolicy : public ReplacementPolicy {
+ public:
+  ClockPolicy();
+  ~ClockPolicy();
+
+  const char* name() const { return "Clock"; }
+  void init(const std::uint32_t numBufs);
+  void recordAccess(const FrameId frame);
+  void recordLoad(const FrameId frame, const PageKey& key);
+  void recordEvict(const FrameId frame);
+  void recordRemove(const FrameId frame);
+  bool pickVictim(FrameId& frame, const EvictablePredicate& evictable);
+  void restore(const FrameId frame);
+
+ private:
+  /**
+   * Number of frames in the buffer pool.
+   */
+  std::uint32_t numBufs_;
+
+  /**
+   * Current position of clockhand in our buffer pool. Only ever incremented;
+   * the frame it points to is clockHand_ modulo numBufs_.
+   */
+  std::atomic<FrameId> clockHand_;
+
+  /**
+   * Has this buffer frame been reference recently, per frame.
+   */
+  std::atomic<bool>* refbits_;
+};
+
+}
@@ -0,0 +1,182 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#include "replacement/clock_pro_policy.h"
+
+namespace badgerdb {
+
+ClockProPolicy::ClockProPolicy()
+    : numBufs_(0), coldTarget_(1), numHot_(0), coldHand_(0), hotHand_(0),
+      refbits_(NULL) {
+}
+
+ClockProPolicy::~ClockProPolicy() {
+  delete [] refbits_;
+}
+
+void ClockProPolicy::init(const std::uint32_t numBufs) {
+  numBufs_ = numBufs;
+  coldTarget_ = numBufs > 1 ? numBufs / 2 : 1;
+  refbits_ = new std::atomic<bool>[numBufs];
+  for (FrameId i = 0; i < numBufs; ++i) {
+    refbits_[i] = false;
+  }
+  status_.assign(numBufs, EMPTY);
+  inTest_.assign(numBufs, false);
+  pages_.assign(numBufs, PageKey());
+}
+
+void ClockProPolicy::expireTest(const FrameId frame) {
+  inTest_[frame] = false;
+  if (coldTarget_ > 1) {
+    --coldTarget_;
+  }
+}
+
+void ClockProPolicy::promote(const FrameId frame) {
+  status_[frame] = HOT;
+  inTest_[frame] = false;
+  ++numHot_;
+  if (numBufs_ > 1 && numHot_ > numBufs_ - coldTarget_) {
+    runHotHand(NULL);
+  }
+}
+
+void ClockProPolicy::runHotHand(const EvictablePredicate* evictable) {
+  // Two passes clear every reference bit the hand passes; a third can only
+  // fail if every hot page was referenced again or is pinned.
+  for (std::uint32_t step = 0; step < 3 * numBufs_; ++step) {
+    const FrameId hand = hotHand_;
+    hotHand_ = (hotHand_ + 1) % numBufs_;
+
+    if (status_[hand] == COLD) {
+      // The hot hand also terminates test periods it passes.
+      if (inTest_[hand] && !refbits_[hand]) {
+        expireTest(hand);
+      }
+      continue;
+    }
+    if (status_[hand] != HOT) {
+      continue;
+    }
+    if (refbits_[hand].exchange(false)) {
+      continue;
+    }
+    if (evictable != NULL && !(*evictable)(hand)) {
+      continue;
+    }
+    status_[hand] = COLD;
+    --numHot_;
+    return;
+  }
+}
+
+void ClockProPolicy::recordAccess(const FrameId frame) {
+  refbits_[frame] = true;
+}
+
+void ClockProPolicy::recordLoad(const FrameId frame, const PageKey& key) {
+  std::lock_guard<std::mutex> guard(latch_);
+  pages_[frame] = key;
+  refbits_[frame] = false;
+  if (nonResident_.remove(key)) {
+    // Reused within its test period: the cold area was too small.
+    if (coldTarget_ + 1 < numBufs_) {
+      ++coldTarget_;
+    }
+    promote(frame);
+  } else {
+    status_[frame] = COLD;
+    inTest_[frame] = true;
+  }
+}
+
+void ClockProPolicy::recordEvict(const FrameId frame) {
+  std::lock_guard<std::mutex> guard(latch_);
+  if (inTest_[frame]) {
+    nonResident_.pushFront(pages_[frame]);
+    if (nonResident_.size() > numBufs_) {
+      nonResident_.popBack();
+    }
+  }
+  status_[frame] = EMPTY;
+  inTest_[frame] = false;
+  refbits_[frame] = false;
+}
+
+void ClockProPolicy::recordRemove(const FrameId frame) {
+  std::lock_guard<std::mutex> guard(latch_);
+  if (status_[frame] == HOT) {
+    --numHot_;
+  }
+  status_[frame] = EMPTY;
+  inTest_[frame] = false;
+  refbits_[frame] = false;
+}
+
+bool ClockProPolicy::pickVictim(FrameId& frame,
+                                const EvictablePredicate& evictable) {
+  std::lock_guard<std::mutex> guard(latch_);
+
+  // Number of frames visited in this pass, whether any of them was unpinned
+  // and whether any unpinned one was cold.  A pass without unpinned frames
+  // gives up; a pass with only hot unpinned frames demotes one of them.
+  std::uint32_t visited = 0;
+  bool sawUnpinned = false;
+  bool sawCold = false;
+
+  while (true) {
+    if (visited == numBufs_) {
+      if (!sawUnpinned) {
+        return false;
+      }
+      if (!sawCold) {
+        runHotHand(&evictable);
+      }
+      visited = 0;
+      sawUnpinned = false;
+      sawCold = false;
+    }
+    ++visited;
+
+    const FrameId hand = coldHand_;
+    coldHand_ = (coldHand_ + 1) % numBufs_;
+
+    if (!evictable(hand)) {
+      continue;
+    }
+    sawUnpinned = true;
+    if (status_[hand] == EMPTY) {
+      // Holds no page the policy knows of; nothing to lose.
+      frame = hand;
+      return true;
+    }
+    if (status_[hand] != COLD) {
+      continue;
+    }
+    sawCold = true;
+
+    if (refbits_[hand].exchange(false)) {
+      if (inTest_[hand]) {
+        // Referenced again within its test period.
+        promote(hand);
+      } else {
+        inTest_[hand] = true;
+      }
+      continue;
+    }
+
+    frame = hand;
+    return true;
+  }
+}
+
+void ClockProPolicy::restore(const FrameId frame) {
+  // The victim stays on the clock as a cold page; the hand has moved on.
+}
+
+}
@@ -0,0 +1,121 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <mutex>
+
+#include "replacement_policy.h"
+
+namespace badgerdb {
+
+/**
+ * @brief Simplified CLOCK-Pro replacement (Jiang, Chen and Zhang).
+ *
+ * Resident pages are either hot or cold and share one clock over the frames.
+ * Only cold pages are evicted.  A newly loaded page is cold and in its "test
+ * period"; if it is referenced again while in test it is promoted to hot, and
+ * if it is evicted while in test it is remembered as a non-resident test page.
+ * A miss on a remembered test page loads it straight in as hot and grows the
+ * target number of cold frames; a test period that expires unused shrinks it.
+ *
+ * Two hands sweep the clock: the cold hand looks for victims, the hot hand
+ * demotes unreferenced hot pages so that at most numBufs - coldTarget pages
+ * are hot.  Unlike the original, non-resident test pages are kept in a
+ * separate FIFO bounded by the pool size instead of on the clock itself.
+ * Hits only set a reference bit, so recordAccess() takes no latch.
+ */
+class ClockProPolicy : public ReplacementPolicy {
+ public:
+  ClockProPolicy();
+  ~ClockProPolicy();
+
+  const char* name() const { return "CLOCK-Pro"; }
+  void init(const std::uint32_t numBufs);
+  void recordAccess(const FrameId frame);
+  void recordLoad(const FrameId frame, const PageKey& key);
+  void recordEvict(const FrameId frame);
+  void recordRemove(const FrameId frame);
+  bool pickVictim(FrameId& frame, const EvictablePredicate& evictable);
+  void restore(const FrameId frame);
+
+ private:
+  /**
+   * State of a frame.
+   */
+  enum Status { EMPTY, COLD, HOT };
+
+  /**
+   * Sweeps the hot hand until one hot page is demoted.  If evictable is given
+   * only frames it accepts are demoted, so that the cold hand has a candidate.
+   */
+  void runHotHand(const EvictablePredicate* evictable);
+
+  /**
+   * Ends the test period of frame, shrinking the cold target.
+   */
+  void expireTest(const FrameId frame);
+
+  /**
+   * Makes frame hot, demoting another page if there are too many.
+   */
+  void promote(const FrameId frame);
+
+  /**
+   * Number of frames in the buffer pool.
+   */
+  std::uint32_t numBufs_;
+
+  /**
+   * Target number of cold frames, between 1 and numBufs_ - 1.
+   */
+  std::uint32_t coldTarget_;
+
+  /**
+   * Number of hot frames.
+   */
+  std::uint32_t numHot_;
+
+  /**
+   * Positions of the two hands on the clock.
+   */
+  FrameId coldHand_;
+  FrameId hotHand_;
+
+  /**
+   * Reference bit per frame, set on every access.
+   */
+  std::atomic<bool>* refbits_;
+
+  /**
+   * Status of each frame.
+   */
+  std::vector<Status> status_;
+
+  /**
+   * Whether the cold page in each frame is in its test period.
+   */
+  std::vector<bool> inTest_;
+
+  /**
+   * Page held by each frame.
+   */
+  std::vector<PageKey> pages_;
+
+  /**
+   * Non-resident pages evicted during their test period.
+   */
+  GhostList nonResident_;
+
+  /**
+   * Guards everything but refbits_.
+   */
+  std::mutex latch_;
+};
+
+}
@@ -0,0 +1,120 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#include "replacement/lru_k_policy.h"
+
+namespace badgerdb {
+
+LruKPolicy::LruKPolicy(const std::uint32_t k)
+    : k_(k < 1 ? 1 : k), now_(0), retainLimit_(0) {
+}
+
+void LruKPolicy::init(const std::uint32_t numBufs) {
+  history_.assign(numBufs, std::vector<std::uint64_t>());
+  pages_.assign(numBufs, PageKey());
+  ordered_.assign(numBufs, false);
+  retainLimit_ = numBufs;
+}
+
+LruKPolicy::OrderKey LruKPolicy::orderKey(const FrameId frame) const {
+  const std::vector<std::uint64_t>& times = history_[frame];
+  const std::uint64_t kth = times.size() < k_ ? 0 : times[k_ - 1];
+  return OrderKey(kth, times.empty() ? 0 : times[0], frame);
+}
+
+void LruKPolicy::reference(const FrameId frame) {
+  std::vector<std::uint64_t>& times = history_[frame];
+  times.insert(times.begin(), ++now_);
+  if (times.size() > k_) {
+    times.pop_back();
+  }
+}
+
+void LruKPolicy::recordAccess(const FrameId frame) {
+  std::lock_guard<std::mutex> guard(latch_);
+  if (!ordered_[frame]) {
+    // Detached as a victim; restore() or recordEvict() will follow.
+    return;
+  }
+  order_.erase(orderKey(frame));
+  reference(frame);
+  order_.insert(orderKey(frame));
+}
+
+void LruKPolicy::recordLoad(const FrameId frame, const PageKey& key) {
+  std::lock_guard<std::mutex> guard(latch_);
+  if (ordered_[frame]) {
+    // restore() of a frame BufMgr reused without evicting it through us.
+    order_.erase(orderKey(frame));
+  }
+  pages_[frame] = key;
+  history_[frame].clear();
+  std::unordered_map<PageKey, std::vector<std::uint64_t>, PageKeyHash>::iterator
+      it = retainedHistory_.find(key);
+  if (it != retainedHistory_.end()) {
+    history_[frame].swap(it->second);
+    retainedHistory_.erase(it);
+    retained_.remove(key);
+  }
+  reference(frame);
+  order_.insert(orderKey(frame));
+  ordered_[frame] = true;
+}
+
+void LruKPolicy::recordEvict(const FrameId frame) {
+  std::lock_guard<std::mutex> guard(latch_);
+  if (ordered_[frame]) {
+    order_.erase(orderKey(frame));
+    ordered_[frame] = false;
+  }
+  const PageKey& key = pages_[frame];
+  retainedHistory_[key].swap(history_[frame]);
+  retained_.pushFront(key);
+  if (retained_.size() > retainLimit_) {
+    // Drop the history that has been retained the longest.
+    retainedHistory_.erase(retained_.back());
+    retained_.popBack();
+  }
+  history_[frame].clear();
+}
+
+void LruKPolicy::recordRemove(const FrameId frame) {
+  std::lock_guard<std::mutex> guard(latch_);
+  if (ordered_[frame]) {
+    order_.erase(orderKey(frame));
+    ordered_[frame] = false;
+  }
+  history_[frame].clear();
+}
+
+bool LruKPolicy::pickVictim(FrameId& frame,
+                            const EvictablePredicate& evictable) {
+  std::lock_guard<std::mutex> guard(latch_);
+  for (std::set<OrderKey>::iterator it = order_.begin(); it != order_.end();
+       ++it) {
+    const FrameId candidate = std::get<2>(*it);
+    if (evictable(candidate)) {
+      order_.erase(it);
+      ordered_[candidate] = false;
+      frame = candidate;
+      return true;
+    }
+  }
+  return false;
+}
+
+void LruKPolicy::restore(const FrameId frame) {
+  std::lock_guard<std::mutex> guard(latch_);
+  if (ordered_[frame]) {
+    return;
+  }
+  reference(frame);
+  order_.insert(orderKey(frame));
+  ordered_[frame] = true;
+}
+
+}
@@ -0,0 +1,112 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <mutex>
+#include <set>
+#include <tuple>
+
+#include "replacement_policy.h"
+
+namespace badgerdb {
+
+/**
+ * @brief LRU-K replacement (O'Neil, O'Neil and Weikum).
+ *
+ * The victim is the unpinned page whose K-th most recent reference is the
+ * oldest.  Pages referenced fewer than K times count as infinitely old and are
+ * evicted first, least recently used first.  Reference histories of evicted
+ * pages are retained for up to as many pages as the pool holds, so a page that
+ * returns soon keeps its history.
+ */
+class LruKPolicy : public ReplacementPolicy {
+ public:
+  /**
+   * @param k   Number of references tracked per page; must be at least 1.
+   */
+  explicit LruKPolicy(const std::uint32_t k = 2);
+
+  const char* name() const { return "LRU-K"; }
+  void init(const std::uint32_t numBufs);
+  void recordAccess(const FrameId frame);
+  void recordLoad(const FrameId frame, const PageKey& key);
+  void recordEvict(const FrameId frame);
+  void recordRemove(const FrameId frame);
+  bool pickVictim(FrameId& frame, const EvictablePredicate& evictable);
+  void restore(const FrameId frame);
+
+ private:
+  /**
+   * Eviction order: (time of K-th most recent reference or 0 if there are
+   * fewer than K, time of most recent reference, frame).
+   */
+  typedef std::tuple<std::uint64_t, std::uint64_t, FrameId> OrderKey;
+
+  /**
+   * Records a reference of the page in frame at the next logical time.
+   */
+  void reference(const FrameId frame);
+
+  /**
+   * Returns the position of frame in order_.
+   */
+  OrderKey orderKey(const FrameId frame) const;
+
+  /**
+   * Number of references tracked per page.
+   */
+  const std::uint32_t k_;
+
+  /**
+   * Logical clock, advanced by every reference.
+   */
+  std::uint64_t now_;
+
+  /**
+   * Reference times of the page in each frame, most recent first.
+   */
+  std::vector<std::vector<std::uint64_t> > history_;
+
+  /**
+   * Page held by each frame.
+   */
+  std::vector<PageKey> pages_;
+
+  /**
+   * Whether each frame is in order_.
+   */
+  std::vector<bool> ordered_;
+
+  /**
+   * Resident, non-detached frames in eviction order.
+   */
+  std::set<OrderKey> order_;
+
+  /**
+   * Evicted pages whose reference history is retained, oldest at the back.
+   */
+  GhostList retained_;
+
+  /**
+   * Retained reference histories.
+   */
+  std::unordered_map<PageKey, std::vector<std::uint64_t>, PageKeyHash>
+      retainedHistory_;
+
+  /**
+   * Maximum number of retained histories.
+   */
+  std::size_t retainLimit_;
+
+  /**
+   * Guards all of the above.
+   */
+  std::mutex latch_;
+};
+
+}
@@ -0,0 +1,273 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+#include "types.h"
+
+namespace badgerdb {
+
+class File;
+
+/**
+ * @brief Identifies a page independently of the frame holding it, so that
+ * policies can remember pages that are no longer resident.
+ */
+struct PageKey {
+  /**
+   * File the page belongs to.
+   */
+  const File* file;
+
+  /**
+   * Number of the page within the file.
+   */
+  PageId pageNo;
+
+  bool operator==(const PageKey& rhs) const {
+    return file == rhs.file && pageNo == rhs.pageNo;
+  }
+};
+
+/**
+ * @brief Hash function for PageKey.
+ */
+struct PageKeyHash {
+  std::size_t operator()(const PageKey& key) const {
+    return std::hash<const File*>()(key.file) ^
+        (std::hash<PageId>()(key.pageNo) * 0x9e3779b97f4a7c15ULL);
+  }
+};
+
+/**
+ * @brief Interface of the buffer replacement policies used by BufMgr.
+ *
+ * BufMgr reports every hit, every page loaded into a frame and every page that
+ * leaves a frame, and asks the policy for a victim when it needs a frame and
+ * its free list is empty. The policy only orders frames; BufMgr does the
+ * eviction itself and tells the policy whether it succeeded.
+ *
+ * A frame proposed by pickVictim() is detached from the policy's order until
+ * BufMgr calls either recordEvict() (the page was evicted) or restore() (the
+ * page was pinned or dirtied while BufMgr tried to evict it, and stays).
+ *
+ * Methods may be called concurrently by several threads; every implementation
+ * does its own latching. recordAccess() is called on every buffer hit and
+ * should be cheap.
+ */
+class ReplacementPolicy {
+ public:
+  /**
+   * Predicate telling whether a frame may be evicted right now (it is not
+   * pinned). The answer may be stale by the time the frame is evicted.
+   */
+  typedef std::function<bool(FrameId)> EvictablePredicate;
+
+  virtual ~ReplacementPolicy() {}
+
+  /**
+   * Returns the name of the policy, as reported in BufStats.
+   */
+  virtual const char* name() const = 0;
+
+  /**
+   * Sizes the policy for a pool of numBufs frames. Called once by BufMgr
+   * before any other method.
+   *
+   * @param numBufs  Number of frames in the buffer pool.
+   */
+  virtual void init(const std::uint32_t numBufs) = 0;
+
+  /**
+   * The page held by frame was accessed again (a buffer hit).
+   *
+   * @param frame  Frame of the page.
+   */
+  virtual void recordAccess(const FrameId frame) = 0;
+
+  /**
+   * A page was read or allocated into frame after a miss.
+   *
+   * @param frame   Frame the page was loaded into.
+   * @param key     Page that was loaded.
+   */
+  virtual void recordLoad(const FrameId frame, const PageKey& key) = 0;
+
+  /**
+   * The page held by frame, previously returned by pickVictim(), was evicted.
+   *
+   * @param frame  Frame of the evicted page.
+   */
+  virtual void recordEvict(const FrameId frame) = 0;
+
+  /**
+   * The page held by frame left the buffer pool without being chosen as a
+   * victim (it was disposed or flushed). It should not be remembered.
+   *
+   * @param frame  Frame of the page.
+   */
+  virtual void recordRemove(const FrameId frame) = 0;
+
+  /**
+   * Chooses a victim frame and detaches it.
+   *
+   * @param frame       Frame reference, the victim is returned via this variable.
+   * @param evictable   Tells whether a frame is currently unpinned.
+   * @return  False if no frame can be evicted.
+   */
+  virtual bool pickVictim(FrameId& frame,
+                          const EvictablePredicate& evictable) = 0;
+
+  /**
+   * The frame returned by pickVictim() could not be evicted after all; put it
+   * back as if it had just been accessed.
+   *
+   * @param frame  Frame returned by pickVictim().
+   */
+  virtual void restore(const FrameId frame) = 0;
+};
+
+/**
+ * @brief Doubly linked list of frames, threaded through arrays indexed by
+ * frame number so that every operation is O(1) and nothing is allocated after
+ * construction. The front holds the most recently inserted frame.
+ */
+class FrameList {
+ public:
+  /**
+   * Frame number marking the end of the list.
+   */
+  static const FrameId NONE = 0xffffffff;
+
+  FrameList()
+      : head_(NONE), tail_(NONE), size_(0) {
+  }
+
+  /**
+   * Sizes the list for frames 0 .. numBufs - 1, all absent.
+   */
+  void init(const std::uint32_t numBufs) {
+    prev_.assign(numBufs, FrameId(NONE));
+    next_.assign(numBufs, FrameId(NONE));
+    in_.assign(numBufs, false);
+  }
+
+  bool contains(const FrameId frame) const { return in_[frame]; }
+  std::uint32_t size() const { return size_; }
+  FrameId back() const { return tail_; }
+  FrameId previous(const FrameId frame) const { return prev_[frame]; }
+
+  void pushFront(const FrameId frame) {
+    prev_[frame] = NONE;
+    next_[frame] = head_;
+    if (head_ != NONE) {
+      prev_[head_] = frame;
+    } else {
+      tail_ = frame;
+    }
+    head_ = frame;
+    in_[frame] = true;
+    ++size_;
+  }
+
+  void remove(const FrameId frame) {
+    if (prev_[frame] != NONE) {
+      next_[prev_[frame]] = next_[frame];
+    } else {
+      head_ = next_[frame];
+    }
+    if (next_[frame] != NONE) {
+      prev_[next_[frame]] = prev_[frame];
+    } else {
+      tail_ = prev_[frame];
+    }
+    in_[frame] = false;
+    --size_;
+  }
+
+  /**
+   * Returns the frame nearest the back of the list that is evictable, or NONE.
+   */
+  FrameId findFromBack(const ReplacementPolicy::EvictablePredicate& evictable) const {
+    for (FrameId frame = tail_; frame != NONE; frame = prev_[frame]) {
+      if (evictable(frame)) {
+        return frame;
+      }
+    }
+    return NONE;
+  }
+
+ private:
+  std::vector<FrameId> prev_;
+  std::vector<FrameId> next_;
+  std::vector<bool> in_;
+  FrameId head_;
+  FrameId tail_;
+  std::uint32_t size_;
+};
+
+/**
+ * @brief List of pages that are no longer resident ("ghosts"), in the order
+ * they were added. The front holds the most recently added page.
+ */
+class GhostList {
+ public:
+  bool contains(const PageKey& key) const {
+    return index_.find(key) != index_.end();
+  }
+
+  std::size_t size() const { return order_.size(); }
+
+  /**
+   * Returns the oldest page. The list must not be empty.
+   */
+  const PageKey& back() const { return order_.back(); }
+
+  void pushFront(const PageKey& key) {
+    order_.push_front(key);
+    index_[key] = order_.begin();
+  }
+
+  /**
+   * Removes the page if present.
+   *
+   * @return  True if the page was in the list.
+   */
+  bool remove(const PageKey& key) {
+    const Index::iterator it = index_.find(key);
+    if (it == index_.end()) {
+      return false;
+    }
+    order_.erase(it->second);
+    index_.erase(it);
+    return true;
+  }
+
+  /**
+   * Forgets the oldest page. The list must not be empty.
+   */
+  void popBack() {
+    index_.erase(order_.back());
+    order_.pop_back();
+  }
+
+ private:
+  typedef std::unordered_map<PageKey, std::list<PageKey>::iterator,
+                             PageKeyHash> Index;
+
+  std::list<PageKey> order_;
+  Index index_;
+};
+
+}
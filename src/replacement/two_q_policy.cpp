@@ -0,0 +1,108 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#include "replacement/two_q_policy.h"
+
+namespace badgerdb {
+
+TwoQPolicy::TwoQPolicy(const double inFraction, const double outFraction)
+    : inFraction_(inFraction), outFraction_(outFraction), kIn_(0), kOut_(0) {
+}
+
+void TwoQPolicy::init(const std::uint32_t numBufs) {
+  kIn_ = static_cast<std::uint32_t>(numBufs * inFraction_);
+  kOut_ = static_cast<std::uint32_t>(numBufs * outFraction_);
+  if (kIn_ < 1) {
+    kIn_ = 1;
+  }
+  if (kOut_ < 1) {
+    kOut_ = 1;
+  }
+  a1in_.init(numBufs);
+  am_.init(numBufs);
+  queue_.assign(numBufs, NONE);
+  pages_.assign(numBufs, PageKey());
+}
+
+void TwoQPolicy::detach(const FrameId frame) {
+  if (a1in_.contains(frame)) {
+    a1in_.remove(frame);
+  } else if (am_.contains(frame)) {
+    am_.remove(frame);
+  }
+}
+
+void TwoQPolicy::recordAccess(const FrameId frame) {
+  std::lock_guard<std::mutex> guard(latch_);
+  // A hit in A1in does not move the page: a correlated burst of references
+  // right after loading does not prove reuse.
+  if (am_.contains(frame)) {
+    am_.remove(frame);
+    am_.pushFront(frame);
+  }
+}
+
+void TwoQPolicy::recordLoad(const FrameId frame, const PageKey& key) {
+  std::lock_guard<std::mutex> guard(latch_);
+  pages_[frame] = key;
+  if (a1out_.remove(key)) {
+    queue_[frame] = AM;
+    am_.pushFront(frame);
+  } else {
+    queue_[frame] = A1IN;
+    a1in_.pushFront(frame);
+  }
+}
+
+void TwoQPolicy::recordEvict(const FrameId frame) {
+  std::lock_guard<std::mutex> guard(latch_);
+  detach(frame);
+  if (queue_[frame] == A1IN) {
+    a1out_.pushFront(pages_[frame]);
+    if (a1out_.size() > kOut_) {
+      a1out_.popBack();
+    }
+  }
+  queue_[frame] = NONE;
+}
+
+void TwoQPolicy::recordRemove(const FrameId frame) {
+  std::lock_guard<std::mutex> guard(latch_);
+  detach(frame);
+  queue_[frame] = NONE;
+}
+
+bool TwoQPolicy::pickVictim(FrameId& frame,
+                            const EvictablePredicate& evictable) {
+  std::lock_guard<std::mutex> guard(latch_);
+  // Take from A1in while it is over its target size, otherwise from Am; fall
+  // back to the other queue if every page of the first one is pinned.
+  FrameList* first = a1in_.size() > kIn_ || am_.size() == 0 ? &a1in_ : &am_;
+  FrameList* second = first == &a1in_ ? &am_ : &a1in_;
+
+  FrameId candidate = first->findFromBack(evictable);
+  if (candidate == FrameList::NONE) {
+    candidate = second->findFromBack(evictable);
+  }
+  if (candidate == FrameList::NONE) {
+    return false;
+  }
+  detach(candidate);
+  frame = candidate;
+  return true;
+}
+
+void TwoQPolicy::restore(const FrameId frame) {
+  std::lock_guard<std::mutex> guard(latch_);
+  if (queue_[frame] == A1IN && !a1in_.contains(frame)) {
+    a1in_.pushFront(frame);
+  } else if (queue_[frame] == AM && !am_.contains(frame)) {
+    am_.pushFront(frame);
+  }
+}
+
+}
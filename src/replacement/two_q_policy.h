@@ -0,0 +1,90 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <mutex>
+
+#include "replacement_policy.h"
+
+namespace badgerdb {
+
+/**
+ * @brief Full 2Q replacement (Johnson and Shasha).
+ *
+ * Newly loaded pages enter the FIFO queue A1in.  Pages evicted from A1in are
+ * remembered in the ghost queue A1out; a page loaded again while it is in
+ * A1out has proven to be reused and goes to the LRU list Am.  Pages touched
+ * once, as by a scan, thus pass through A1in without disturbing Am.
+ */
+class TwoQPolicy : public ReplacementPolicy {
+ public:
+  /**
+   * @param inFraction    Target size of A1in as a fraction of the pool.
+   * @param outFraction   Size of A1out as a fraction of the pool.
+   */
+  explicit TwoQPolicy(const double inFraction = 0.25,
+                      const double outFraction = 0.5);
+
+  const char* name() const { return "2Q"; }
+  void init(const std::uint32_t numBufs);
+  void recordAccess(const FrameId frame);
+  void recordLoad(const FrameId frame, const PageKey& key);
+  void recordEvict(const FrameId frame);
+  void recordRemove(const FrameId frame);
+  bool pickVictim(FrameId& frame, const EvictablePredicate& evictable);
+  void restore(const FrameId frame);
+
+ private:
+  /**
+   * Where a frame is kept.
+   */
+  enum Queue { NONE, A1IN, AM };
+
+  /**
+   * Removes frame from whichever queue holds it.
+   */
+  void detach(const FrameId frame);
+
+  const double inFraction_;
+  const double outFraction_;
+
+  /**
+   * Target size of A1in and maximum size of A1out, in pages.
+   */
+  std::uint32_t kIn_;
+  std::uint32_t kOut_;
+
+  /**
+   * Resident pages seen once (FIFO) and resident pages seen again (LRU).
+   */
+  FrameList a1in_;
+  FrameList am_;
+
+  /**
+   * Pages recently evicted from A1in.
+   */
+  GhostList a1out_;
+
+  /**
+   * Queue each frame belongs to.  Detached victims keep the queue they were
+   * taken from until they are evicted or restored.
+   */
+  std::vector<Queue> queue_;
+
+  /**
+   * Page held by each frame.
+   */
+  std::vector<PageKey> pages_;
+
+  /**
+   * Guards all of the above.
+   */
+  std::mutex latch_;
+};
+
+}
@@ -0,0 +1,154 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#include "slot_scan.h"
+
+#include <cstddef>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace badgerdb {
+
+namespace {
+
+static_assert(sizeof(PageSlot) == 6 && offsetof(PageSlot, used) == 0,
+              "Slot masks assume 6-byte slots starting with the used flag.");
+
+typedef std::uint64_t (*MaskFunction)(const PageSlot*, SlotId, SlotId);
+
+/**
+ * Returns the mask of used slots first to last - 1, at bit offset first -
+ * start of the result, reading one slot at a time.
+ */
+std::uint64_t maskTail(const PageSlot* slots, const std::size_t start,
+                       const std::size_t first, const std::size_t last) {
+  std::uint64_t used = 0;
+  for (std::size_t slot_number = first; slot_number < last; ++slot_number) {
+    used |= static_cast<std::uint64_t>(slots[slot_number - 1].used != 0)
+        << (slot_number - start);
+  }
+  return used;
+}
+
+std::size_t windowEnd(const SlotId num_slots, const SlotId first) {
+  const std::size_t end = static_cast<std::size_t>(first) + SlotScan::WINDOW;
+  return end < num_slots + 1u ? end : num_slots + 1u;
+}
+
+#if defined(__x86_64__)
+
+/**
+ * Gathers the bits at positions 0, 6, 12, ..., 42 of a mask over the 48 bytes
+ * of 8 slots into the low 8 bits.  Each group of four is gathered by one
+ * multiply, which adds a shifted copy of the group per bit; the copies are
+ * placed so that the wanted bits line up without carries.
+ */
+inline std::uint64_t gatherFlags(const std::uint64_t bytes) {
+  const std::uint64_t group = 0x41041;  // Bits 0, 6, 12 and 18.
+  const std::uint64_t spread = 0x8421;  // Shifts of 15, 10, 5 and 0.
+  return (((bytes & group) * spread) >> 15 & 0xf) |
+      (((bytes >> 24 & group) * spread) >> 11 & 0xf0);
+}
+
+inline std::uint64_t nonzeroBytes16(const char* bytes) {
+  const __m128i v =
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes));
+  return ~static_cast<std::uint32_t>(
+      _mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_setzero_si128()))) & 0xffff;
+}
+
+std::uint64_t usedMaskSse2(const PageSlot* slots, const SlotId num_slots,
+                           const SlotId first) {
+  const std::size_t end = windowEnd(num_slots, first);
+  const char* base = reinterpret_cast<const char*>(slots);
+  std::uint64_t used = 0;
+  std::size_t slot_number = first;
+  for (; slot_number + 8 <= end; slot_number += 8) {
+    const char* block = base + (slot_number - 1) * sizeof(PageSlot);
+    const std::uint64_t nonzero = nonzeroBytes16(block) |
+        nonzeroBytes16(block + 16) << 16 | nonzeroBytes16(block + 32) << 32;
+    used |= gatherFlags(nonzero) << (slot_number - first);
+  }
+  return used | maskTail(slots, first, slot_number, end);
+}
+
+__attribute__((target("avx2")))
+inline std::uint64_t nonzeroBytes32(const char* bytes) {
+  const __m256i v =
+      _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bytes));
+  return ~static_cast<std::uint32_t>(
+      _mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_setzero_si256())));
+}
+
+__attribute__((target("avx2")))
+std::uint64_t usedMaskAvx2(const PageSlot* slots, const SlotId num_slots,
+                           const SlotId first) {
+  const std::size_t end = windowEnd(num_slots, first);
+  const char* base = reinterpret_cast<const char*>(slots);
+  std::uint64_t used = 0;
+  std::size_t slot_number = first;
+  for (; slot_number + 16 <= end; slot_number += 16) {
+    // 96 bytes hold 16 slots; the three 32-byte masks are regrouped into two
+    // of 48 bytes, 8 slots each.
+    const char* block = base + (slot_number - 1) * sizeof(PageSlot);
+    const std::uint64_t low = nonzeroBytes32(block);
+    const std::uint64_t middle = nonzeroBytes32(block + 32);
+    const std::uint64_t high = nonzeroBytes32(block + 64);
+    const std::uint64_t flags = gatherFlags(low | (middle & 0xffff) << 32) |
+        gatherFlags(middle >> 16 | high << 16) << 8;
+    used |= flags << (slot_number - first);
+  }
+  if (slot_number < end) {
+    used |= usedMaskSse2(slots, end - 1, slot_number) << (slot_number - first);
+  }
+  return used;
+}
+
+bool avx2Available() {
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2");
+}
+
+MaskFunction chooseMask() {
+  return avx2Available() ? usedMaskAvx2 : usedMaskSse2;
+}
+
+#else
+
+MaskFunction chooseMask() {
+  return SlotScan::usedMaskScalar;
+}
+
+#endif
+
+}
+
+const SlotId SlotScan::WINDOW;
+
+std::uint64_t SlotScan::usedMask(const PageSlot* slots,
+                                 const SlotId num_slots, const SlotId first) {
+  static const MaskFunction mask_function = chooseMask();
+  return mask_function(slots, num_slots, first);
+}
+
+std::uint64_t SlotScan::usedMaskScalar(const PageSlot* slots,
+                                       const SlotId num_slots,
+                                       const SlotId first) {
+  return maskTail(slots, first, first, windowEnd(num_slots, first));
+}
+
+const char* SlotScan::kernel() {
+#if defined(__x86_64__)
+  return avx2Available() ? "avx2" : "sse2";
+#else
+  return "scalar";
+#endif
+}
+
+}
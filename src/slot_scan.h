@@ -0,0 +1,108 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+#include "page.h"
+#include "types.h"
+
+namespace badgerdb {
+
+/**
+ * @brief Searches of the slot directory of a Page for used or unused slots.
+ *
+ * The searches work on masks of the used flags of WINDOW consecutive slots.
+ * On x86-64 a mask is built 8 slots (16 with AVX2) at a time: the slots are
+ * loaded as plain bytes and compared against zero, and the bits of the
+ * resulting byte mask that fall on used flags are gathered with a multiply.
+ * Elsewhere, and for the last few slots of the directory, the flags are read
+ * one by one.  Slots past the end of the directory are never read.
+ */
+class SlotScan {
+ public:
+  /**
+   * Number of slots covered by a mask.
+   */
+  static const SlotId WINDOW = 64;
+
+  /**
+   * Returns the used flags of slots first to first + WINDOW - 1 as a mask
+   * whose bit n is set if slot first + n is used.  Bits for slots past the
+   * end of the directory are clear.
+   *
+   * @param slots       Slot directory, starting with slot 1.
+   * @param num_slots   Number of slots in the directory.
+   * @param first       Number of the first slot of the mask.
+   * @return  Mask of used slots.
+   */
+  static std::uint64_t usedMask(const PageSlot* slots, const SlotId num_slots,
+                                const SlotId first);
+
+  /**
+   * Same as usedMask(), reading one slot at a time.
+   */
+  static std::uint64_t usedMaskScalar(const PageSlot* slots,
+                                      const SlotId num_slots,
+                                      const SlotId first);
+
+  /**
+   * Returns the number of the first used slot after the given one, or
+   * Page::INVALID_SLOT if there is none.
+   *
+   * @param slots       Slot directory, starting with slot 1.
+   * @param num_slots   Number of slots in the directory.
+   * @param after       Slot to start the search after; Page::INVALID_SLOT to
+   *                    start at the beginning.
+   * @return  Next used slot or Page::INVALID_SLOT.
+   */
+  static SlotId nextUsed(const PageSlot* slots, const SlotId num_slots,
+                         const SlotId after) {
+    // Records are usually packed, so look at the very next slot first.
+    if (after < num_slots && slots[after].used) {
+      return after + 1;
+    }
+    for (std::uint32_t first = after + 1; first <= num_slots;
+         first += WINDOW) {
+      const std::uint64_t used = usedMask(slots, num_slots, first);
+      if (used != 0) {
+        return first + __builtin_ctzll(used);
+      }
+    }
+    return Page::INVALID_SLOT;
+  }
+
+  /**
+   * Returns the number of the first unused slot after the given one, or
+   * Page::INVALID_SLOT if there is none.
+   *
+   * @see nextUsed
+   */
+  static SlotId nextFree(const PageSlot* slots, const SlotId num_slots,
+                         const SlotId after) {
+    for (std::uint32_t first = after + 1; first <= num_slots;
+         first += WINDOW) {
+      std::uint64_t unused = ~usedMask(slots, num_slots, first);
+      if (num_slots - first + 1 < WINDOW) {
+        unused &= (std::uint64_t(1) << (num_slots - first + 1)) - 1;
+      }
+      if (unused != 0) {
+        return first + __builtin_ctzll(unused);
+      }
+    }
+    return Page::INVALID_SLOT;
+  }
+
+  /**
+   * Returns the name of the version of usedMask() in use: "avx2", "sse2" or
+   * "scalar".
+   */
+  static const char* kernel();
+};
+
+}